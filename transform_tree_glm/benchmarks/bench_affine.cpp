@@ -0,0 +1,90 @@
+// Batch composeAffine and invertAffine: one glm::mat4 at a time against the structure-of-arrays kernels,
+// which process 8 (with -mavx2) or 4 (SSE2) matrices at a time. glm's operator* and affineInverse for reference.
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "transform_tree_glm/affine.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    const size_t count = 1 << 12;
+
+    struct SoAMatrices
+    {
+        std::vector<float> elements[4][3];
+
+        SoAMatrices(const std::vector<glm::mat4>& in)
+        {
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    for (const glm::mat4& m : in) elements[col][row].push_back(m[col][row]);
+        }
+
+        SoAAffine arrays()
+        {
+            SoAAffine result;
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    result.m[col][row] = elements[col][row].data();
+            return result;
+        }
+    };
+
+} // namespace
+
+int main()
+{
+#if defined(TRANSFORM_TREE_GLM_AVX2)
+    std::printf("AVX2, %zu matrices, ns per matrix\n", count);
+#elif defined(TRANSFORM_TREE_GLM_SSE2)
+    std::printf("SSE2, %zu matrices, ns per matrix\n", count);
+#else
+    std::printf("scalar, %zu matrices, ns per matrix\n", count);
+#endif
+    Random random(4);
+    std::vector<glm::mat4> a(count), b(count), out(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = glm::translate(glm::mat4(1), random.position()) * glm::mat4_cast(random.rotation()) * glm::scale(glm::mat4(1), random.scale());
+        b[i] = glm::translate(glm::mat4(1), random.position()) * glm::mat4_cast(random.rotation()) * glm::scale(glm::mat4(1), random.scale());
+    }
+    SoAMatrices sa(a), sb(b), sout(out);
+
+    double baseline = measure(count, [&]() {
+        for (size_t i = 0; i < count; ++i) out[i] = a[i] * b[i];
+        doNotOptimize(out.back());
+    });
+    report("compose, glm operator*", baseline);
+    report("compose, glm::mat4 batch", measure(count, [&]() {
+        composeAffine(a.data(), b.data(), count, out.data());
+        doNotOptimize(out.back());
+    }), baseline);
+    report("compose, structure-of-arrays batch", measure(count, [&]() {
+        composeAffine(sa.arrays(), sb.arrays(), count, sout.arrays());
+        doNotOptimize(sout.elements[3][2].back());
+    }), baseline);
+
+    baseline = measure(count, [&]() {
+        for (size_t i = 0; i < count; ++i) out[i] = glm::affineInverse(a[i]);
+        doNotOptimize(out.back());
+    });
+    report("invert, glm::affineInverse", baseline);
+    report("invert, glm::mat4 batch", measure(count, [&]() {
+        invertAffine(a.data(), count, out.data());
+        doNotOptimize(out.back());
+    }), baseline);
+    report("invert, structure-of-arrays batch", measure(count, [&]() {
+        invertAffine(sa.arrays(), count, sout.arrays());
+        doNotOptimize(sout.elements[3][2].back());
+    }), baseline);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// decomposeAffine and decompose from affine.h against glm::decompose, which Pose::setLocalPose(mat4) used before.
+// Inputs are TRS matrices (the fast path), mirrored TRS matrices and matrices with skew (the glm fallback).
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/pose.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    const size_t count = 1 << 14;
+
+    glm::mat4 trs(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        return glm::translate(glm::mat4(1), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1), scale);
+    }
+
+    std::vector<glm::mat4> inputs(Random& random, bool mirrored, bool skewed)
+    {
+        std::vector<glm::mat4> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 scale = random.scale();
+            if (mirrored) scale.x = -scale.x;
+            glm::mat4 m = trs(random.position(), random.rotation(), scale);
+            if (skewed) m[1] += 0.3f * m[0];
+            result.push_back(m);
+        }
+        return result;
+    }
+
+    void run(const char* title, const std::vector<glm::mat4>& in)
+    {
+        std::printf("%s, %zu matrices\n", title, in.size());
+        std::vector<glm::vec3> positions(in.size()), scales(in.size());
+        std::vector<glm::quat> rotations(in.size());
+
+        double baseline = measure(in.size(), [&]() {
+            glm::vec3 skew;
+            glm::vec4 perspective;
+            for (size_t i = 0; i < in.size(); ++i)
+                glm::decompose(in[i], scales[i], rotations[i], positions[i], skew, perspective);
+            doNotOptimize(positions);
+        });
+        report("  glm::decompose", baseline);
+
+        report("  decomposeAffine", measure(in.size(), [&]() {
+            for (size_t i = 0; i < in.size(); ++i)
+                decomposeAffine(in[i], positions[i], rotations[i], scales[i]);
+            doNotOptimize(positions);
+        }), baseline);
+
+        report("  decompose", measure(in.size(), [&]() {
+            for (size_t i = 0; i < in.size(); ++i)
+                decompose(in[i], positions[i], rotations[i], scales[i]);
+            doNotOptimize(positions);
+        }), baseline);
+
+        report("  decompose (batch)", measure(in.size(), [&]() {
+            decompose(in.data(), in.size(), positions.data(), rotations.data(), scales.data());
+            doNotOptimize(positions);
+        }), baseline);
+
+        std::vector<Pose> poses(in.size());
+        report("  Pose::setLocalPose(mat4)", measure(in.size(), [&]() {
+            for (size_t i = 0; i < in.size(); ++i)
+                poses[i].setLocalPose(in[i]);
+            doNotOptimize(poses);
+        }), baseline);
+    }
+
+} // namespace
+
+int main()
+{
+    Random random(7);
+    run("TRS", inputs(random, false, false));
+    run("TRS with negative scale", inputs(random, true, false));
+    run("with skew, falls back to glm::decompose", inputs(random, false, true));
+    return 0;
+}
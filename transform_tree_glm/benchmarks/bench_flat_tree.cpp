@@ -0,0 +1,95 @@
+// FlatTree_::update() against walking recurse() and computing the world pose of each node.
+// update() recomputes every world pose, so its cost is linear in the subtree size in all cases,
+// the cases differ in how much of it rebuild() adds: none without topology changes, a patch of
+// the previous linearization after one node moved, or a linearization from scratch.
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform_tree_glm/flat_tree.h"
+#include "transform_tree_glm/transform.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    const size_t nodeCount = 1 << 17;
+
+    struct Tree
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+    };
+
+    // random parents, so the tree is wide near the root and a few dozen levels deep
+    void build(Random& random, Tree& tree)
+    {
+        for (size_t i = 0; i < nodeCount; ++i)
+        {
+            Transform* parent = tree.nodes.empty() ? &tree.root : tree.nodes[random.index(tree.nodes.size())].get();
+            tree.nodes.emplace_back(new Transform(parent, Pose(random.position(1), random.rotation(), random.scale())));
+        }
+    }
+
+    // moves a random leaf below another random node, a small topology change
+    void moveLeaf(Random& random, Tree& tree)
+    {
+        Transform* leaf;
+        do { leaf = tree.nodes[random.index(tree.nodes.size())].get(); } while (!leaf->empty());
+        leaf->setParent(tree.nodes[random.index(tree.nodes.size())].get());
+    }
+
+} // namespace
+
+int main()
+{
+    Random random(3);
+    Tree tree;
+    build(random, tree);
+    std::printf("random tree, %zu nodes, ns per node\n", nodeCount + 1);
+
+    double baseline = measure(nodeCount, [&]() {
+        tree.root.invalidateWorldPose();
+        for (auto& node : tree.root.recurse()) doNotOptimize(node.worldPose());
+    });
+    report("recurse() and worldPose()", baseline);
+
+    FlatTree flat(&tree.root);
+    report("update(), unchanged topology", measure(nodeCount, [&]() {
+        flat.update();
+        doNotOptimize(flat.worldPoses().back());
+    }), baseline);
+
+    report("update(), one leaf moved", measure(nodeCount, [&]() {
+        moveLeaf(random, tree);
+        flat.update();
+        doNotOptimize(flat.worldPoses().back());
+    }), baseline);
+
+    report("update(), one leaf moved, from scratch", measure(nodeCount, [&]() {
+        moveLeaf(random, tree);
+        FlatTree fresh(&tree.root);
+        fresh.update();
+        doNotOptimize(fresh.worldPoses().back());
+    }), baseline);
+
+    // the linearization alone
+    double scratch = measure(nodeCount, [&]() {
+        moveLeaf(random, tree);
+        FlatTree fresh(&tree.root);
+        fresh.rebuild();
+        doNotOptimize(fresh.nodes().back());
+    });
+    report("rebuild() from scratch", scratch);
+    report("rebuild() patched, one leaf moved", measure(nodeCount, [&]() {
+        moveLeaf(random, tree);
+        flat.rebuild();
+        doNotOptimize(flat.nodes().back());
+    }), scratch);
+    return 0;
+}
@@ -0,0 +1,269 @@
+// Precision of world and relative poses far from the origin, Transform (float) against DTransform (double)
+// and against a DTransform root with each branch a float tree attached to it, see Transform_::setOrigin.
+// A tree with two branches of rigid nodes is placed at increasing distance from the origin. The local
+// poses are generated in double and rounded for the float tree, the reference is computed in long double.
+// Reports the largest position error over all trees, in units, and the time of one world pose update.
+
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "transform_tree_glm/transform.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    const int trees = 100;
+    const int depth = 8;
+
+    typedef long double real;
+
+    // rigid transformation in long double, rotation rows r and translation t
+    struct Reference
+    {
+        real r[3][3];
+        real t[3];
+
+        static Reference fromPose(const glm::dvec3& position, const glm::dquat& q)
+        {
+            real x = q.x, y = q.y, z = q.z, w = q.w;
+            Reference result;
+            result.r[0][0] = 1 - 2 * (y * y + z * z); result.r[0][1] = 2 * (x * y - w * z);     result.r[0][2] = 2 * (x * z + w * y);
+            result.r[1][0] = 2 * (x * y + w * z);     result.r[1][1] = 1 - 2 * (x * x + z * z); result.r[1][2] = 2 * (y * z - w * x);
+            result.r[2][0] = 2 * (x * z - w * y);     result.r[2][1] = 2 * (y * z + w * x);     result.r[2][2] = 1 - 2 * (x * x + y * y);
+            result.t[0] = position.x; result.t[1] = position.y; result.t[2] = position.z;
+            return result;
+        }
+
+        // this * other
+        Reference operator*(const Reference& other) const
+        {
+            Reference result;
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                    result.r[i][j] = r[i][0] * other.r[0][j] + r[i][1] * other.r[1][j] + r[i][2] * other.r[2][j];
+                result.t[i] = r[i][0] * other.t[0] + r[i][1] * other.t[1] + r[i][2] * other.t[2] + t[i];
+            }
+            return result;
+        }
+
+        // position of point p of this frame in the frame of other, with other rigid
+        void positionIn(const Reference& other, real out[3]) const
+        {
+            real d[3] = { t[0] - other.t[0], t[1] - other.t[1], t[2] - other.t[2] };
+            for (int i = 0; i < 3; ++i)
+                out[i] = other.r[0][i] * d[0] + other.r[1][i] * d[1] + other.r[2][i] * d[2];
+        }
+    };
+
+    struct LocalPose
+    {
+        glm::dvec3 position;
+        glm::dquat rotation;
+    };
+
+    struct Tree
+    {
+        LocalPose root;
+        std::vector<LocalPose> left;
+        std::vector<LocalPose> right;
+    };
+
+    glm::dquat randomRotation(Random& random)
+    {
+        glm::quat q = random.rotation();
+        return glm::normalize(glm::dquat(q.w, q.x, q.y, q.z));
+    }
+
+    Tree randomTree(Random& random, double distance)
+    {
+        Tree tree;
+        glm::dvec3 direction = glm::normalize(glm::dvec3(random.position(1)));
+        // the fraction keeps the root off the float grid
+        tree.root = { direction * distance + glm::dvec3(random.position(1)), randomRotation(random) };
+        for (int k = 0; k < depth; ++k)
+        {
+            tree.left.push_back({ glm::dvec3(random.position(1)), randomRotation(random) });
+            tree.right.push_back({ glm::dvec3(random.position(1)), randomRotation(random) });
+        }
+        return tree;
+    }
+
+    real distance(const real a[3], const glm::dvec3& b)
+    {
+        real dx = a[0] - b.x, dy = a[1] - b.y, dz = a[2] - b.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    template <typename transform_t>
+    struct Instance
+    {
+        typedef typename transform_t::vec3_type vec3_type;
+        typedef typename transform_t::quat_type quat_type;
+        typedef typename transform_t::scalar_type scalar_type;
+
+        std::vector<std::unique_ptr<transform_t>> nodes;
+        transform_t* leftLeaf;
+        transform_t* rightLeaf;
+
+        static void set(transform_t& node, const LocalPose& pose)
+        {
+            quat_type rotation(scalar_type(pose.rotation.w), scalar_type(pose.rotation.x), scalar_type(pose.rotation.y), scalar_type(pose.rotation.z));
+            node.setLocalPose(vec3_type(pose.position), rotation);
+        }
+
+        transform_t* chain(transform_t* parent, const std::vector<LocalPose>& poses)
+        {
+            for (const LocalPose& pose : poses)
+            {
+                nodes.emplace_back(new transform_t(parent));
+                set(*nodes.back(), pose);
+                parent = nodes.back().get();
+            }
+            return parent;
+        }
+
+        Instance(const Tree& tree)
+        {
+            nodes.emplace_back(new transform_t());
+            set(*nodes.back(), tree.root);
+            transform_t* root = nodes.back().get();
+            leftLeaf = chain(root, tree.left);
+            rightLeaf = chain(root, tree.right);
+        }
+    };
+
+    // the root in double, each branch a float tree with the root as origin
+    struct MixedInstance
+    {
+        DTransform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+        Transform* leftLeaf;
+        Transform* rightLeaf;
+
+        Transform* chain(const std::vector<LocalPose>& poses)
+        {
+            Transform* parent = nullptr;
+            for (const LocalPose& pose : poses)
+            {
+                nodes.emplace_back(new Transform(parent));
+                Instance<Transform>::set(*nodes.back(), pose);
+                parent = nodes.back().get();
+            }
+            nodes[nodes.size() - poses.size()]->setOrigin(&root);
+            return parent;
+        }
+
+        MixedInstance(const Tree& tree)
+        {
+            Instance<DTransform>::set(root, tree.root);
+            leftLeaf = chain(tree.left);
+            rightLeaf = chain(tree.right);
+        }
+    };
+
+    struct Errors
+    {
+        real world = 0;
+        real relative = 0;
+    };
+
+    template <typename transform_t>
+    void measureErrors(const Tree& tree, Errors& errors)
+    {
+        Reference root = Reference::fromPose(tree.root.position, tree.root.rotation);
+        Reference left = root, right = root;
+        for (int k = 0; k < depth; ++k)
+        {
+            left = left * Reference::fromPose(tree.left[k].position, tree.left[k].rotation);
+            right = right * Reference::fromPose(tree.right[k].position, tree.right[k].rotation);
+        }
+        real world[3] = { left.t[0], left.t[1], left.t[2] };
+        real relative[3];
+        right.positionIn(left, relative);
+
+        glm::dvec3 worldPosition, rightInLeft;
+        if constexpr (std::is_same<transform_t, MixedInstance>::value)
+        {
+            MixedInstance instance(tree);
+            worldPosition = glm::dvec3(instance.leftLeaf->globalPose()[3]);
+            rightInLeft = glm::dvec3(glm::dvec4(instance.rightLeaf->transformToFrame(instance.leftLeaf)[3]));
+        }
+        else
+        {
+            Instance<transform_t> instance(tree);
+            worldPosition = glm::dvec3(glm::dvec4(instance.leftLeaf->worldPose()[3]));
+            rightInLeft = glm::dvec3(glm::dvec4(instance.rightLeaf->transformToFrame(instance.leftLeaf)[3]));
+        }
+        errors.world = std::max(errors.world, distance(world, worldPosition));
+        errors.relative = std::max(errors.relative, distance(relative, rightInLeft));
+    }
+
+    // the float trees keep their world poses, only the global pose of the leaf is composed in double
+    double measureMixedUpdate(const Tree& tree)
+    {
+        MixedInstance instance(tree);
+        const int updates = 1000;
+        return measure(updates, [&]() {
+            for (int i = 0; i < updates; ++i)
+            {
+                Instance<DTransform>::set(instance.root, tree.root);
+                doNotOptimize(instance.leftLeaf->globalPose());
+            }
+        });
+    }
+
+    template <typename transform_t>
+    double measureUpdate(const Tree& tree)
+    {
+        Instance<transform_t> instance(tree);
+        transform_t* root = instance.nodes.front().get();
+        const int updates = 1000;
+        return measure(updates, [&]() {
+            for (int i = 0; i < updates; ++i)
+            {
+                Instance<transform_t>::set(*root, tree.root);
+                doNotOptimize(instance.leftLeaf->worldPose());
+            }
+        });
+    }
+
+} // namespace
+
+int main()
+{
+    std::printf("%d trees, two branches of depth %d, errors in units\n", trees, depth);
+    std::printf("%12s %12s %12s %12s %12s %12s %12s\n", "distance", "float world", "double world", "mixed world", "float rel.", "double rel.", "mixed rel.");
+    for (double distance : { 1.0, 1e2, 1e4, 1e5, 1e6, 1e7, 1e9 })
+    {
+        Random random(11);
+        Errors single, twice, mixed;
+        for (int t = 0; t < trees; ++t)
+        {
+            Tree tree = randomTree(random, distance);
+            measureErrors<Transform>(tree, single);
+            measureErrors<DTransform>(tree, twice);
+            measureErrors<MixedInstance>(tree, mixed);
+        }
+        std::printf("%12g %12.3Le %12.3Le %12.3Le %12.3Le %12.3Le %12.3Le\n", distance,
+            single.world, twice.world, mixed.world, single.relative, twice.relative, mixed.relative);
+    }
+
+    Random random(11);
+    Tree tree = randomTree(random, 1e6);
+    std::printf("root changed, world pose of a leaf at depth %d recomputed\n", depth);
+    double baseline = measureUpdate<Transform>(tree);
+    report("  Transform (float)", baseline);
+    report("  DTransform (double)", measureUpdate<DTransform>(tree), baseline);
+    report("  float trees on a double origin", measureMixedUpdate(tree), baseline);
+    return 0;
+}
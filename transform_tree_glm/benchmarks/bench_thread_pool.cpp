@@ -0,0 +1,111 @@
+// Scaling of Transform_::updateWorldTransforms on ThreadPool with 1, 2, 4, 8 and 16 threads.
+// The wide tree has many small independent subtrees under the root. The deep tree consists of long
+// chains which branch rarely, so it has little parallelism to offer.
+// The baseline recomputes all world poses serially in parent-before-child order.
+// The topology does not change between iterations, so the cached split of the subtree is reused.
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform_tree_glm/thread_pool.h"
+#include "transform_tree_glm/transform.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    // nodes of the wide tree
+    const size_t nodeCount = 1 << 18;
+
+    struct Tree
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+
+        Transform* add(Random& random, Transform* parent)
+        {
+            nodes.emplace_back(new Transform(parent, Pose(random.position(1), random.rotation(), glm::vec3(1))));
+            return nodes.back().get();
+        }
+    };
+
+    // 2048 subtrees of 128 random nodes under the root
+    void buildWide(Random& random, Tree& tree)
+    {
+        const size_t subtreeSize = 128;
+        while (tree.nodes.size() < nodeCount)
+        {
+            size_t first = tree.nodes.size();
+            tree.add(random, &tree.root);
+            for (size_t i = 1; i < subtreeSize; ++i)
+                tree.add(random, tree.nodes[first + random.index(i)].get());
+        }
+    }
+
+    // 16 chains of 4096 nodes under the root, one in 64 nodes starts a side branch
+    void buildDeep(Random& random, Tree& tree)
+    {
+        const size_t chainLength = 4096;
+        for (size_t chain = 0; chain < 16; ++chain)
+        {
+            Transform* parent = &tree.root;
+            size_t first = tree.nodes.size();
+            for (size_t i = 0; i < chainLength; ++i)
+            {
+                if ((i > 0) && (random.index(64) == 0)) parent = tree.nodes[first + random.index(i)].get();
+                parent = tree.add(random, parent);
+            }
+        }
+    }
+
+    void run(const char* title, Tree& tree)
+    {
+        std::vector<Transform*> order;
+        for (auto& node : tree.root.recurse()) order.push_back(&node);
+        std::printf("%s, %zu nodes, ns per node\n", title, order.size());
+
+        double baseline = measure(order.size(), [&]() {
+            for (Transform* node : order) node->computeWorldPoseFromParent();
+            doNotOptimize(order.back()->worldAffine());
+        });
+        report("  serial", baseline);
+
+        char name[64];
+        for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+        {
+            ThreadPool pool(threads);
+            for (size_t grain : { size_t(256), size_t(4096) })
+            {
+                std::snprintf(name, sizeof(name), "  %2u threads, grain %zu", threads, grain);
+                report(name, measure(order.size(), [&]() {
+                    tree.root.updateWorldTransforms(pool, grain);
+                    doNotOptimize(order.back()->worldAffine());
+                }), baseline);
+            }
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    std::printf("hardware concurrency %u\n", std::thread::hardware_concurrency());
+    Random random(15);
+    {
+        Tree tree;
+        buildWide(random, tree);
+        run("wide", tree);
+    }
+    {
+        Tree tree;
+        buildDeep(random, tree);
+        run("deep", tree);
+    }
+    return 0;
+}
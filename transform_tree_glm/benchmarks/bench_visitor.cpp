@@ -0,0 +1,247 @@
+// The visitor before it took any functor, against Hierarchy::Visitor, whose callback is a std::function,
+// and Hierarchy::visit with a lambda, which instantiates BasicVisitor with the lambda type so the
+// per-node call can be inlined. The old visitor is copied below: a std::function callback and a
+// std::vector stack allocated by each visitor. Ratios are relative to it.
+// The callback sums the depths of the visited nodes. A plain recurse() loop doing the same is listed for reference.
+// The wide tree is visited from the root and per subtree, the latter to show the setup cost of a visitor.
+// The deep tree is deeper than the 32 levels the visitor stack keeps inline.
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "transform_tree_glm/hierarchy.h"
+
+#include "benchmark.h"
+
+using namespace transform_tree_glm;
+using namespace transform_tree_glm::benchmark;
+
+namespace {
+
+    // nodes of each tree
+    const size_t nodeCount = 1 << 17;
+
+    struct Tree
+    {
+        Hierarchy root;
+        std::vector<std::unique_ptr<Hierarchy>> nodes;
+
+        Hierarchy* add(Hierarchy* parent)
+        {
+            nodes.emplace_back(new Hierarchy());
+            parent->push_back(nodes.back().get());
+            return nodes.back().get();
+        }
+    };
+
+    // 2048 subtrees of 64 random nodes under the root
+    void buildWide(Random& random, Tree& tree)
+    {
+        const size_t subtreeSize = 64;
+        while (tree.nodes.size() < nodeCount)
+        {
+            size_t first = tree.nodes.size();
+            tree.add(&tree.root);
+            for (size_t i = 1; i < subtreeSize; ++i)
+                tree.add(tree.nodes[first + random.index(i)].get());
+        }
+    }
+
+    // chains of 512 nodes under the root, one in 8 nodes starts a side branch
+    void buildDeep(Random& random, Tree& tree)
+    {
+        const size_t chainLength = 512;
+        while (tree.nodes.size() < nodeCount)
+        {
+            Hierarchy* parent = &tree.root;
+            size_t first = tree.nodes.size();
+            for (size_t i = 0; i < chainLength; ++i)
+            {
+                if ((i > 0) && (random.index(8) == 0)) parent = tree.nodes[first + random.index(i)].get();
+                parent = tree.add(parent);
+            }
+        }
+    }
+
+    // Hierarchy::Visitor as it was before visitors took any functor, reduced to all()
+    class OldVisitor
+    {
+    public:
+        using iterator = Hierarchy::recurse_iterator;
+
+        struct Visit
+        {
+            Visit(OldVisitor& visitor, iterator item, int depth, int index)
+                : visitor(visitor), item(item), depth(depth), index(index)
+            {}
+
+            OldVisitor& visitor;
+            iterator item;
+            int depth;
+            int index;
+        };
+
+        using CallbackType = std::function<void(Visit& visit, Hierarchy* arg)>;
+        OldVisitor(const CallbackType& cb, iterator begin)
+            : cb(cb), begin(begin)
+        {
+            stack.clear();
+            stack.emplace_back(begin, 0, 0, false);
+        }
+
+        inline void all()
+        {
+            while (stack.size())
+            {
+                if (!stack.back().invoked) invoke(stack.back());
+                else advance();
+            }
+        }
+
+    protected:
+        const CallbackType& cb;
+        iterator begin;
+        const iterator end = iterator(nullptr);
+
+        struct StackItem
+        {
+            iterator it;
+            int depth;
+            int index;
+            bool invoked;
+            StackItem() = default;
+            StackItem(iterator it, int depth, int index, bool invoked)
+                : it(it), depth(depth), index(index), invoked(invoked)
+            {}
+        };
+
+        std::vector<StackItem> stack;
+
+        inline void invoke(StackItem& item)
+        {
+            item.invoked = true;
+            Visit visit(*this, item.it, item.depth, item.index);
+            cb(visit, item.it);
+        }
+
+        inline void advance()
+        {
+            auto it = stack.back().it;
+            if (it == end) return;
+            int oldDepth = it.depth();
+            ++it;
+            if (it.depth() > oldDepth)
+            {
+                stack.emplace_back(it, it.depth(), 0, false);
+            }
+            else if (it != end)
+            {
+                stack.resize(it.depth() + 1);
+                it.includeChildren();
+                stack[it.depth()].it = it;
+                stack[it.depth()].invoked = false;
+                ++stack[it.depth()].index;
+            }
+            else
+            {
+                stack.clear();
+            }
+        }
+    };
+
+    size_t recurseSum(Hierarchy* item)
+    {
+        size_t sum = 0;
+        auto end = item->end_recurse();
+        for (auto it = item->begin_recurse(); it != end; ++it)
+            sum += size_t(it.depth());
+        return sum;
+    }
+
+    size_t oldSum(Hierarchy* item)
+    {
+        size_t sum = 0;
+        OldVisitor::CallbackType cb = [&sum](OldVisitor::Visit& visit, Hierarchy*) {
+            sum += size_t(visit.depth);
+        };
+        OldVisitor visitor(cb, item);
+        visitor.all();
+        return sum;
+    }
+
+    size_t functionSum(Hierarchy* item)
+    {
+        size_t sum = 0;
+        Hierarchy::Visitor<>::CallbackType cb = [&sum](Hierarchy::Visitor<>::Visit& visit, Hierarchy*) {
+            sum += size_t(visit.depth);
+        };
+        Hierarchy::Visitor<> visitor(cb, item);
+        visitor.all();
+        return sum;
+    }
+
+    size_t lambdaSum(Hierarchy* item)
+    {
+        size_t sum = 0;
+        item->visit([&sum](auto& visit, Hierarchy*) {
+            sum += size_t(visit.depth);
+        });
+        return sum;
+    }
+
+    template <typename Sum>
+    void row(const char* name, Tree& tree, bool perSubtree, Sum sum, double baseline = 0, double* result = nullptr)
+    {
+        double ns = measure(tree.nodes.size(), [&]() {
+            size_t total = 0;
+            if (perSubtree)
+            {
+                for (auto& subtree : tree.root.children()) total += sum(&subtree);
+            }
+            else total = sum(&tree.root);
+            doNotOptimize(total);
+        });
+        report(name, ns, baseline);
+        if (result) *result = ns;
+    }
+
+    void run(const char* title, Tree& tree, bool perSubtree)
+    {
+        std::printf("%s, %zu nodes, ns per node\n", title, tree.nodes.size());
+        double baseline = 0;
+        row("  old Visitor (std::vector stack)", tree, perSubtree, oldSum, 0, &baseline);
+        row("  Visitor (std::function)", tree, perSubtree, functionSum, baseline);
+        row("  visit(lambda)", tree, perSubtree, lambdaSum, baseline);
+        row("  recurse() loop", tree, perSubtree, recurseSum, baseline);
+    }
+
+} // namespace
+
+int main()
+{
+    Random random(19);
+    {
+        // all four sum the same depths
+        Tree tree;
+        buildDeep(random, tree);
+        size_t expected = recurseSum(&tree.root);
+        if ((oldSum(&tree.root) != expected) || (functionSum(&tree.root) != expected) || (lambdaSum(&tree.root) != expected))
+        {
+            std::printf("visitors disagree\n");
+            return 1;
+        }
+    }
+    {
+        Tree tree;
+        buildWide(random, tree);
+        run("wide, from the root", tree, false);
+        run("wide, one visitor per subtree", tree, true);
+    }
+    {
+        Tree tree;
+        buildDeep(random, tree);
+        run("deep", tree, false);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Minimal helpers for the benchmark executables.
+// Each benchmark prints one line per case, nanoseconds per item are the best of several repetitions.
+
+namespace transform_tree_glm {
+namespace benchmark {
+
+    // keeps the compiler from dropping a result which is otherwise unused
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+    #if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+    #else
+        static volatile const void* sink;
+        sink = &value;
+    #endif
+    }
+
+    // runs body() repeatedly, returns the best time in nanoseconds divided by items
+    template <typename Body>
+    inline double measure(size_t items, Body&& body, int repetitions = 7)
+    {
+        using clock = std::chrono::steady_clock;
+        body(); // warm up caches and lazily built state
+        double best = 1e300;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto start = clock::now();
+            body();
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            if (ns < best) best = ns;
+        }
+        return best / double(items ? items : 1);
+    }
+
+    inline void report(const char* name, double nsPerItem, double baseline = 0)
+    {
+        if (baseline > 0)
+            std::printf("%-40s %10.2f ns  (%.2fx)\n", name, nsPerItem, baseline / nsPerItem);
+        else
+            std::printf("%-40s %10.2f ns\n", name, nsPerItem);
+    }
+
+    // random inputs, seeded so runs are comparable
+    struct Random
+    {
+        std::mt19937 engine;
+
+        Random(unsigned seed = 1) : engine(seed) {}
+
+        inline float uniform(float min, float max)
+        {
+            return std::uniform_real_distribution<float>(min, max)(engine);
+        }
+        inline size_t index(size_t count)
+        {
+            return std::uniform_int_distribution<size_t>(0, count - 1)(engine);
+        }
+        inline glm::vec3 position(float range = 10)
+        {
+            return glm::vec3(uniform(-range, range), uniform(-range, range), uniform(-range, range));
+        }
+        inline glm::quat rotation()
+        {
+            glm::vec4 v;
+            do { v = glm::vec4(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-1, 1)); }
+            while (glm::dot(v, v) < 1e-2f);
+            v = glm::normalize(v);
+            return glm::quat(v.w, v.x, v.y, v.z);
+        }
+        inline glm::vec3 scale()
+        {
+            return glm::vec3(uniform(0.25f, 4), uniform(0.25f, 4), uniform(0.25f, 4));
+        }
+    };
+
+} // namespace benchmark
+} // namespace transform_tree_glm
@@ -13,6 +13,12 @@ if(USE_CXX11_STD)
     set(CMAKE_CXX_STANDARD 11)
 endif()
 
+# affine kernels use SSE2/AVX2 when the target supports it, e.g. with -mavx2
+option(TRANSFORM_TREE_GLM_DISABLE_SIMD "Use scalar fallbacks instead of SSE2/AVX2 kernels" OFF)
+
+# store and cache affine matrices as 3x4 with implicit last row instead of 4x4
+option(TRANSFORM_TREE_GLM_COMPACT_AFFINE "Store affine matrices as glm::mat4x3" OFF)
+
 if(MSVC)
     add_definitions(-D_CONSOLE)
 else()
@@ -0,0 +1,967 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_inverse.hpp> // glm::affineInverse
+#include <glm/gtx/matrix_decompose.hpp> // glm::decompose
+
+// SIMD kernels are selected at compile time from the target instruction set.
+// define TRANSFORM_TREE_GLM_DISABLE_SIMD to force the scalar fallbacks.
+#if !defined(TRANSFORM_TREE_GLM_DISABLE_SIMD)
+    #if defined(__AVX2__)
+        #define TRANSFORM_TREE_GLM_AVX2
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define TRANSFORM_TREE_GLM_SSE2
+    #endif
+#endif
+
+#if defined(TRANSFORM_TREE_GLM_AVX2)
+    #include <immintrin.h>
+#elif defined(TRANSFORM_TREE_GLM_SSE2)
+    #include <emmintrin.h>
+#endif
+
+namespace transform_tree_glm {
+
+    // Kernels for affine transformations, i.e. matrices with last row (0,0,0,1).
+    // The last row of all inputs is assumed, not read.
+
+    #pragma region single matrix kernels
+
+    // a * b
+    inline glm::mat4 composeAffine(const glm::mat4& a, const glm::mat4& b)
+    {
+        glm::mat4 result;
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        const float* pa = &a[0][0];
+        const float* pb = &b[0][0];
+        float* pr = &result[0][0];
+        __m128 a0 = _mm_loadu_ps(pa + 0);
+        __m128 a1 = _mm_loadu_ps(pa + 4);
+        __m128 a2 = _mm_loadu_ps(pa + 8);
+        __m128 a3 = _mm_loadu_ps(pa + 12);
+        for (int col = 0; col < 4; ++col)
+        {
+            const float* bc = pb + 4 * col;
+            __m128 r = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(a0, _mm_set1_ps(bc[0])),
+                    _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+                _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+            if (col == 3) r = _mm_add_ps(r, a3);
+            _mm_storeu_ps(pr + 4 * col, r);
+        }
+    #else
+        for (int col = 0; col < 3; ++col)
+        {
+            result[col] = a[0] * b[col].x + a[1] * b[col].y + a[2] * b[col].z;
+        }
+        result[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+    #endif
+        return result;
+    }
+
+    // translate(position) * mat4(rotation) * scale(scale), with scale folded into the rotation columns
+    inline glm::mat4 affineFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+        glm::mat4 result;
+        result[0] = glm::vec4(scale.x * (1 - 2 * (yy + zz)), scale.x * (2 * (xy + wz)),     scale.x * (2 * (xz - wy)),     0);
+        result[1] = glm::vec4(scale.y * (2 * (xy - wz)),     scale.y * (1 - 2 * (xx + zz)), scale.y * (2 * (yz + wx)),     0);
+        result[2] = glm::vec4(scale.z * (2 * (xz + wy)),     scale.z * (2 * (yz - wx)),     scale.z * (1 - 2 * (xx + yy)), 0);
+        result[3] = glm::vec4(position, 1);
+        return result;
+    }
+
+    // same as glm::affineInverse
+    inline glm::mat4 invertAffine(const glm::mat4& m)
+    {
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        const float* pm = &m[0][0];
+        // clear w, so cross products and dot products only see xyz
+        const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        __m128 c0 = _mm_and_ps(_mm_loadu_ps(pm + 0), maskXYZ);
+        __m128 c1 = _mm_and_ps(_mm_loadu_ps(pm + 4), maskXYZ);
+        __m128 c2 = _mm_and_ps(_mm_loadu_ps(pm + 8), maskXYZ);
+        __m128 t  = _mm_loadu_ps(pm + 12);
+
+        // rows of the adjugate are cross products of the columns
+        auto cross = [](__m128 a, __m128 b)
+        {
+            __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        };
+        __m128 r0 = cross(c1, c2);
+        __m128 r1 = cross(c2, c0);
+        __m128 r2 = cross(c0, c1);
+
+        __m128 det = _mm_mul_ps(c0, r0);
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 3, 0, 1)));
+        det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(1, 0, 3, 2)));
+        __m128 oneOverDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        r0 = _mm_mul_ps(r0, oneOverDet);
+        r1 = _mm_mul_ps(r1, oneOverDet);
+        r2 = _mm_mul_ps(r2, oneOverDet);
+
+        // columns of the inverse are the transposed rows
+        __m128 r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        __m128 it = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(r0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0))),
+                _mm_mul_ps(r1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)))),
+            _mm_mul_ps(r2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+        it = _mm_sub_ps(_mm_set_ps(1, 0, 0, 0), it);
+
+        glm::mat4 result;
+        float* pr = &result[0][0];
+        _mm_storeu_ps(pr + 0, r0);
+        _mm_storeu_ps(pr + 4, r1);
+        _mm_storeu_ps(pr + 8, r2);
+        _mm_storeu_ps(pr + 12, it);
+        return result;
+    #else
+        return glm::affineInverse(m);
+    #endif
+    }
+
+    // inverse of a rotation and translation matrix, the rotation is inverted by transposing
+    inline glm::mat4 invertRigid(const glm::mat4& m)
+    {
+        glm::mat3 rotation = glm::transpose(glm::mat3(m));
+        glm::vec3 translation = -(rotation * glm::vec3(m[3]));
+        return glm::mat4(
+            glm::vec4(rotation[0], 0),
+            glm::vec4(rotation[1], 0),
+            glm::vec4(rotation[2], 0),
+            glm::vec4(translation, 1)
+        );
+    }
+
+    // Decomposes an affine matrix without skew into position, rotation and scale.
+    // Much cheaper than glm::decompose, which also solves for skew and perspective.
+    // Returns false when the last row is not (0,0,0,1), a scale is zero or the
+    // columns are not orthogonal within tolerance, glm::decompose is needed then.
+    inline bool decomposeAffine(const glm::mat4& m, glm::vec3& position, glm::quat& rotation, glm::vec3& scale, float tolerance = 1e-4f)
+    {
+        if ((m[0][3] != 0) || (m[1][3] != 0) || (m[2][3] != 0) || (m[3][3] != 1)) return false;
+        glm::vec3 c0(m[0]), c1(m[1]), c2(m[2]);
+        glm::vec3 s(glm::length(c0), glm::length(c1), glm::length(c2));
+        if ((s.x == 0) || (s.y == 0) || (s.z == 0)) return false;
+        c0 /= s.x;
+        c1 /= s.y;
+        c2 /= s.z;
+        if ((glm::abs(glm::dot(c0, c1)) > tolerance) 
+         || (glm::abs(glm::dot(c0, c2)) > tolerance) 
+         || (glm::abs(glm::dot(c1, c2)) > tolerance)) return false;
+        // mirroring is expressed as negative scale on all axes, like glm::decompose does
+        if (glm::dot(c0, glm::cross(c1, c2)) < 0)
+        {
+            s = -s;
+            c0 = -c0;
+            c1 = -c1;
+        }
+        // orthonormalize to get a proper rotation matrix despite numerical noise
+        c1 = glm::normalize(c1 - c0 * glm::dot(c0, c1));
+        c2 = glm::cross(c0, c1);
+        rotation = glm::quat_cast(glm::mat3(c0, c1, c2));
+        position = glm::vec3(m[3]);
+        scale = s;
+        return true;
+    }
+
+    // decomposeAffine with fallback to glm::decompose for matrices with skew.
+    // Returns false only if neither could decompose the matrix.
+    inline bool decompose(const glm::mat4& m, glm::vec3& position, glm::quat& rotation, glm::vec3& scale)
+    {
+        if (decomposeAffine(m, position, rotation, scale)) return true;
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        return glm::decompose(m, scale, rotation, position, skew, perspective);
+    }
+
+    #pragma endregion
+
+    #pragma region compact 3x4 storage
+
+    // 4 columns of 3 rows, the last row (0,0,0,1) is implicit
+    inline glm::mat4 toMat4(const glm::mat4x3& m)
+    {
+        return glm::mat4(
+            glm::vec4(m[0], 0),
+            glm::vec4(m[1], 0),
+            glm::vec4(m[2], 0),
+            glm::vec4(m[3], 1)
+        );
+    }
+    inline const glm::mat4& toMat4(const glm::mat4& m) { return m; }
+
+    inline glm::mat4x3 toMat4x3(const glm::mat4& m)
+    {
+        return glm::mat4x3(
+            glm::vec3(m[0]),
+            glm::vec3(m[1]),
+            glm::vec3(m[2]),
+            glm::vec3(m[3])
+        );
+    }
+    inline const glm::mat4x3& toMat4x3(const glm::mat4x3& m) { return m; }
+
+    // a * b
+    inline glm::mat4x3 composeAffine(const glm::mat4x3& a, const glm::mat4x3& b)
+    {
+        glm::mat4x3 result;
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        // columns are packed with a stride of 3 floats, loading 4 floats at once
+        // picks up the first element of the next column in the w lane, which is ignored.
+        const float* pa = &a[0][0];
+        const float* pb = &b[0][0];
+        float* pr = &result[0][0];
+        __m128 a0 = _mm_loadu_ps(pa + 0);
+        __m128 a1 = _mm_loadu_ps(pa + 3);
+        __m128 a2 = _mm_loadu_ps(pa + 6);
+        __m128 a3 = _mm_loadu_ps(pa + 8); // shifted by one to stay in bounds
+        a3 = _mm_shuffle_ps(a3, a3, _MM_SHUFFLE(3, 3, 2, 1));
+        __m128 r[4];
+        for (int col = 0; col < 4; ++col)
+        {
+            const float* bc = pb + 3 * col;
+            r[col] = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(a0, _mm_set1_ps(bc[0])),
+                    _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+                _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        }
+        r[3] = _mm_add_ps(r[3], a3);
+        // each store spills into the next column, which is overwritten afterwards
+        _mm_storeu_ps(pr + 0, r[0]);
+        _mm_storeu_ps(pr + 3, r[1]);
+        _mm_storeu_ps(pr + 6, r[2]);
+        _mm_storel_pi(reinterpret_cast<__m64*>(pr + 9), r[3]);
+        _mm_store_ss(pr + 11, _mm_shuffle_ps(r[3], r[3], _MM_SHUFFLE(2, 2, 2, 2)));
+    #else
+        for (int col = 0; col < 3; ++col)
+        {
+            result[col] = a[0] * b[col].x + a[1] * b[col].y + a[2] * b[col].z;
+        }
+        result[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+    #endif
+        return result;
+    }
+
+    inline glm::mat4x3 compactAffineFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        return toMat4x3(affineFromTRS(position, rotation, scale));
+    }
+
+    inline glm::mat4x3 invertAffine(const glm::mat4x3& m)
+    {
+        return toMat4x3(invertAffine(toMat4(m)));
+    }
+
+    inline glm::mat4x3 invertRigid(const glm::mat4x3& m)
+    {
+        glm::mat3 rotation = glm::transpose(glm::mat3(m));
+        return glm::mat4x3(rotation[0], rotation[1], rotation[2], -(rotation * m[3]));
+    }
+
+    // Matrix type used to store and cache affine transformations in Pose, Transform_ and FlatTree_.
+    // With TRANSFORM_TREE_GLM_COMPACT_AFFINE defined, matrices are stored as 3x4 (48 bytes)
+    // instead of 4x4 (64 bytes). Accessors returning glm::mat4 then return by value.
+    #if defined(TRANSFORM_TREE_GLM_COMPACT_AFFINE)
+        using affine_matrix = glm::mat4x3;
+        using affine_mat4_result = glm::mat4;
+    #else
+        using affine_matrix = glm::mat4;
+        using affine_mat4_result = const glm::mat4&;
+    #endif
+
+    inline affine_matrix toAffineMatrix(const glm::mat4& m)
+    {
+    #if defined(TRANSFORM_TREE_GLM_COMPACT_AFFINE)
+        return toMat4x3(m);
+    #else
+        return m;
+    #endif
+    }
+
+    inline affine_matrix affineMatrixFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+    #if defined(TRANSFORM_TREE_GLM_COMPACT_AFFINE)
+        return compactAffineFromTRS(position, rotation, scale);
+    #else
+        return affineFromTRS(position, rotation, scale);
+    #endif
+    }
+
+    #pragma endregion
+
+    #pragma region point kernels
+
+    namespace detail {
+
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        inline void store3(float* out, __m128 v)
+        {
+            _mm_storel_pi(reinterpret_cast<__m64*>(out), v);
+            _mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+        }
+    #endif
+
+        // out[i] = m * vec4(in[i], translate ? 1 : 0), in and out may alias
+        template <bool translate>
+        inline void transformAoS(const glm::mat4& m, const glm::vec3* in, glm::vec3* out, size_t count)
+        {
+        #if defined(TRANSFORM_TREE_GLM_SSE2)
+            const float* pm = &m[0][0];
+            const __m128 c0 = _mm_loadu_ps(pm + 0);
+            const __m128 c1 = _mm_loadu_ps(pm + 4);
+            const __m128 c2 = _mm_loadu_ps(pm + 8);
+            const __m128 c3 = _mm_loadu_ps(pm + 12);
+            for (size_t i = 0; i < count; ++i)
+            {
+                __m128 r = _mm_add_ps(
+                    _mm_add_ps(
+                        _mm_mul_ps(c0, _mm_set1_ps(in[i].x)),
+                        _mm_mul_ps(c1, _mm_set1_ps(in[i].y))),
+                    _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+                if (translate) r = _mm_add_ps(r, c3);
+                store3(&out[i].x, r);
+            }
+        #else
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i] = glm::vec3(m * glm::vec4(in[i], translate ? 1 : 0));
+            }
+        #endif
+        }
+
+        // o = m * vec4(x, y, z, translate ? 1 : 0) on separate component arrays, in and out may alias
+        template <bool translate>
+        inline void transformSoA(const glm::mat4& m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t count)
+        {
+            size_t i = 0;
+        #if defined(TRANSFORM_TREE_GLM_AVX2)
+            {
+                const __m256 m00 = _mm256_set1_ps(m[0][0]), m01 = _mm256_set1_ps(m[0][1]), m02 = _mm256_set1_ps(m[0][2]);
+                const __m256 m10 = _mm256_set1_ps(m[1][0]), m11 = _mm256_set1_ps(m[1][1]), m12 = _mm256_set1_ps(m[1][2]);
+                const __m256 m20 = _mm256_set1_ps(m[2][0]), m21 = _mm256_set1_ps(m[2][1]), m22 = _mm256_set1_ps(m[2][2]);
+                const __m256 m30 = _mm256_set1_ps(translate ? m[3][0] : 0), m31 = _mm256_set1_ps(translate ? m[3][1] : 0), m32 = _mm256_set1_ps(translate ? m[3][2] : 0);
+                for (; i + 8 <= count; i += 8)
+                {
+                    __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+                    _mm256_storeu_ps(ox + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, vx), _mm256_mul_ps(m10, vy)), _mm256_add_ps(_mm256_mul_ps(m20, vz), m30)));
+                    _mm256_storeu_ps(oy + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, vx), _mm256_mul_ps(m11, vy)), _mm256_add_ps(_mm256_mul_ps(m21, vz), m31)));
+                    _mm256_storeu_ps(oz + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, vx), _mm256_mul_ps(m12, vy)), _mm256_add_ps(_mm256_mul_ps(m22, vz), m32)));
+                }
+            }
+        #endif
+        #if defined(TRANSFORM_TREE_GLM_SSE2)
+            {
+                const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]);
+                const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]);
+                const __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]);
+                const __m128 m30 = _mm_set1_ps(translate ? m[3][0] : 0), m31 = _mm_set1_ps(translate ? m[3][1] : 0), m32 = _mm_set1_ps(translate ? m[3][2] : 0);
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+                    _mm_storeu_ps(ox + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, vx), _mm_mul_ps(m10, vy)), _mm_add_ps(_mm_mul_ps(m20, vz), m30)));
+                    _mm_storeu_ps(oy + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, vx), _mm_mul_ps(m11, vy)), _mm_add_ps(_mm_mul_ps(m21, vz), m31)));
+                    _mm_storeu_ps(oz + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, vx), _mm_mul_ps(m12, vy)), _mm_add_ps(_mm_mul_ps(m22, vz), m32)));
+                }
+            }
+        #endif
+            for (; i < count; ++i)
+            {
+                float vx = x[i], vy = y[i], vz = z[i];
+                ox[i] = m[0][0] * vx + m[1][0] * vy + (m[2][0] * vz + (translate ? m[3][0] : 0));
+                oy[i] = m[0][1] * vx + m[1][1] * vy + (m[2][1] * vz + (translate ? m[3][1] : 0));
+                oz[i] = m[0][2] * vx + m[1][2] * vy + (m[2][2] * vz + (translate ? m[3][2] : 0));
+            }
+        }
+
+    } // namespace detail
+
+    // inverse transpose of the upper 3x3, transforms normals without distorting them under non-uniform scale
+    inline glm::mat4 normalMatrix(const glm::mat4& m)
+    {
+        return glm::mat4(glm::transpose(glm::inverse(glm::mat3(m))));
+    }
+
+    inline void transformPoints(const glm::mat4& m, const glm::vec3* in, glm::vec3* out, size_t count)
+    {
+        detail::transformAoS<true>(m, in, out, count);
+    }
+    inline void transformDirections(const glm::mat4& m, const glm::vec3* in, glm::vec3* out, size_t count)
+    {
+        detail::transformAoS<false>(m, in, out, count);
+    }
+    // results are normalized
+    inline void transformNormals(const glm::mat4& m, const glm::vec3* in, glm::vec3* out, size_t count)
+    {
+        detail::transformAoS<false>(normalMatrix(m), in, out, count);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = glm::normalize(out[i]);
+    }
+
+    inline void transformPoints(const glm::mat4& m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t count)
+    {
+        detail::transformSoA<true>(m, x, y, z, ox, oy, oz, count);
+    }
+    inline void transformDirections(const glm::mat4& m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t count)
+    {
+        detail::transformSoA<false>(m, x, y, z, ox, oy, oz, count);
+    }
+    // results are normalized
+    inline void transformNormals(const glm::mat4& m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t count)
+    {
+        detail::transformSoA<false>(normalMatrix(m), x, y, z, ox, oy, oz, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            float oneOverLength = 1.0f / std::sqrt(ox[i] * ox[i] + oy[i] * oy[i] + oz[i] * oz[i]);
+            ox[i] *= oneOverLength;
+            oy[i] *= oneOverLength;
+            oz[i] *= oneOverLength;
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region other scalar types
+    // Scalar implementations of the kernels above for any glm scalar type, e.g. double.
+    // The float overloads above are exact matches and take precedence over these templates,
+    // so the float path keeps its SIMD kernels and compact storage.
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> composeAffine(const glm::mat<4, 4, T, Q>& a, const glm::mat<4, 4, T, Q>& b)
+    {
+        glm::mat<4, 4, T, Q> result;
+        for (int col = 0; col < 3; ++col)
+        {
+            result[col] = a[0] * b[col].x + a[1] * b[col].y + a[2] * b[col].z;
+        }
+        result[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+        return result;
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> affineFromTRS(const glm::vec<3, T, Q>& position, const glm::qua<T, Q>& rotation, const glm::vec<3, T, Q>& scale)
+    {
+        const T x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+        const T xx = x * x, yy = y * y, zz = z * z;
+        const T xy = x * y, xz = x * z, yz = y * z;
+        const T wx = w * x, wy = w * y, wz = w * z;
+        glm::mat<4, 4, T, Q> result;
+        result[0] = glm::vec<4, T, Q>(scale.x * (1 - 2 * (yy + zz)), scale.x * (2 * (xy + wz)),     scale.x * (2 * (xz - wy)),     0);
+        result[1] = glm::vec<4, T, Q>(scale.y * (2 * (xy - wz)),     scale.y * (1 - 2 * (xx + zz)), scale.y * (2 * (yz + wx)),     0);
+        result[2] = glm::vec<4, T, Q>(scale.z * (2 * (xz + wy)),     scale.z * (2 * (yz - wx)),     scale.z * (1 - 2 * (xx + yy)), 0);
+        result[3] = glm::vec<4, T, Q>(position, 1);
+        return result;
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> invertAffine(const glm::mat<4, 4, T, Q>& m)
+    {
+        return glm::affineInverse(m);
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> invertRigid(const glm::mat<4, 4, T, Q>& m)
+    {
+        glm::mat<3, 3, T, Q> rotation = glm::transpose(glm::mat<3, 3, T, Q>(m));
+        glm::vec<3, T, Q> translation = -(rotation * glm::vec<3, T, Q>(m[3]));
+        return glm::mat<4, 4, T, Q>(
+            glm::vec<4, T, Q>(rotation[0], 0),
+            glm::vec<4, T, Q>(rotation[1], 0),
+            glm::vec<4, T, Q>(rotation[2], 0),
+            glm::vec<4, T, Q>(translation, 1)
+        );
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline bool decomposeAffine(const glm::mat<4, 4, T, Q>& m, glm::vec<3, T, Q>& position, glm::qua<T, Q>& rotation, glm::vec<3, T, Q>& scale, T tolerance = T(1e-4))
+    {
+        using vec3_type = glm::vec<3, T, Q>;
+        if ((m[0][3] != 0) || (m[1][3] != 0) || (m[2][3] != 0) || (m[3][3] != 1)) return false;
+        vec3_type c0(m[0]), c1(m[1]), c2(m[2]);
+        vec3_type s(glm::length(c0), glm::length(c1), glm::length(c2));
+        if ((s.x == 0) || (s.y == 0) || (s.z == 0)) return false;
+        c0 /= s.x;
+        c1 /= s.y;
+        c2 /= s.z;
+        if ((glm::abs(glm::dot(c0, c1)) > tolerance) 
+         || (glm::abs(glm::dot(c0, c2)) > tolerance) 
+         || (glm::abs(glm::dot(c1, c2)) > tolerance)) return false;
+        if (glm::dot(c0, glm::cross(c1, c2)) < 0)
+        {
+            s = -s;
+            c0 = -c0;
+            c1 = -c1;
+        }
+        c1 = glm::normalize(c1 - c0 * glm::dot(c0, c1));
+        c2 = glm::cross(c0, c1);
+        rotation = glm::quat_cast(glm::mat<3, 3, T, Q>(c0, c1, c2));
+        position = vec3_type(m[3]);
+        scale = s;
+        return true;
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline bool decompose(const glm::mat<4, 4, T, Q>& m, glm::vec<3, T, Q>& position, glm::qua<T, Q>& rotation, glm::vec<3, T, Q>& scale)
+    {
+        if (decomposeAffine(m, position, rotation, scale)) return true;
+        glm::vec<3, T, Q> skew;
+        glm::vec<4, T, Q> perspective;
+        return glm::decompose(m, scale, rotation, position, skew, perspective);
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline const glm::mat<4, 4, T, Q>& toMat4(const glm::mat<4, 4, T, Q>& m) { return m; }
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> affineMatrixFromTRS(const glm::vec<3, T, Q>& position, const glm::qua<T, Q>& rotation, const glm::vec<3, T, Q>& scale)
+    {
+        return affineFromTRS(position, rotation, scale);
+    }
+
+    // storage format of cached affine matrices for scalar type T, only float uses affine_matrix
+    template <typename T>
+    struct affine_storage
+    {
+        using matrix = glm::mat<4, 4, T>;
+        using mat4_result = const glm::mat<4, 4, T>&;
+    };
+    template <>
+    struct affine_storage<float>
+    {
+        using matrix = affine_matrix;
+        using mat4_result = affine_mat4_result;
+    };
+
+    template <typename T, glm::qualifier Q>
+    inline glm::mat<4, 4, T, Q> normalMatrix(const glm::mat<4, 4, T, Q>& m)
+    {
+        return glm::mat<4, 4, T, Q>(glm::transpose(glm::inverse(glm::mat<3, 3, T, Q>(m))));
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline void transformPoints(const glm::mat<4, 4, T, Q>& m, const glm::vec<3, T, Q>* in, glm::vec<3, T, Q>* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = glm::vec<3, T, Q>(m * glm::vec<4, T, Q>(in[i], 1));
+    }
+    template <typename T, glm::qualifier Q>
+    inline void transformDirections(const glm::mat<4, 4, T, Q>& m, const glm::vec<3, T, Q>* in, glm::vec<3, T, Q>* out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = glm::vec<3, T, Q>(m * glm::vec<4, T, Q>(in[i], 0));
+    }
+    template <typename T, glm::qualifier Q>
+    inline void transformNormals(const glm::mat<4, 4, T, Q>& m, const glm::vec<3, T, Q>* in, glm::vec<3, T, Q>* out, size_t count)
+    {
+        transformDirections(normalMatrix(m), in, out, count);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = glm::normalize(out[i]);
+    }
+
+    template <typename T, glm::qualifier Q>
+    inline void transformPoints(const glm::mat<4, 4, T, Q>& m, const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            T vx = x[i], vy = y[i], vz = z[i];
+            ox[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0];
+            oy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1];
+            oz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2];
+        }
+    }
+    template <typename T, glm::qualifier Q>
+    inline void transformDirections(const glm::mat<4, 4, T, Q>& m, const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            T vx = x[i], vy = y[i], vz = z[i];
+            ox[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz;
+            oy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz;
+            oz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz;
+        }
+    }
+    template <typename T, glm::qualifier Q>
+    inline void transformNormals(const glm::mat<4, 4, T, Q>& m, const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, size_t count)
+    {
+        transformDirections(normalMatrix(m), x, y, z, ox, oy, oz, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            T oneOverLength = T(1) / std::sqrt(ox[i] * ox[i] + oy[i] * oy[i] + oz[i] * oz[i]);
+            ox[i] *= oneOverLength;
+            oy[i] *= oneOverLength;
+            oz[i] *= oneOverLength;
+        }
+    }
+
+    #pragma endregion
+
+    #pragma region batch kernels
+
+    // structure-of-arrays input for affineFromTRS, one array per component
+    struct SoATRS
+    {
+        const float* px; const float* py; const float* pz;
+        const float* qx; const float* qy; const float* qz; const float* qw;
+        const float* sx; const float* sy; const float* sz;
+    };
+
+    // structure-of-arrays affine matrices, m[col][row] points to the array of that element.
+    // the last row (0,0,0,1) is implicit.
+    struct SoAAffine
+    {
+        float* m[4][3];
+    };
+
+    struct SoAConstAffine
+    {
+        const float* m[4][3];
+
+        SoAConstAffine() = default;
+        SoAConstAffine(const SoAAffine& other)
+        {
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    m[col][row] = other.m[col][row];
+        }
+    };
+
+    namespace detail {
+
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        // builds matrices of 4 nodes starting at index i
+        inline void affineFromTRS4(const SoATRS& in, size_t i, glm::mat4* out)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            __m128 x = _mm_loadu_ps(in.qx + i), y = _mm_loadu_ps(in.qy + i), z = _mm_loadu_ps(in.qz + i), w = _mm_loadu_ps(in.qw + i);
+            __m128 sx = _mm_loadu_ps(in.sx + i), sy = _mm_loadu_ps(in.sy + i), sz = _mm_loadu_ps(in.sz + i);
+            __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+            __m128 c0x = _mm_mul_ps(sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+            __m128 c0y = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xy, wz)));
+            __m128 c0z = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xz, wy)));
+            __m128 c0w = _mm_setzero_ps();
+            __m128 c1x = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(xy, wz)));
+            __m128 c1y = _mm_mul_ps(sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+            __m128 c1z = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(yz, wx)));
+            __m128 c1w = _mm_setzero_ps();
+            __m128 c2x = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(xz, wy)));
+            __m128 c2y = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(yz, wx)));
+            __m128 c2z = _mm_mul_ps(sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+            __m128 c2w = _mm_setzero_ps();
+            __m128 c3x = _mm_loadu_ps(in.px + i), c3y = _mm_loadu_ps(in.py + i), c3z = _mm_loadu_ps(in.pz + i);
+            __m128 c3w = one;
+
+            // lanes hold nodes, transposing turns them into matrix columns
+            _MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+            _MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+            _MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+            _MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+            __m128 cols[4][4] = {
+                { c0x, c1x, c2x, c3x },
+                { c0y, c1y, c2y, c3y },
+                { c0z, c1z, c2z, c3z },
+                { c0w, c1w, c2w, c3w }
+            };
+            for (int k = 0; k < 4; ++k)
+            {
+                float* pr = &out[i + k][0][0];
+                for (int col = 0; col < 4; ++col)
+                    _mm_storeu_ps(pr + 4 * col, cols[k][col]);
+            }
+        }
+    #endif
+
+    #if defined(TRANSFORM_TREE_GLM_AVX2)
+        inline void transpose8x4(__m256 v0, __m256 v1, __m256 v2, __m256 v3, __m128 (&lo)[4], __m128 (&hi)[4])
+        {
+            __m128 l0 = _mm256_castps256_ps128(v0), l1 = _mm256_castps256_ps128(v1), l2 = _mm256_castps256_ps128(v2), l3 = _mm256_castps256_ps128(v3);
+            __m128 h0 = _mm256_extractf128_ps(v0, 1), h1 = _mm256_extractf128_ps(v1, 1), h2 = _mm256_extractf128_ps(v2, 1), h3 = _mm256_extractf128_ps(v3, 1);
+            _MM_TRANSPOSE4_PS(l0, l1, l2, l3);
+            _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+            lo[0] = l0; lo[1] = l1; lo[2] = l2; lo[3] = l3;
+            hi[0] = h0; hi[1] = h1; hi[2] = h2; hi[3] = h3;
+        }
+
+        // builds matrices of 8 nodes starting at index i
+        inline void affineFromTRS8(const SoATRS& in, size_t i, glm::mat4* out)
+        {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            const __m256 zero = _mm256_setzero_ps();
+            __m256 x = _mm256_loadu_ps(in.qx + i), y = _mm256_loadu_ps(in.qy + i), z = _mm256_loadu_ps(in.qz + i), w = _mm256_loadu_ps(in.qw + i);
+            __m256 sx = _mm256_loadu_ps(in.sx + i), sy = _mm256_loadu_ps(in.sy + i), sz = _mm256_loadu_ps(in.sz + i);
+            __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+            __m128 cols[4][8];
+            __m128 lo[4], hi[4];
+            transpose8x4(
+                _mm256_mul_ps(sx, _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz)))),
+                _mm256_mul_ps(sx, _mm256_mul_ps(two, _mm256_add_ps(xy, wz))),
+                _mm256_mul_ps(sx, _mm256_mul_ps(two, _mm256_sub_ps(xz, wy))),
+                zero, lo, hi);
+            for (int k = 0; k < 4; ++k) { cols[0][k] = lo[k]; cols[0][k + 4] = hi[k]; }
+            transpose8x4(
+                _mm256_mul_ps(sy, _mm256_mul_ps(two, _mm256_sub_ps(xy, wz))),
+                _mm256_mul_ps(sy, _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz)))),
+                _mm256_mul_ps(sy, _mm256_mul_ps(two, _mm256_add_ps(yz, wx))),
+                zero, lo, hi);
+            for (int k = 0; k < 4; ++k) { cols[1][k] = lo[k]; cols[1][k + 4] = hi[k]; }
+            transpose8x4(
+                _mm256_mul_ps(sz, _mm256_mul_ps(two, _mm256_add_ps(xz, wy))),
+                _mm256_mul_ps(sz, _mm256_mul_ps(two, _mm256_sub_ps(yz, wx))),
+                _mm256_mul_ps(sz, _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)))),
+                zero, lo, hi);
+            for (int k = 0; k < 4; ++k) { cols[2][k] = lo[k]; cols[2][k + 4] = hi[k]; }
+            transpose8x4(
+                _mm256_loadu_ps(in.px + i),
+                _mm256_loadu_ps(in.py + i),
+                _mm256_loadu_ps(in.pz + i),
+                one, lo, hi);
+            for (int k = 0; k < 4; ++k) { cols[3][k] = lo[k]; cols[3][k + 4] = hi[k]; }
+
+            for (int k = 0; k < 8; ++k)
+            {
+                float* pr = &out[i + k][0][0];
+                for (int col = 0; col < 4; ++col)
+                    _mm_storeu_ps(pr + 4 * col, cols[col][k]);
+            }
+        }
+    #endif
+
+        // lanes of W floats, the kernels below are written once for all widths
+        template <int W> struct Lanes;
+
+        template <>
+        struct Lanes<1>
+        {
+            using type = float;
+            static inline type load(const float* p) { return *p; }
+            static inline void store(float* p, type v) { *p = v; }
+            static inline type set1(float v) { return v; }
+            static inline type add(type a, type b) { return a + b; }
+            static inline type sub(type a, type b) { return a - b; }
+            static inline type mul(type a, type b) { return a * b; }
+            static inline type div(type a, type b) { return a / b; }
+        };
+
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        template <>
+        struct Lanes<4>
+        {
+            using type = __m128;
+            static inline type load(const float* p) { return _mm_loadu_ps(p); }
+            static inline void store(float* p, type v) { _mm_storeu_ps(p, v); }
+            static inline type set1(float v) { return _mm_set1_ps(v); }
+            static inline type add(type a, type b) { return _mm_add_ps(a, b); }
+            static inline type sub(type a, type b) { return _mm_sub_ps(a, b); }
+            static inline type mul(type a, type b) { return _mm_mul_ps(a, b); }
+            static inline type div(type a, type b) { return _mm_div_ps(a, b); }
+        };
+    #endif
+
+    #if defined(TRANSFORM_TREE_GLM_AVX2)
+        template <>
+        struct Lanes<8>
+        {
+            using type = __m256;
+            static inline type load(const float* p) { return _mm256_loadu_ps(p); }
+            static inline void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+            static inline type set1(float v) { return _mm256_set1_ps(v); }
+            static inline type add(type a, type b) { return _mm256_add_ps(a, b); }
+            static inline type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+            static inline type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+            static inline type div(type a, type b) { return _mm256_div_ps(a, b); }
+        };
+    #endif
+
+        // out = a * b for W matrices starting at index i, out may alias a or b.
+        // same order of operations as the single matrix composeAffine.
+        template <int W>
+        inline void composeAffineLanes(const SoAConstAffine& a, const SoAConstAffine& b, size_t i, const SoAAffine& out)
+        {
+            using L = Lanes<W>;
+            typename L::type ma[4][3], mb[4][3];
+            for (int col = 0; col < 4; ++col)
+            {
+                for (int row = 0; row < 3; ++row)
+                {
+                    ma[col][row] = L::load(a.m[col][row] + i);
+                    mb[col][row] = L::load(b.m[col][row] + i);
+                }
+            }
+            for (int col = 0; col < 4; ++col)
+            {
+                for (int row = 0; row < 3; ++row)
+                {
+                    typename L::type r = L::add(
+                        L::add(
+                            L::mul(ma[0][row], mb[col][0]),
+                            L::mul(ma[1][row], mb[col][1])),
+                        L::mul(ma[2][row], mb[col][2]));
+                    if (col == 3) r = L::add(r, ma[3][row]);
+                    L::store(out.m[col][row] + i, r);
+                }
+            }
+        }
+
+        // out = inverse(in) for W matrices starting at index i, out may alias in.
+        // same order of operations as the SSE2 single matrix invertAffine.
+        template <int W>
+        inline void invertAffineLanes(const SoAConstAffine& in, size_t i, const SoAAffine& out)
+        {
+            using L = Lanes<W>;
+            using V = typename L::type;
+            V c[3][3], t[3];
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int col = 0; col < 3; ++col)
+                    c[col][row] = L::load(in.m[col][row] + i);
+                t[row] = L::load(in.m[3][row] + i);
+            }
+            // rows of the adjugate are cross products of the columns
+            auto cross = [](const V (&a)[3], const V (&b)[3], V (&r)[3])
+            {
+                for (int k = 0; k < 3; ++k)
+                    r[k] = L::sub(L::mul(a[(k + 1) % 3], b[(k + 2) % 3]), L::mul(a[(k + 2) % 3], b[(k + 1) % 3]));
+            };
+            V r[3][3];
+            cross(c[1], c[2], r[0]);
+            cross(c[2], c[0], r[1]);
+            cross(c[0], c[1], r[2]);
+
+            V det = L::add(L::add(L::mul(c[0][0], r[0][0]), L::mul(c[0][1], r[0][1])), L::mul(c[0][2], r[0][2]));
+            V oneOverDet = L::div(L::set1(1.0f), det);
+            // column col of the inverse is (r[0][col], r[1][col], r[2][col])
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int col = 0; col < 3; ++col)
+                    r[row][col] = L::mul(r[row][col], oneOverDet);
+            }
+            V it[3];
+            for (int row = 0; row < 3; ++row)
+            {
+                it[row] = L::sub(L::set1(0.0f), L::add(
+                    L::add(
+                        L::mul(r[row][0], t[0]),
+                        L::mul(r[row][1], t[1])),
+                    L::mul(r[row][2], t[2])));
+            }
+            for (int col = 0; col < 3; ++col)
+            {
+                for (int row = 0; row < 3; ++row)
+                    L::store(out.m[col][row] + i, r[row][col]);
+            }
+            for (int row = 0; row < 3; ++row)
+                L::store(out.m[3][row] + i, it[row]);
+        }
+
+    } // namespace detail
+
+    // builds count matrices from structure-of-arrays input, 8 or 4 nodes at a time where available
+    inline void affineFromTRS(const SoATRS& in, size_t count, glm::mat4* out)
+    {
+        size_t i = 0;
+    #if defined(TRANSFORM_TREE_GLM_AVX2)
+        for (; i + 8 <= count; i += 8)
+            detail::affineFromTRS8(in, i, out);
+    #endif
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        for (; i + 4 <= count; i += 4)
+            detail::affineFromTRS4(in, i, out);
+    #endif
+        for (; i < count; ++i)
+        {
+            out[i] = affineFromTRS(
+                glm::vec3(in.px[i], in.py[i], in.pz[i]),
+                glm::quat(in.qw[i], in.qx[i], in.qy[i], in.qz[i]),
+                glm::vec3(in.sx[i], in.sy[i], in.sz[i])
+            );
+        }
+    }
+
+    // decompose count matrices, see decompose. returns the number of matrices that could not be decomposed,
+    // their outputs are left untouched.
+    inline size_t decompose(const glm::mat4* in, size_t count, glm::vec3* positions, glm::quat* rotations, glm::vec3* scales)
+    {
+        size_t failed = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!decompose(in[i], positions[i], rotations[i], scales[i]))
+                ++failed;
+        }
+        return failed;
+    }
+
+    // out[i] = a[i] * b[i], one matrix at a time with the single matrix kernel.
+    // use the structure-of-arrays overload below to process 8 or 4 matrices at a time.
+    inline void composeAffine(const glm::mat4* a, const glm::mat4* b, size_t count, glm::mat4* out)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = composeAffine(a[i], b[i]);
+    }
+
+    // out[i] = inverse(in[i]), one matrix at a time with the single matrix kernel
+    inline void invertAffine(const glm::mat4* in, size_t count, glm::mat4* out)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = invertAffine(in[i]);
+    }
+
+    // out[i] = a[i] * b[i] on structure-of-arrays matrices, 8 or 4 at a time where available.
+    // out may alias a or b.
+    inline void composeAffine(const SoAConstAffine& a, const SoAConstAffine& b, size_t count, const SoAAffine& out)
+    {
+        size_t i = 0;
+    #if defined(TRANSFORM_TREE_GLM_AVX2)
+        for (; i + 8 <= count; i += 8)
+            detail::composeAffineLanes<8>(a, b, i, out);
+    #endif
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        for (; i + 4 <= count; i += 4)
+            detail::composeAffineLanes<4>(a, b, i, out);
+    #endif
+        for (; i < count; ++i)
+            detail::composeAffineLanes<1>(a, b, i, out);
+    }
+
+    // out[i] = inverse(in[i]) on structure-of-arrays matrices, 8 or 4 at a time where available.
+    // out may alias in.
+    inline void invertAffine(const SoAConstAffine& in, size_t count, const SoAAffine& out)
+    {
+        size_t i = 0;
+    #if defined(TRANSFORM_TREE_GLM_AVX2)
+        for (; i + 8 <= count; i += 8)
+            detail::invertAffineLanes<8>(in, i, out);
+    #endif
+    #if defined(TRANSFORM_TREE_GLM_SSE2)
+        for (; i + 4 <= count; i += 4)
+            detail::invertAffineLanes<4>(in, i, out);
+    #endif
+        for (; i < count; ++i)
+            detail::invertAffineLanes<1>(in, i, out);
+    }
+
+    #pragma endregion
+
+} // namespace transform_tree_glm
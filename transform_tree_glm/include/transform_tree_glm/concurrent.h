@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace transform_tree_glm {
+
+    // Single writer, many readers buffer for a glm matrix, a seqlock over two slots.
+    // The writer alternates between the slots, so a reader only retries when the writer
+    // completed two stores during its read. Readers never block the writer and never see torn values.
+    // The value is stored as relaxed atomic scalars, so concurrent access is free of data races.
+    template <typename value_t>
+    class SeqLockBuffer_
+    {
+    public:
+        using value_type = value_t;
+        using scalar_type = typename value_t::value_type;
+        static constexpr size_t word_count = sizeof(value_type) / sizeof(scalar_type);
+
+        SeqLockBuffer_(const value_type& value = value_type(1))
+        {
+            const scalar_type* src = &value[0][0];
+            for (size_t i = 0; i < word_count; ++i)
+                m_slots[0].words[i].store(src[i], std::memory_order_relaxed);
+            m_slots[0].sequence.store(0, std::memory_order_relaxed);
+            m_slots[1].sequence.store(0, std::memory_order_relaxed);
+            m_version.store(0, std::memory_order_release);
+        }
+
+        SeqLockBuffer_(const SeqLockBuffer_&) = delete;
+        SeqLockBuffer_& operator=(const SeqLockBuffer_&) = delete;
+
+        // only one thread may store at a time
+        inline void store(const value_type& value)
+        {
+            uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+            Slot& slot = m_slots[version & 1];
+            // odd sequence marks the slot as being written
+            slot.sequence.store(2 * version - 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            const scalar_type* src = &value[0][0];
+            for (size_t i = 0; i < word_count; ++i)
+                slot.words[i].store(src[i], std::memory_order_relaxed);
+            slot.sequence.store(2 * version, std::memory_order_release);
+            m_version.store(version, std::memory_order_release);
+        }
+
+        // latest completely stored value, may be called from any number of threads
+        inline value_type load() const
+        {
+            value_type result;
+            scalar_type* dst = &result[0][0];
+            for (;;)
+            {
+                uint64_t version = m_version.load(std::memory_order_acquire);
+                const Slot& slot = m_slots[version & 1];
+                uint64_t before = slot.sequence.load(std::memory_order_acquire);
+                for (size_t i = 0; i < word_count; ++i)
+                    dst[i] = slot.words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+                if ((before == after) && ((before & 1) == 0)) return result;
+            }
+        }
+
+        // number of completed stores
+        inline uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+    protected:
+        struct alignas(64) Slot
+        {
+            std::atomic<uint64_t> sequence;
+            std::atomic<scalar_type> words[word_count];
+        };
+
+        Slot m_slots[2];
+        alignas(64) std::atomic<uint64_t> m_version;
+    };
+
+} // namespace transform_tree_glm
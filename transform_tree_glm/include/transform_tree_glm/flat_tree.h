@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp> 
+
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/transform.h"
+
+namespace transform_tree_glm {
+
+    // Compiled structure-of-arrays view of a Transform_ subtree.
+    // Nodes are stored in parent-before-child order, so all world poses can be 
+    // computed in one linear pass without chasing hierarchy pointers.
+    // The view is relinearized on update() whenever the revision of the subtree changed,
+    // reusing the ranges of unchanged subtrees, see rebuild().
+    template <typename transform_t>
+    class FlatTree_
+    {
+    public:
+        using transform_type = transform_t;
+        using pointer = transform_t*;
+        using index_type = typename transform_t::idx_type;
+        using size_type = size_t;
+        using vec3_type = typename transform_t::vec3_type;
+        using quat_type = typename transform_t::quat_type;
+        using affine_type = typename transform_t::affine_type;
+
+        static constexpr index_type no_parent = index_type(-1);
+
+        FlatTree_(pointer root = nullptr)
+            : m_root(root)
+        {}
+
+        #pragma region attributes
+        inline pointer root() const { return m_root; }
+        inline void setRoot(pointer root) 
+        { 
+            m_root = root; 
+            m_valid = false; 
+        }
+
+        inline bool empty() const { return m_nodes.empty(); }
+        inline size_type size() const { return m_nodes.size(); }
+
+        // topology of the subtree changed since last rebuild
+        inline bool isStale() const { return !m_valid || (m_root && (m_root->revision() != m_revision)); }
+        #pragma endregion
+
+        #pragma region array access
+        inline const std::vector<pointer>&    nodes()      const { return m_nodes; }
+        inline const std::vector<index_type>& parents()    const { return m_parents; }
+        inline const std::vector<affine_type>& worldPoses() const { return m_worldPoses; }
+
+        // local transformation parameters, filled by gather().
+        // may be modified directly before calling compute().
+        inline std::vector<vec3_type>& positions() { return m_positions; }
+        inline std::vector<quat_type>& rotations() { return m_rotations; }
+        inline std::vector<vec3_type>& scales()    { return m_scales; }
+
+        inline const std::vector<vec3_type>& positions() const { return m_positions; }
+        inline const std::vector<quat_type>& rotations() const { return m_rotations; }
+        inline const std::vector<vec3_type>& scales()    const { return m_scales; }
+        #pragma endregion
+
+        #pragma region update
+        // Rebuild if necessary, then gather, compute and scatter.
+        // Always linear in the subtree size, all world poses are recomputed even if no local pose changed.
+        inline void update()
+        {
+            if (isStale()) rebuild();
+            gather();
+            compute();
+            scatter();
+        }
+
+        // Linearizes the subtree of root in parent-before-child order.
+        // The previous linearization is patched instead of walking the whole subtree again:
+        // subtrees whose revision did not change since the last rebuild are copied over as one
+        // range of the old arrays, only nodes on the paths to changed subtrees and their direct
+        // children are visited. Copying the unchanged ranges is still linear in the subtree size,
+        // but sequential and without touching the nodes.
+        inline void rebuild()
+        {
+            bool patch = m_valid && !m_nodes.empty() && (m_nodes[0] == m_root);
+            m_newNodes.clear();
+            m_newParents.clear();
+            m_newRevisions.clear();
+            m_newEnds.clear();
+            m_valid = true;
+            if (m_root != nullptr)
+            {
+                m_revision = m_root->revision();
+                place(m_root, patch ? 0 : no_parent, no_parent);
+                while (!m_frames.empty())
+                {
+                    Frame& frame = m_frames.back();
+                    if (frame.next == nullptr)
+                    {
+                        m_newEnds[frame.index] = static_cast<index_type>(m_newNodes.size());
+                        m_oldChildren.resize(frame.oldChildren);
+                        m_frames.pop_back();
+                        continue;
+                    }
+                    pointer child = frame.next;
+                    frame.next = child->next();
+                    index_type parent = frame.index;
+                    // may push a frame, invalidating frame
+                    place(child, findOldChild(frame.oldChildren, child), parent);
+                }
+            }
+            m_nodes.swap(m_newNodes);
+            m_parents.swap(m_newParents);
+            m_revisions.swap(m_newRevisions);
+            m_ends.swap(m_newEnds);
+            m_positions.resize(m_nodes.size());
+            m_rotations.resize(m_nodes.size());
+            m_scales.resize(m_nodes.size());
+            m_worldPoses.resize(m_nodes.size());
+        }
+
+        // copy local transformation parameters from nodes into arrays
+        inline void gather()
+        {
+            for (size_type i = 0; i < m_nodes.size(); ++i)
+            {
+                const transform_type& node = *m_nodes[i];
+                m_positions[i] = node.accessConstLocalPosition();
+                m_rotations[i] = node.accessConstLocalRotation();
+                m_scales[i]    = node.accessConstLocalScale();
+            }
+        }
+
+        // compute world poses from local transformation parameters in one linear pass
+        inline void compute()
+        {
+            if (m_nodes.empty()) return;
+            affine_type parentToRoot = m_root->parent() ? m_root->parent()->worldAffine() : affine_type(1);
+            for (size_type i = 0; i < m_nodes.size(); ++i)
+            {
+                affine_type local = affineMatrixFromTRS(m_positions[i], m_rotations[i], m_scales[i]);
+                const affine_type& parentWorld = (m_parents[i] == no_parent) ? parentToRoot : m_worldPoses[m_parents[i]];
+                m_worldPoses[i] = composeAffine(parentWorld, local);
+            }
+        }
+
+        // write computed world poses into the world pose caches of the nodes
+        inline void scatter()
+        {
+            for (size_type i = 0; i < m_nodes.size(); ++i)
+            {
+                m_nodes[i]->m_worldPose = m_worldPoses[i];
+                m_nodes[i]->m_dirtyWorldPose = false;
+                // computed from matrices, so descendants compose their world poses from matrices as well
+                m_nodes[i]->m_rigidWorld = false;
+                m_nodes[i]->m_dirtyInverseWorldPose = true;
+            }
+        }
+        #pragma endregion
+
+    protected:
+        // node being linearized during rebuild(), its children are placed one by one
+        struct Frame
+        {
+            pointer next;
+            index_type index;
+            // start of the old children of node in m_oldChildren
+            size_type oldChildren;
+        };
+
+        // appends node below parent, old is its index in the previous arrays or no_parent
+        inline void place(pointer node, index_type old, index_type parent)
+        {
+            if ((old != no_parent) && (node->revision() == m_revisions[old]))
+            {
+                copyRange(old, parent);
+                return;
+            }
+            index_type index = static_cast<index_type>(m_newNodes.size());
+            m_newNodes.push_back(node);
+            m_newParents.push_back(parent);
+            m_newRevisions.push_back(node->revision());
+            m_newEnds.push_back(index);
+            size_type oldChildren = m_oldChildren.size();
+            if (old != no_parent)
+            {
+                // children of old are found by skipping over their subtree ranges
+                for (index_type k = old + 1; k < m_ends[old]; k = m_ends[k])
+                    m_oldChildren.emplace_back(m_nodes[k], k);
+                std::sort(m_oldChildren.begin() + oldChildren, m_oldChildren.end());
+            }
+            m_frames.push_back(Frame{node->front(), index, oldChildren});
+        }
+
+        // appends the unchanged subtree at old from the previous arrays below parent
+        inline void copyRange(index_type old, index_type parent)
+        {
+            index_type first = old;
+            index_type last = m_ends[old];
+            index_type base = static_cast<index_type>(m_newNodes.size());
+            for (index_type k = first; k < last; ++k)
+            {
+                m_newNodes.push_back(m_nodes[k]);
+                m_newParents.push_back((k == first) ? parent : m_parents[k] - first + base);
+                m_newRevisions.push_back(m_revisions[k]);
+                m_newEnds.push_back(m_ends[k] - first + base);
+            }
+        }
+
+        inline index_type findOldChild(size_type begin, pointer child) const
+        {
+            auto first = m_oldChildren.begin() + begin;
+            auto it = std::lower_bound(first, m_oldChildren.end(), std::make_pair(child, index_type(0)));
+            return ((it != m_oldChildren.end()) && (it->first == child)) ? it->second : no_parent;
+        }
+
+        pointer m_root = nullptr;
+        Hierarchy::size_type m_revision = 0;
+        bool m_valid = false;
+
+        std::vector<pointer> m_nodes;
+        std::vector<index_type> m_parents;
+        // revision of each node when it was linearized
+        std::vector<Hierarchy::size_type> m_revisions;
+        // one past the last node of the subtree of each node
+        std::vector<index_type> m_ends;
+        std::vector<vec3_type> m_positions;
+        std::vector<quat_type> m_rotations;
+        std::vector<vec3_type> m_scales;
+        std::vector<affine_type> m_worldPoses;
+
+        // scratch space for rebuild()
+        std::vector<pointer> m_newNodes;
+        std::vector<index_type> m_newParents;
+        std::vector<Hierarchy::size_type> m_newRevisions;
+        std::vector<index_type> m_newEnds;
+        std::vector<Frame> m_frames;
+        std::vector<std::pair<pointer, index_type>> m_oldChildren;
+    };
+    typedef FlatTree_<Transform> FlatTree;
+
+} // namespace transform_tree_glm
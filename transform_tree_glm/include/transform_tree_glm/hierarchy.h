@@ -1,17 +1,165 @@
 #pragma once
 
+#include <atomic>
 #include <type_traits>
 #include <iterator> // For std::forward_iterator_tag
 #include <cstddef>  // For std::ptrdiff_t
 #include <cassert>
+#include <cstdint>
+#include <deque>
 #include <vector>
 #include <functional>
 
 
 #include "transform_tree_glm/iterable.h"
+#include "transform_tree_glm/small_stack.h"
 
 namespace transform_tree_glm {
 
+    class Hierarchy;
+
+    // Opt-in pre-order linearization (Euler tour) of the subtree of one Hierarchy root.
+    // Every node of the subtree owns an enter and an exit tag in a linked list of tags in
+    // tour order. The tags carry increasing 64 bit labels, so comparing labels answers
+    // "is A an ancestor of B" and "does A come before B" in O(1).
+    // Hierarchy mutators keep the tags up to date. Inserting a subtree adds its tags next
+    // to its new siblings, relabeling a small window around them when the labels run
+    // out of room (amortized O(log n) per tag). Erasing a subtree removes its tags.
+    class OrderList
+    {
+    public:
+        using size_type = size_t;
+        using label_type = uint64_t;
+
+        struct Tag
+        {
+            label_type label = 0;
+            Tag* prev = nullptr;
+            Tag* next = nullptr;
+            Hierarchy* node = nullptr;
+            OrderList* list = nullptr;
+            bool exit = false;
+        };
+
+        OrderList()
+        {
+            m_head.label = 0;
+            m_tail.label = label_type(-1);
+            m_head.next = &m_tail;
+            m_tail.prev = &m_head;
+            m_head.list = this;
+            m_tail.list = this;
+        }
+        ~OrderList() { detach(); }
+
+        OrderList(const OrderList&) = delete;
+        OrderList& operator=(const OrderList&) = delete;
+
+        // number of nodes in the tour
+        inline size_type size() const { return m_numTags / 2; }
+        inline bool empty() const { return m_numTags == 0; }
+        inline Hierarchy* root() const { return m_root; }
+
+        // maintain the tour of the subtree of root, replaces a previously attached root.
+        // the parent of root, if any, must not be ordered.
+        inline void attach(Hierarchy* root);
+        inline void detach();
+
+        // calls f(Hierarchy*) for all nodes in pre-order, sweeping the tags
+        template <typename F> inline void forEach(F&& f) const;
+        // calls f(Hierarchy*) for all descendants of node in pre-order
+        template <typename F> inline void forEachDescendant(const Hierarchy* node, F&& f) const;
+
+    protected:
+        friend class Hierarchy;
+
+        // adds the tags of the subtree of item at its position below its parent
+        inline void insertSubtree(Hierarchy* item);
+        // removes the tags of item and its whole subtree
+        inline void removeSubtree(Hierarchy* item);
+        // removes only the tags of item itself
+        inline void removeTags(Hierarchy* item);
+        // links enter and exit tags of the subtree of item before next, returns the number of tags
+        inline label_type emit(Hierarchy* item, Tag* next);
+
+        inline Tag* allocate(Hierarchy* node, bool exit)
+        {
+            Tag* tag;
+            if (m_free)
+            {
+                tag = m_free;
+                m_free = tag->next;
+            }
+            else
+            {
+                m_storage.emplace_back();
+                tag = &m_storage.back();
+            }
+            tag->node = node;
+            tag->list = this;
+            tag->exit = exit;
+            ++m_numTags;
+            return tag;
+        }
+
+        inline void deallocate(Tag* tag)
+        {
+            tag->prev->next = tag->next;
+            tag->next->prev = tag->prev;
+            tag->node = nullptr;
+            tag->prev = nullptr;
+            tag->next = m_free;
+            m_free = tag;
+            --m_numTags;
+        }
+
+        // link tag before next without assigning a label
+        static inline void linkBefore(Tag* next, Tag* tag)
+        {
+            tag->prev = next->prev;
+            tag->next = next;
+            next->prev->next = tag;
+            next->prev = tag;
+        }
+
+        // Assigns labels to the count unlabeled tags between left and right.
+        // When they do not fit, the range is widened until its label span exceeds the
+        // square of its number of tags and everything inside is spaced out evenly,
+        // see Bender et al., "Two Simplified Algorithms for Maintaining Order in a List".
+        inline void relabel(Tag* left, Tag* right, label_type count)
+        {
+            label_type gaps = count + 1;
+            if (right->label - left->label < gaps)
+            {
+                while ((left != &m_head) || (right != &m_tail))
+                {
+                    bool roomy = (gaps < (label_type(1) << 32)) && (right->label - left->label > gaps * gaps);
+                    if (roomy) break;
+                    if (left != &m_head) left = left->prev;
+                    else right = right->next;
+                    ++gaps;
+                }
+            }
+            label_type step = (right->label - left->label) / gaps;
+            assert(step > 0); // label space exhausted
+            label_type label = left->label;
+            for (Tag* tag = left->next; tag != right; tag = tag->next)
+            {
+                label += step;
+                tag->label = label;
+            }
+        }
+
+        Tag m_head;
+        Tag m_tail;
+        Hierarchy* m_root = nullptr;
+        size_type m_numTags = 0;
+        std::deque<Tag> m_storage;
+        Tag* m_free = nullptr;
+        // open subtrees while emitting tags
+        std::vector<Hierarchy*> m_stack;
+    };
+
     class Hierarchy
     {
     public:
@@ -34,6 +182,19 @@ namespace transform_tree_glm {
         // in parent
         pointer m_prev = nullptr;
         pointer m_next = nullptr;
+        // changes whenever the topology of this subtree changes, see nextRevision()
+        size_type m_revision = 0;
+        // revision of the last insertion, removal or reordering of the children of this node
+        size_type m_childrenRevision = 0;
+        // position in an OrderList, only set when the order of this subtree is maintained
+        OrderList::Tag* m_enter = nullptr;
+        OrderList::Tag* m_exit = nullptr;
+        // cached, kept up to date by the mutators
+        size_type m_depth = 0;
+        pointer m_root = this;
+        size_type m_subtreeSize = 1;
+
+        friend class OrderList;
 
 
     public:
@@ -41,10 +202,12 @@ namespace transform_tree_glm {
         Hierarchy(void* data) : data(data) {}
         void* data = nullptr;
 
+        // the children become roots, see clear()
         ~Hierarchy()
         {
-            erase_from_parent();
             clear();
+            unlink();
+            if (m_enter) m_enter->list->removeSubtree(this);
         }
 
         #pragma region attributes
@@ -61,6 +224,34 @@ namespace transform_tree_glm {
         inline pointer next()   { return m_next; }
         inline pointer front()  { return m_begin; }
         inline pointer back()   { return m_last; }
+
+        inline size_type revision() const { return m_revision; }
+        // only changes with the direct children, not with topology changes further down
+        inline size_type childrenRevision() const { return m_childrenRevision; }
+
+        // distance to root(), 0 for a root. O(1), the mutators rewrite both in every subtree they move.
+        inline size_type     depth()       const { return m_depth; }
+        inline const_pointer root()        const { return m_root; }
+        inline pointer       root()              { return m_root; }
+        // number of nodes in this subtree, including this
+        inline size_type     subtreeSize() const { return m_subtreeSize; }
+
+        // whether this node is part of the tour of an OrderList
+        inline bool isOrdered() const { return m_enter != nullptr; }
+        inline OrderList* orderList() const { return m_enter ? m_enter->list : nullptr; }
+
+        // O(1) when both nodes are in the same OrderList, otherwise walks up from other
+        inline bool isAncestorOf(const_pointer other) const
+        {
+            if ((other == nullptr) || (other == this)) return false;
+            if (m_enter && other->m_enter && (m_enter->list == other->m_enter->list))
+            {
+                return (m_enter->label < other->m_enter->label) && (other->m_exit->label < m_exit->label);
+            }
+            for (const_pointer node = other->m_parent; node != nullptr; node = node->m_parent)
+                if (node == this) return true;
+            return false;
+        }
         #pragma endregion
 
 
@@ -201,17 +392,29 @@ namespace transform_tree_glm {
             //using pointer = typename std::conditional_t< IsConst, value_type const *, value_type * >;
             //using reference = typename std::conditional_t< IsConst, value_type const &, value_type & >;
 
+            // iterates the subtree of ptr, ends after its last descendant
             RecurseIterator(pointer ptr) noexcept
                 : m_item(ptr) 
+                , m_root(ptr)
+                , m_depth(0) 
                 , m_recurseChildren(true) 
+            {}
+
+            // iterates from ptr until the subtree of root is exhausted,
+            // root == nullptr continues through the rest of the whole tree
+            RecurseIterator(pointer ptr, pointer root) noexcept
+                : m_item(ptr) 
+                , m_root(root)
                 , m_depth(0) 
+                , m_recurseChildren(true) 
             {}
 
             template<bool IsConst_ = IsConst, class = std::enable_if_t<IsConst_>>
             RecurseIterator(const RecurseIterator<false>& other) 
                 : m_item(other.m_item) 
-                , m_recurseChildren(other.m_recurseChildren) 
+                , m_root(other.m_root)
                 , m_depth(other.m_depth)
+                , m_recurseChildren(other.m_recurseChildren) 
             {} 
 
             inline int depth() const { return m_depth; }
@@ -242,7 +445,9 @@ namespace transform_tree_glm {
             RecurseIterator& operator=(const RecurseIterator& other)
             {
                 m_item = other.m_item;
+                m_root = other.m_root;
                 m_recurseChildren = other.m_recurseChildren;
+                m_depth = other.m_depth;
                 return *this;
             }
             RecurseIterator& operator++() //prefix increment
@@ -255,30 +460,19 @@ namespace transform_tree_glm {
                         m_item = m_item->m_begin;
                         ++m_depth;
                     }
-                    // has no children
-                    else if (m_item->m_next != nullptr)
-                    {
-                        // advance to next item 
-                        m_item = m_item->m_next;
-                    }
-                    // has no next sibling
                     else 
                     {
-                        // advance to parent, when parent has advanced to end, 
-                        // proceed with next item of its parent, and so on
-                        while (m_item->m_parent != nullptr)
+                        // advance to next sibling of this or of the closest ancestor,
+                        // stop when climbing up to root
+                        while (m_item != m_root)
                         {
-                            if (m_item->m_parent->m_next != nullptr)
+                            if (m_item->m_next != nullptr)
                             {
-                                m_item = m_item->m_parent->m_next;
-                                --m_depth;
+                                m_item = m_item->m_next;
                                 return *this;
                             }
-                            else 
-                            {
-                                m_item = m_item->m_parent;
-                                --m_depth;
-                            }
+                            m_item = m_item->m_parent;
+                            --m_depth;
                         }
                         m_item = nullptr;
                     }
@@ -300,6 +494,7 @@ namespace transform_tree_glm {
             {
                 using std::swap;
                 swap(lhs.m_item, rhs.m_item);
+                swap(lhs.m_root, rhs.m_root);
                 swap(lhs.m_recurseChildren, rhs.m_recurseChildren);
                 swap(lhs.m_depth, rhs.m_depth);
             }
@@ -352,6 +547,8 @@ namespace transform_tree_glm {
             // RecurseIterator() : m_item(nullptr), m_recurseChildren(true) {}
         protected:
             pointer m_item = nullptr;
+            // subtree the iteration is bounded to
+            pointer m_root = nullptr;
             int m_depth = 0;
             bool m_recurseChildren = true;
         };
@@ -393,8 +590,9 @@ namespace transform_tree_glm {
         template <typename T> using const_children_data_iterator = DataMemberIterator < const_children_iterator , T>;
         template <typename T> using const_recurse_data_iterator  = DataMemberIterator < const_recurse_iterator  , T>;
 
-        // non-const & const, children & recurse, over Hierarchy, or typecasted as T, or over data member typecasted as T
-                              inline iterator                        begin()                   const { return iterator(m_begin);                        }
+        // non-const & const, children & recurse, over Hierarchy, or typecasted as T, or over data member typecasted as T.
+        // begin() and cbegin() iterate all descendants, from the first child until the subtree of this is exhausted.
+                              inline iterator                        begin()                   const { return iterator(m_begin, const_cast<pointer>(this)); }
                               inline iterator                        end()                     const { return iterator(m_end);                          }
      
                               inline children_iterator               begin_children()                { return children_iterator(m_begin);               }
@@ -415,7 +613,7 @@ namespace transform_tree_glm {
         template <typename T> inline recurse_data_iterator<T>        begin_recurse_data()            { return recurse_data_iterator<T>(this);           }
         template <typename T> inline recurse_data_iterator<T>        end_recurse_data()              { return recurse_data_iterator<T>(m_end);          }
      
-                              inline const_iterator                  cbegin()                  const { return const_iterator(m_begin);                  }
+                              inline const_iterator                  cbegin()                  const { return const_iterator(m_begin, this);            }
                               inline const_iterator                  cend()                    const { return const_iterator(m_end);                    }
       
                               inline const_children_iterator         cbegin_children()         const { return const_children_iterator(m_begin);         }
@@ -460,8 +658,8 @@ namespace transform_tree_glm {
         template <typename T> children_as_iterable<T>         inline children_as()               { return make_iterable(begin_children_as<T>(), end_children_as<T>());              }
         template <typename T> children_as_iterable<T>         inline recurse_as()                { return make_iterable(begin_recurse_as<T>(), end_recurse_as<T>());                }
         
-        template <typename T> children_data_iterable<T>       inline children_data()             { return make_iterable(begin_children_as<T>(), end_children_as<T>());              }
-        template <typename T> recurse_data_iterable<T>        inline recurse_data()              { return make_iterable(begin_recurse_data_as<T>(), end_recurse_data_as<T>());      }
+        template <typename T> children_data_iterable<T>       inline children_data()             { return make_iterable(begin_children_data<T>(), end_children_data<T>());          }
+        template <typename T> recurse_data_iterable<T>        inline recurse_data()              { return make_iterable(begin_recurse_data<T>(), end_recurse_data<T>());            }
 
                               const_children_iterable         inline const_children()      const { return make_iterable(cbegin_children(), cend_children());                        }
                               const_recurse_iterable          inline const_recurse()       const { return make_iterable(cbegin_recurse(), cend_recurse());                          }
@@ -475,52 +673,66 @@ namespace transform_tree_glm {
 
         #pragma region visitor
 
+        // Handle passed to visitor callbacks, independent of the callback type.
+        // Controls the visitor which invoked the callback.
+        template <typename iterator_t>
+        struct Visit
+        {
+            enum class Control { Children, SkipChildren, All };
+            using control_function = void (*)(void* visitor, Control control);
+
+            Visit(void* visitor, control_function control, iterator_t item, int depth, int index)
+                : item(item), depth(depth), index(index), m_visitor(visitor), m_control(control)
+            {}
+
+            iterator_t item;
+            int depth;
+            int index;
+
+            inline void children()
+            {
+                m_control(m_visitor, Control::Children);
+            }
+            inline void skipChildren()
+            {
+                m_control(m_visitor, Control::SkipChildren);
+            }
+            inline void all()
+            {
+                m_control(m_visitor, Control::All);
+            }
+
+        protected:
+            void* m_visitor;
+            control_function m_control;
+        };
+
+        // Visitor calling cb directly, so it can be inlined.
+        // The stack of iterators lives inline for trees up to stack_size levels deep.
         template 
         <
             typename iterator_t = Hierarchy::recurse_iterator,
-            typename argument_t = typename iterator_t::pointer
+            typename argument_t = typename iterator_t::pointer,
+            typename callback_t = const std::function<void(Visit<iterator_t>& visit, argument_t arg)>,
+            size_t stack_size = 32
         >
-        class Visitor
+        class BasicVisitor
         {
         public:
             using iterator = iterator_t;
             using argument_type = argument_t;
-            // using pointer = typename std::conditional_t< IsConst, Hierarchy::const_pointer, Hierarchy::pointer >;
-            // using iterator = typename std::conditional_t< IsConst, Hierarchy::const_recurse_iterator, Hierarchy::recurse_iterator >;
+            using Visit = Hierarchy::Visit<iterator_t>;
+            using CallbackType = std::remove_const_t<callback_t>;
 
-            struct Visit
-            {
-                Visit(Visitor& visitor, iterator item, int depth, int index)
-                    : visitor(visitor), item(item), depth(depth), index(index)
-                {}
-
-                Visitor& visitor;
-                iterator item;
-                int depth;
-                int index;
-
-
-                inline void children()
-                {
-                    visitor.children();
-                }
-                inline void skipChildren()
-                {
-                    visitor.skipChildren();
-                }
-                inline void all()
-                {
-                    visitor.all();
-                }
-            };
-
-            using CallbackType = std::function<void(Visit& visit, argument_type arg)>;
-            Visitor(const CallbackType& cb, iterator begin)
+            BasicVisitor(callback_t& cb, iterator begin)
                 : cb(cb), begin(begin)
             {
                 reset();
             }
 
+            BasicVisitor(const BasicVisitor&) = delete;
+            BasicVisitor& operator=(const BasicVisitor&) = delete;
+
             inline bool finished() const { return stack.empty(); }
 
             inline void reset()
@@ -532,7 +744,6 @@ namespace transform_tree_glm {
             inline void all()
             // iterate until all items are visited
             {
-                auto end = iterator(nullptr);
                 while (stack.size())
                 {
                     next();
@@ -581,44 +792,49 @@ namespace transform_tree_glm {
             inline void next()
             {
                 if(stack.empty()) return;
-                //while(stack.size())
-                //{
-                    if(!stack.back().invoked)
-                    {
-                        invoke(stack.back());
-                        return;
-                    }
-                    advance();
-
-                //}
+                if(!stack.back().invoked)
+                {
+                    invoke(stack.back());
+                    return;
+                }
+                advance();
             }
 
         protected:
-
-
-            const CallbackType& cb;
+            callback_t& cb;
             iterator begin;
             const iterator end = iterator(nullptr);
 
             struct StackItem
             {
-                iterator it;
-                int depth;
-                int index;
-                bool invoked;
+                iterator it = iterator(nullptr);
+                int depth = 0;
+                int index = 0;
+                bool invoked = false;
                 StackItem() = default;
                 StackItem(iterator it, int depth, int index, bool invoked)
                     : it(it), depth(depth), index(index), invoked(invoked)
                 {}
             };
             
-            std::vector<StackItem> stack;
+            SmallStack<StackItem, stack_size> stack;
+
+            static void control(void* visitor, typename Visit::Control control)
+            {
+                BasicVisitor& self = *static_cast<BasicVisitor*>(visitor);
+                switch (control)
+                {
+                case Visit::Control::Children:     self.children();     break;
+                case Visit::Control::SkipChildren: self.skipChildren(); break;
+                case Visit::Control::All:          self.all();          break;
+                }
+            }
 
             inline void invoke(StackItem& item)
             {
                 item.invoked = true;
-                Visit visit(*this, item.it, item.depth, item.index);
-                cb(visit, item.it);
+                Visit visit(this, &BasicVisitor::control, item.it, item.depth, item.index);
+                cb(visit, static_cast<argument_type>(item.it));
             }
             inline void advance()
             {
@@ -627,6 +843,7 @@ namespace transform_tree_glm {
                 if (it == end) return;
                 int old_depth = it.depth();
                 assert(depth == old_depth);
+                (void)depth;
 
                 // actually advance iterator
                 ++it;
@@ -654,19 +871,32 @@ namespace transform_tree_glm {
             }
         };
 
+        // visitor with type erased callback
+        template 
+        <
+            typename iterator_t = Hierarchy::recurse_iterator,
+            typename argument_t = typename iterator_t::pointer
+        >
+        using Visitor = BasicVisitor<iterator_t, argument_t>;
+
+        // cb is called as cb(Visit<iterator>& visit, argument_type arg) for each node of the subtree.
+        // any callable works, lambdas are inlined instead of being called through std::function.
         template <    
             typename iterator = Hierarchy::recurse_iterator,
-            typename argument_type = typename iterator::pointer
+            typename argument_type = typename iterator::pointer,
+            typename F
         >
-        inline void visit(const typename Visitor<iterator, argument_type>::CallbackType& cb)
+        inline void visit(F&& cb)
         {
-            Visitor<iterator, argument_type> visitor(cb, this);
+            BasicVisitor<iterator, argument_type, std::remove_reference_t<F>> visitor(cb, this);
             visitor.all();
         }
 
         #pragma endregion
 
         #pragma region mutators
+        // Moving a subtree costs O(depth) to update revisions and subtree sizes of the old and new ancestors,
+        // plus O(size of the moved subtree) to rewrite its cached depth and root, unless neither changes.
         inline iterator insert(iterator pos, pointer item)
         {
             return iterator(insert(static_cast<pointer>(pos), item));
@@ -714,9 +944,9 @@ namespace transform_tree_glm {
             //     pos->m_parent->insert(pos, item);
             // pointer insert_pos = const_cast<pointer>(pos);
             if (item == pos) return item;
-            if (item->m_parent && item->m_parent != this)
+            if (item->m_parent)
             {
-                item->m_parent->erase(item);
+                item->m_parent->unlink(item);
             }
             if (m_begin == nullptr)
             {
@@ -731,7 +961,6 @@ namespace transform_tree_glm {
             else if (pos == m_begin)
             {
                 // push_front
-                push_front(item);
                 item->m_parent = this;
                 item->m_prev = nullptr;
                 item->m_next = m_begin;
@@ -753,12 +982,16 @@ namespace transform_tree_glm {
                 assert(pos != nullptr); // this would push_back
                 assert(pos->m_prev != nullptr); // this would be push_front
                 // insert before pos
+                item->m_parent = this;
                 pos->m_prev->m_next = item;
                 item->m_prev = pos->m_prev;
                 item->m_next = pos;
                 pos->m_prev = item;
             }
             ++m_countChildren;
+            item->setDepthAndRoot(m_depth + 1, m_root);
+            if (m_enter) m_enter->list->insertSubtree(item);
+            touch(item->m_subtreeSize);
             return item;
         }
 
@@ -790,13 +1023,13 @@ namespace transform_tree_glm {
         inline void push_front_into(pointer parent)
         {
             if (parent) parent->push_front(this);
-            else erase(); 
+            else unlink();
         }
 
         inline void push_back_into(pointer parent)
         {
             if (parent) parent->push_back(this);
-            else erase(); 
+            else unlink();
         }
 
         inline void push_front(pointer item)
@@ -809,14 +1042,25 @@ namespace transform_tree_glm {
             insert(m_end, item);
         }
 
+        // The children become roots. O(size of this subtree), as depth and root are rewritten in each of them,
+        // so destroying a deep tree node by node from the top is O(n * depth). release() tears down without it.
         inline void clear()
         {
-            for (auto& item : children())
+            pointer item = m_begin;
+            while (item != nullptr)
             {
-                item.m_parent = nullptr;
+                pointer next_item = item->m_next;
+                if (m_enter && item->m_enter) m_enter->list->removeSubtree(item);
+                item->m_parent = nullptr;
+                item->m_prev = nullptr;
+                item->m_next = nullptr;
+                item->setDepthAndRoot(0, item);
+                item = next_item;
             }
             m_begin = nullptr;
             m_last = nullptr;
+            m_countChildren = 0;
+            touch(1 - static_cast<difference_type>(m_subtreeSize));
         }
 
         inline pointer erase_from_parent()
@@ -829,15 +1073,34 @@ namespace transform_tree_glm {
             return m_parent ? m_parent->erase(this) : nullptr;
         }
 
+        // returns the item following item in recursion order
         inline pointer erase(pointer item)
         {
             if ((item == nullptr) || (item->m_parent == nullptr)) return m_begin;
             // assert(item->m_parent == this);
             if (item->m_parent != this)
-                item->m_parent->erase(item);
+                return item->m_parent->erase(item);
             
-            pointer next_item = static_cast<pointer>(++recurse_iterator(item));
+            pointer next_item = static_cast<pointer>(++recurse_iterator(item, nullptr));
+            unlink(item);
+            return next_item;
+        }
+
+        // detach from parent, like erase() but without computing the next item
+        inline void unlink()
+        {
+            if (m_parent) m_parent->unlink(this);
+        }
 
+        inline void unlink(pointer item)
+        {
+            if ((item == nullptr) || (item->m_parent == nullptr)) return;
+            if (item->m_parent != this)
+            {
+                item->m_parent->unlink(item);
+                return;
+            }
+            if (m_enter && item->m_enter) m_enter->list->removeSubtree(item);
             if (item->m_prev != nullptr)
             {
                 item->m_prev->m_next = item->m_next;
@@ -858,21 +1121,277 @@ namespace transform_tree_glm {
             item->m_prev = nullptr;
             item->m_next = nullptr;
             --m_countChildren;
-            return next_item;
+            item->setDepthAndRoot(0, item);
+            touch(-static_cast<difference_type>(item->m_subtreeSize));
+        }
+
+        // Moves the children [first, last) of other before pos, like std::list::splice.
+        // Only the parent links of the moved children are relinked and the child counts adjusted.
+        // Depth and root are rewritten in the moved subtrees when this differs from other in depth or root,
+        // O(number of moved nodes), otherwise O(number of moved children).
+        // last == nullptr moves all children of other starting at first.
+        inline void splice(pointer pos, pointer other, pointer first, pointer last = nullptr)
+        {
+            assert((pos == nullptr) || (pos->m_parent == this));
+            if ((first == last) || (first == pos)) return;
+            assert((first != nullptr) && (first->m_parent == other));
+            pointer back = first;
+            size_type count = 1;
+            while (back->m_next != last)
+            {
+                assert(back->m_next != nullptr); // last is not a sibling after first
+                back = back->m_next;
+                ++count;
+            }
+            splice(pos, other, first, back, count);
+        }
+
+        // moves all children of other before pos
+        inline void splice(pointer pos, pointer other)
+        {
+            if ((other == this) || other->empty()) return;
+            splice(pos, other, other->m_begin, other->m_last, other->m_countChildren);
+        }
+
+        inline void splice(iterator pos, pointer other, pointer first, pointer last = nullptr)
+        {
+            splice(static_cast<pointer>(pos), other, first, last);
+        }
+        inline void splice(children_iterator pos, pointer other, pointer first, pointer last = nullptr)
+        {
+            splice(static_cast<pointer>(pos), other, first, last);
+        }
+
+        // Moves the count children [first, back] of other before pos.
+        // back and count must match, as they are not checked.
+        inline void splice(pointer pos, pointer other, pointer first, pointer back, size_type count)
+        {
+            assert((pos == nullptr) || (pos->m_parent == this));
+            // the tours of moved subtrees are rebuilt at their new position
+            if (other->m_enter)
+            {
+                for (pointer item = first; item != back->m_next; item = item->m_next)
+                    if (item->m_enter) other->m_enter->list->removeSubtree(item);
+            }
+            // unlink range from other
+            if (first->m_prev) first->m_prev->m_next = back->m_next;
+            else other->m_begin = back->m_next;
+            if (back->m_next) back->m_next->m_prev = first->m_prev;
+            else other->m_last = first->m_prev;
+            other->m_countChildren -= count;
+            // link range before pos
+            pointer prev = pos ? pos->m_prev : m_last;
+            first->m_prev = prev;
+            back->m_next = pos;
+            if (prev) prev->m_next = first;
+            else m_begin = first;
+            if (pos) pos->m_prev = back;
+            else m_last = back;
+            m_countChildren += count;
+            if (other != this)
+            {
+                difference_type moved = 0;
+                bool relocated = (m_depth != other->m_depth) || (m_root != other->m_root);
+                for (pointer item = first; item != pos; item = item->m_next)
+                {
+                    item->m_parent = this;
+                    moved += item->m_subtreeSize;
+                    if (relocated) item->setDepthAndRoot(m_depth + 1, m_root);
+                }
+                other->touch(-moved);
+                touch(moved);
+            }
+            else
+            {
+                touch();
+            }
+            if (m_enter)
+            {
+                // back to front, so the following sibling of each item already has its tags
+                for (pointer item = back; ; item = item->m_prev)
+                {
+                    m_enter->list->insertSubtree(item);
+                    if (item == first) break;
+                }
+            }
+        }
+
+        // Forgets all links without updating parent, siblings or children.
+        // Only valid when every node linked to this gets released or destroyed as well,
+        // e.g. when a whole subtree is torn down at once. Destruction is O(1) afterwards.
+        inline void release()
+        {
+            if (m_enter) m_enter->list->removeTags(this);
+            m_parent = nullptr;
+            m_begin = nullptr;
+            m_last = nullptr;
+            m_countChildren = 0;
+            m_prev = nullptr;
+            m_next = nullptr;
+            m_depth = 0;
+            m_root = this;
+            m_subtreeSize = 1;
         }
 
         inline void pop_front()
         {
-            erase(m_begin);
+            unlink(m_begin);
         }
 
         inline void pop_back()
         {
-            erase(m_last);
+            unlink(m_last);
         }
         #pragma endregion
+
+    protected:
+        // Revisions are drawn from one counter shared by all nodes, so a revision is never reused,
+        // not even by another node at the same address. Views caching ranges of a subtree rely on that.
+        static inline size_type nextRevision()
+        {
+            static std::atomic<size_type> counter(0);
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        // give this node and all its ancestors a new revision and grow their subtree sizes by sizeDelta.
+        // called on the node whose children changed, so only this one gets a new children revision.
+        inline void touch(difference_type sizeDelta = 0)
+        {
+            size_type revision = nextRevision();
+            m_childrenRevision = revision;
+            for (pointer node = this; node != nullptr; node = node->m_parent)
+            {
+                node->m_revision = revision;
+                node->m_subtreeSize += sizeDelta;
+            }
+        }
+
+        // sets depth and root of all nodes in this subtree, this gets depth. O(size of the subtree)
+        inline void setDepthAndRoot(size_type depth, pointer root)
+        {
+            if ((m_depth == depth) && (m_root == root)) return;
+            auto end = end_recurse();
+            for (auto it = begin_recurse(); it != end; ++it)
+            {
+                pointer node = static_cast<pointer>(it);
+                node->m_depth = depth + it.depth();
+                node->m_root = root;
+            }
+        }
     };
 
+
+    #pragma region OrderList
+    inline void OrderList::attach(Hierarchy* root)
+    {
+        // the parent of root must not be ordered, its tour would miss the subtree of root
+        assert((root == nullptr) || (root->m_parent == nullptr) || !root->m_parent->isOrdered());
+        detach();
+        if (root == nullptr) return;
+        if (root->m_enter) root->m_enter->list->removeSubtree(root);
+        m_root = root;
+        label_type count = emit(root, &m_tail);
+        relabel(&m_head, &m_tail, count);
+    }
+
+    inline void OrderList::detach()
+    {
+        for (Tag* tag = m_head.next; tag != &m_tail; tag = tag->next)
+        {
+            if (tag->exit) tag->node->m_exit = nullptr;
+            else tag->node->m_enter = nullptr;
+        }
+        m_head.next = &m_tail;
+        m_tail.prev = &m_head;
+        m_storage.clear();
+        m_free = nullptr;
+        m_numTags = 0;
+        m_root = nullptr;
+    }
+
+    template <typename F>
+    inline void OrderList::forEach(F&& f) const
+    {
+        for (const Tag* tag = m_head.next; tag != &m_tail; tag = tag->next)
+            if (!tag->exit) f(tag->node);
+    }
+
+    template <typename F>
+    inline void OrderList::forEachDescendant(const Hierarchy* node, F&& f) const
+    {
+        if ((node->m_enter == nullptr) || (node->m_enter->list != this)) return;
+        for (const Tag* tag = node->m_enter->next; tag != node->m_exit; tag = tag->next)
+            if (!tag->exit) f(tag->node);
+    }
+
+    inline OrderList::label_type OrderList::emit(Hierarchy* item, Tag* next)
+    {
+        label_type count = 0;
+        m_stack.clear();
+        auto end = item->end_recurse();
+        for (auto it = item->begin_recurse(); it != end; ++it)
+        {
+            // close the subtrees the iterator climbed out of
+            while (m_stack.size() > size_t(it.depth()))
+            {
+                Hierarchy* node = m_stack.back();
+                m_stack.pop_back();
+                node->m_exit = allocate(node, true);
+                linkBefore(next, node->m_exit);
+                ++count;
+            }
+            Hierarchy* node = static_cast<Hierarchy*>(it);
+            // the root of another tour nested below an unordered node leaves that tour
+            if (node->m_enter) node->m_enter->list->removeSubtree(node);
+            node->m_enter = allocate(node, false);
+            linkBefore(next, node->m_enter);
+            ++count;
+            m_stack.push_back(node);
+        }
+        while (!m_stack.empty())
+        {
+            Hierarchy* node = m_stack.back();
+            m_stack.pop_back();
+            node->m_exit = allocate(node, true);
+            linkBefore(next, node->m_exit);
+            ++count;
+        }
+        return count;
+    }
+
+    inline void OrderList::insertSubtree(Hierarchy* item)
+    {
+        if (item->m_enter) item->m_enter->list->removeSubtree(item);
+        Tag* next = item->m_next ? item->m_next->m_enter : item->m_parent->m_exit;
+        Tag* left = next->prev;
+        label_type count = emit(item, next);
+        relabel(left, next, count);
+    }
+
+    inline void OrderList::removeSubtree(Hierarchy* item)
+    {
+        Tag* end = item->m_exit->next;
+        for (Tag* tag = item->m_enter; tag != end;)
+        {
+            Tag* next = tag->next;
+            if (tag->exit) tag->node->m_exit = nullptr;
+            else tag->node->m_enter = nullptr;
+            deallocate(tag);
+            tag = next;
+        }
+        if (item == m_root) m_root = nullptr;
+    }
+
+    inline void OrderList::removeTags(Hierarchy* item)
+    {
+        deallocate(item->m_enter);
+        deallocate(item->m_exit);
+        item->m_enter = nullptr;
+        item->m_exit = nullptr;
+        if (item == m_root) m_root = nullptr;
+    }
+    #pragma endregion
+
 // further information:
 // https://stackoverflow.com/questions/8054273/how-to-implement-an-stl-style-iterator-and-avoid-common-pitfalls
 // https://stackoverflow.com/questions/3582608/how-to-correctly-implement-custom-iterators-and-const-iterators
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace transform_tree_glm {
+
+    // Bounded history of timestamped local transformation parameters of a pose_t.
+    // Samples are kept in a ring buffer with fixed capacity, allocated up front, so
+    // inserting never allocates. When full, the oldest sample is overwritten.
+    // Timestamps must not decrease, lookups interpolate between the enclosing samples.
+    template <typename pose_t>
+    class PoseHistory_
+    {
+    public:
+        using pose_type = pose_t;
+        using scalar_type = typename pose_type::scalar_type;
+        using vec3_type = typename pose_type::vec3_type;
+        using quat_type = typename pose_type::quat_type;
+        using time_type = double;
+        using size_type = size_t;
+
+        struct Sample
+        {
+            time_type time;
+            vec3_type position;
+            quat_type rotation;
+            vec3_type scale;
+        };
+
+        PoseHistory_(size_type capacity = 0)
+            : m_samples(capacity)
+        {}
+
+        #pragma region attributes
+        inline size_type capacity() const { return m_samples.size(); }
+        inline size_type size()     const { return m_size; }
+        inline bool      empty()    const { return m_size == 0; }
+
+        inline time_type oldestTime() const { return at(0).time; }
+        inline time_type newestTime() const { return at(m_size - 1).time; }
+
+        // i-th sample counted from the oldest
+        inline const Sample& operator[](size_type i) const { return at(i); }
+
+        inline void clear()
+        {
+            m_begin = 0;
+            m_size = 0;
+        }
+
+        // reallocates, keeps the newest samples that fit into capacity
+        inline void setCapacity(size_type capacity)
+        {
+            std::vector<Sample> samples(capacity);
+            size_type count = (m_size < capacity) ? m_size : capacity;
+            for (size_type i = 0; i < count; ++i)
+                samples[i] = at(m_size - count + i);
+            m_samples.swap(samples);
+            m_begin = 0;
+            m_size = count;
+        }
+        #pragma endregion
+
+        #pragma region insert and lookup
+        // O(1), returns false if time is older than the newest sample or there is no capacity.
+        // a sample with the same time as the newest replaces it.
+        inline bool insert(time_type time, const vec3_type& position, const quat_type& rotation, const vec3_type& scale)
+        {
+            if (m_samples.empty()) return false;
+            if (!empty() && (time < newestTime())) return false;
+            if (!empty() && (time == newestTime()))
+            {
+                at(m_size - 1) = Sample{time, position, rotation, scale};
+                return true;
+            }
+            if (m_size < m_samples.size())
+            {
+                ++m_size;
+            }
+            else
+            {
+                m_begin = (m_begin + 1) % m_samples.size();
+            }
+            at(m_size - 1) = Sample{time, position, rotation, scale};
+            return true;
+        }
+
+        inline bool insert(time_type time, const pose_type& pose)
+        {
+            return insert(time, pose.accessConstLocalPosition(), pose.accessConstLocalRotation(), pose.accessConstLocalScale());
+        }
+
+        // O(log n), linear interpolation of position and scale, slerp of rotation.
+        // returns false if time is outside of the stored time span.
+        inline bool lookup(time_type time, vec3_type& position, quat_type& rotation, vec3_type& scale) const
+        {
+            if (empty() || (time < oldestTime()) || (time > newestTime())) return false;
+            size_type i = upperBound(time);
+            if (i == m_size)
+            {
+                // time is exactly the newest sample
+                const Sample& newest = at(m_size - 1);
+                position = newest.position;
+                rotation = newest.rotation;
+                scale = newest.scale;
+                return true;
+            }
+            const Sample& a = at(i - 1);
+            const Sample& b = at(i);
+            scalar_type t = static_cast<scalar_type>((time - a.time) / (b.time - a.time));
+            position = glm::mix(a.position, b.position, t);
+            rotation = glm::slerp(a.rotation, b.rotation, t);
+            scale = glm::mix(a.scale, b.scale, t);
+            return true;
+        }
+        #pragma endregion
+
+    protected:
+        inline const Sample& at(size_type i) const { return m_samples[(m_begin + i) % m_samples.size()]; }
+        inline Sample&       at(size_type i)       { return m_samples[(m_begin + i) % m_samples.size()]; }
+
+        // index of the first sample newer than time
+        inline size_type upperBound(time_type time) const
+        {
+            size_type first = 0;
+            size_type count = m_size;
+            while (count > 0)
+            {
+                size_type step = count / 2;
+                if (at(first + step).time <= time)
+                {
+                    first += step + 1;
+                    count -= step + 1;
+                }
+                else
+                {
+                    count = step;
+                }
+            }
+            return first;
+        }
+
+        std::vector<Sample> m_samples;
+        size_type m_begin = 0;
+        size_type m_size = 0;
+    };
+
+} // namespace transform_tree_glm
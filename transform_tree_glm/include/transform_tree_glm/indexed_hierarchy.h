@@ -0,0 +1,600 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>  // For std::ptrdiff_t
+#include <cstdint>
+#include <initializer_list>
+#include <iterator> // For std::forward_iterator_tag
+#include <type_traits>
+#include <vector>
+
+#include "transform_tree_glm/iterable.h"
+#include "transform_tree_glm/hierarchy.h"
+
+namespace transform_tree_glm {
+
+    // Tree container storing the links of all nodes as indices into one node table.
+    // A node costs its 6 link indices, its data pointer and its revision: 40 bytes with 32 bit and
+    // 28 bytes with 16 bit indices on 64 bit platforms, against 112 bytes for a Hierarchy.
+    // The link table can be relocated or serialized as is. Nodes are addressed by index, node_none takes the role of nullptr.
+    // Attributes, mutators, iterators and visitors follow Hierarchy, but take the node index as first argument.
+    //
+    // Scope: this is not a backend Transform_ can be linked by. Each Transform_ embeds a Hierarchy and is
+    // addressed by pointer, and Transform_ relies on the cached depth, root and subtree size and on the
+    // OrderList of Hierarchy. A per-node handle into a shared table would need a table pointer next to each
+    // index, which gives back the memory the indices save. Instead, Transform_ trees are brought into and
+    // out of the compact table with copyTopology() and linkTopology(), using the idx_type of Transform_.
+    template <typename idx_t = uint32_t>
+    class IndexedHierarchy_
+    {
+    public:
+        using index_type = idx_t;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+
+        static constexpr index_type node_none = index_type(-1);
+
+        struct Node
+        {
+            index_type parent = node_none;
+            // children
+            index_type begin = node_none;
+            index_type last = node_none;
+            index_type countChildren = 0;
+            // in parent, next also links the free list
+            index_type prev = node_none;
+            index_type next = node_none;
+        };
+        static_assert(sizeof(Node) == 6 * sizeof(index_type), "Node holds the links only");
+
+    protected:
+        std::vector<Node> m_nodes;
+        std::vector<void*> m_data;
+        // incremented whenever the topology of the subtree of a node changes
+        std::vector<size_type> m_revisions;
+        index_type m_free = node_none;
+        size_type m_numNodes = 0;
+
+    public:
+        #pragma region node table
+        // number of live nodes
+        inline size_type numNodes() const { return m_numNodes; }
+        inline size_type capacity() const { return m_nodes.size(); }
+        inline void reserve(size_type count)
+        {
+            m_nodes.reserve(count);
+            m_data.reserve(count);
+            m_revisions.reserve(count);
+        }
+
+        // raw node table, e.g. for serialization
+        inline const std::vector<Node>& nodes() const { return m_nodes; }
+
+        inline index_type create(void* data = nullptr)
+        {
+            index_type item;
+            if (m_free != node_none)
+            {
+                item = m_free;
+                m_free = m_nodes[item].next;
+                m_nodes[item] = Node();
+                m_data[item] = data;
+            }
+            else
+            {
+                assert(m_nodes.size() < size_type(node_none)); // index type exhausted
+                item = static_cast<index_type>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_data.push_back(data);
+                m_revisions.push_back(0);
+            }
+            ++m_numNodes;
+            return item;
+        }
+
+        // like destroying a Hierarchy: item is erased from its parent and its children are detached
+        inline void destroy(index_type item)
+        {
+            erase_from_parent(item);
+            clear(item);
+            m_data[item] = nullptr;
+            m_nodes[item].next = m_free;
+            m_free = item;
+            --m_numNodes;
+        }
+
+        inline void*& data(index_type item)       { return m_data[item]; }
+        inline void*  data(index_type item) const { return m_data[item]; }
+        #pragma endregion
+
+        #pragma region transform trees
+        // Replaces the table with the topology of the subtree of root, e.g. a Transform_ or a Hierarchy.
+        // Node k is the k-th node in parent-before-child order and has the pointer to it as data,
+        // so root is node 0. O(size of the subtree), revisions start at 0.
+        template <typename node_t>
+        inline void copyTopology(node_t* root)
+        {
+            m_nodes.clear();
+            m_data.clear();
+            m_revisions.clear();
+            m_free = node_none;
+            m_numNodes = 0;
+            std::vector<index_type> lastAtDepth;
+            auto end = root->end_recurse();
+            for (auto it = root->begin_recurse(); it != end; ++it)
+            {
+                size_type depth = static_cast<size_type>(it.depth());
+                index_type item = create(static_cast<node_t*>(it));
+                if (lastAtDepth.size() <= depth) lastAtDepth.resize(depth + 1);
+                lastAtDepth[depth] = item;
+                if (depth == 0) continue;
+                // append to the children of the parent, the last node one level up
+                index_type parent = lastAtDepth[depth - 1];
+                Node& p = m_nodes[parent];
+                Node& n = m_nodes[item];
+                n.parent = parent;
+                n.prev = p.last;
+                if (p.last != node_none) m_nodes[p.last].next = item;
+                else p.begin = item;
+                p.last = item;
+                ++p.countChildren;
+            }
+        }
+
+        // Links the nodes in the data pointers of the subtree of root like the table, children in table order.
+        // The node of root keeps its parent. node_t is a Transform_ or any type whose setParent() appends
+        // to the children, e.g. after data() was pointed at other nodes.
+        // In parent-before-child order the ancestors of a parent are already linked like in the table,
+        // so no node is moved below its own descendant.
+        template <typename node_t>
+        inline void linkTopology(index_type root)
+        {
+            auto end = end_recurse(root);
+            for (auto it = begin_recurse(root); it != end; ++it)
+            {
+                index_type item = it;
+                if (item != root) static_cast<node_t*>(m_data[item])->setParent(static_cast<node_t*>(m_data[m_nodes[item].parent]));
+            }
+        }
+        #pragma endregion
+
+        #pragma region attributes
+        inline bool       empty(index_type item)    const { return m_nodes[item].countChildren == 0; }
+        inline size_type  size(index_type item)     const { return m_nodes[item].countChildren; }
+        inline index_type parent(index_type item)   const { return m_nodes[item].parent; }
+        inline index_type prev(index_type item)     const { return m_nodes[item].prev; }
+        inline index_type next(index_type item)     const { return m_nodes[item].next; }
+        inline index_type front(index_type item)    const { return m_nodes[item].begin; }
+        inline index_type back(index_type item)     const { return m_nodes[item].last; }
+        inline size_type  revision(index_type item) const { return m_revisions[item]; }
+        #pragma endregion
+
+        #pragma region iterator classes
+        template <bool IsConst>
+        class ChildrenIterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = index_type;
+            using pointer = const index_type*;
+            using reference = const index_type&;
+            using table_pointer = typename std::conditional_t< IsConst, const IndexedHierarchy_*, IndexedHierarchy_* >;
+
+            ChildrenIterator(table_pointer table, index_type item) noexcept
+                : m_table(table), m_item(item) {}
+            // end iterator
+            ChildrenIterator(std::nullptr_t) noexcept {}
+
+            template<bool IsConst_ = IsConst, class = std::enable_if_t<IsConst_>>
+            ChildrenIterator(const ChildrenIterator<false>& other)
+                : m_table(other.m_table), m_item(other.m_item) {}
+
+            ChildrenIterator(const ChildrenIterator& other) = default;
+            ChildrenIterator& operator=(const ChildrenIterator& other) = default;
+            ChildrenIterator() = default;
+
+            inline operator index_type() const { return m_item; }
+            inline table_pointer table() const { return m_table; }
+
+            ChildrenIterator& operator++() //prefix increment
+            {
+                if (m_item != node_none)
+                {
+                    m_item = m_table->m_nodes[m_item].next;
+                }
+                return *this;
+            }
+            ChildrenIterator operator++(int) //postfix increment
+            {
+                ChildrenIterator beforeInc(*this);
+                ++(*this);
+                return beforeInc;
+            }
+            reference operator*() const { return m_item; }
+
+            friend void swap(ChildrenIterator& lhs, ChildrenIterator& rhs)
+            {
+                using std::swap;
+                swap(lhs.m_table, rhs.m_table);
+                swap(lhs.m_item, rhs.m_item);
+            }
+            friend bool operator==(const ChildrenIterator& lhs, const ChildrenIterator& rhs)
+            {
+                return lhs.m_item == rhs.m_item;
+            }
+            friend bool operator!=(const ChildrenIterator& lhs, const ChildrenIterator& rhs)
+            {
+                return lhs.m_item != rhs.m_item;
+            }
+
+        protected:
+            template <bool> friend class ChildrenIterator;
+            table_pointer m_table = nullptr;
+            index_type m_item = node_none;
+        };
+
+        // Depth first iteration over the subtree of the node it was started from.
+        template <bool IsConst>
+        class RecurseIterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = index_type;
+            using pointer = const index_type*;
+            using reference = const index_type&;
+            using table_pointer = typename std::conditional_t< IsConst, const IndexedHierarchy_*, IndexedHierarchy_* >;
+
+            RecurseIterator(table_pointer table, index_type item) noexcept
+                : m_table(table), m_item(item), m_root(item) {}
+            // end iterator
+            RecurseIterator(std::nullptr_t) noexcept {}
+
+            template<bool IsConst_ = IsConst, class = std::enable_if_t<IsConst_>>
+            RecurseIterator(const RecurseIterator<false>& other)
+                : m_table(other.m_table)
+                , m_item(other.m_item)
+                , m_root(other.m_root)
+                , m_depth(other.m_depth)
+                , m_recurseChildren(other.m_recurseChildren)
+            {}
+
+            RecurseIterator(const RecurseIterator& other) = default;
+            RecurseIterator& operator=(const RecurseIterator& other) = default;
+            RecurseIterator() = default;
+
+            inline int depth() const { return m_depth; }
+            inline void skipChildren() { m_recurseChildren = false; }
+            inline void includeChildren() { m_recurseChildren = true; }
+
+            inline operator index_type() const { return m_item; }
+            inline table_pointer table() const { return m_table; }
+
+            RecurseIterator& operator++() //prefix increment
+            {
+                if (m_item == node_none) return *this;
+                const Node& node = m_table->m_nodes[m_item];
+                if (m_recurseChildren && (node.begin != node_none))
+                {
+                    // advance to children
+                    m_item = node.begin;
+                    ++m_depth;
+                    return *this;
+                }
+                m_recurseChildren = true;
+                // advance to next sibling of this or of the closest ancestor below root
+                while (m_item != m_root)
+                {
+                    const Node& current = m_table->m_nodes[m_item];
+                    if (current.next != node_none)
+                    {
+                        m_item = current.next;
+                        return *this;
+                    }
+                    m_item = current.parent;
+                    --m_depth;
+                }
+                m_item = node_none;
+                return *this;
+            }
+            RecurseIterator operator++(int) //postfix increment
+            {
+                RecurseIterator beforeInc(*this);
+                ++(*this);
+                return beforeInc;
+            }
+            reference operator*() const { return m_item; }
+
+            friend void swap(RecurseIterator& lhs, RecurseIterator& rhs)
+            {
+                using std::swap;
+                swap(lhs.m_table, rhs.m_table);
+                swap(lhs.m_item, rhs.m_item);
+                swap(lhs.m_root, rhs.m_root);
+                swap(lhs.m_depth, rhs.m_depth);
+                swap(lhs.m_recurseChildren, rhs.m_recurseChildren);
+            }
+            friend bool operator==(const RecurseIterator& lhs, const RecurseIterator& rhs)
+            {
+                return lhs.m_item == rhs.m_item;
+            }
+            friend bool operator!=(const RecurseIterator& lhs, const RecurseIterator& rhs)
+            {
+                return !(lhs == rhs);
+            }
+
+        protected:
+            template <bool> friend class RecurseIterator;
+            table_pointer m_table = nullptr;
+            index_type m_item = node_none;
+            index_type m_root = node_none;
+            int m_depth = 0;
+            bool m_recurseChildren = true;
+        };
+
+        // iterates like Iterator, dereferences to the data pointer of each node cast to T
+        template <typename Iterator, typename T>
+        class DataIterator : public Iterator
+        {
+        public:
+            using value_type = T;
+            using pointer = typename std::conditional_t< std::is_const<std::remove_pointer_t<typename Iterator::table_pointer>>::value, const T*, T* >;
+            using reference = std::remove_pointer_t<pointer>&;
+
+            using Iterator::Iterator;
+            DataIterator(const Iterator& it) : Iterator(it) {}
+
+            inline operator pointer() const { return static_cast<pointer>(this->table()->data(static_cast<index_type>(*this))); }
+            inline reference operator*() const { return *static_cast<pointer>(*this); }
+            inline pointer operator->() const { return static_cast<pointer>(*this); }
+        };
+        #pragma endregion
+
+        #pragma region iterators
+        using children_iterator = ChildrenIterator<false>;
+        using recurse_iterator = RecurseIterator<false>;
+        using iterator = RecurseIterator<false>;
+
+        using const_children_iterator = ChildrenIterator<true>;
+        using const_recurse_iterator = RecurseIterator<true>;
+        using const_iterator = RecurseIterator<true>;
+
+        static_assert(std::is_trivially_copy_constructible_v<const_children_iterator>, "std::is_trivially_copy_constructible_v<const_children_iterator>");
+        static_assert(std::is_trivially_copy_constructible_v<const_recurse_iterator>,  "std::is_trivially_copy_constructible_v<const_recurse_iterator>");
+
+        template <typename T> using children_data_iterator       = DataIterator< children_iterator       , T>;
+        template <typename T> using recurse_data_iterator        = DataIterator< recurse_iterator        , T>;
+        template <typename T> using const_children_data_iterator = DataIterator< const_children_iterator , T>;
+        template <typename T> using const_recurse_data_iterator  = DataIterator< const_recurse_iterator  , T>;
+
+                              inline children_iterator               begin_children(index_type item)              { return children_iterator(this, m_nodes[item].begin);             }
+                              inline children_iterator               end_children(index_type)                     { return children_iterator(nullptr);                               }
+
+                              inline recurse_iterator                begin_recurse(index_type item)               { return recurse_iterator(this, item);                             }
+                              inline recurse_iterator                end_recurse(index_type)                      { return recurse_iterator(nullptr);                                }
+
+        template <typename T> inline children_data_iterator<T>       begin_children_data(index_type item)         { return children_data_iterator<T>(begin_children(item));          }
+        template <typename T> inline children_data_iterator<T>       end_children_data(index_type item)           { return children_data_iterator<T>(end_children(item));            }
+
+        template <typename T> inline recurse_data_iterator<T>        begin_recurse_data(index_type item)          { return recurse_data_iterator<T>(begin_recurse(item));            }
+        template <typename T> inline recurse_data_iterator<T>        end_recurse_data(index_type item)            { return recurse_data_iterator<T>(end_recurse(item));              }
+
+                              inline const_children_iterator         cbegin_children(index_type item)       const { return const_children_iterator(this, m_nodes[item].begin);       }
+                              inline const_children_iterator         cend_children(index_type)              const { return const_children_iterator(nullptr);                         }
+
+                              inline const_recurse_iterator          cbegin_recurse(index_type item)        const { return const_recurse_iterator(this, item);                       }
+                              inline const_recurse_iterator          cend_recurse(index_type)               const { return const_recurse_iterator(nullptr);                          }
+
+        template <typename T> inline const_children_data_iterator<T> cbegin_children_data(index_type item)  const { return const_children_data_iterator<T>(cbegin_children(item));   }
+        template <typename T> inline const_children_data_iterator<T> cend_children_data(index_type item)    const { return const_children_data_iterator<T>(cend_children(item));     }
+
+        template <typename T> inline const_recurse_data_iterator<T>  cbegin_recurse_data(index_type item)   const { return const_recurse_data_iterator<T>(cbegin_recurse(item));     }
+        template <typename T> inline const_recurse_data_iterator<T>  cend_recurse_data(index_type item)     const { return const_recurse_data_iterator<T>(cend_recurse(item));       }
+        #pragma endregion
+
+        #pragma region iterables
+                              using children_iterable            = Iterable< children_iterator               >;
+                              using recurse_iterable             = Iterable< recurse_iterator                >;
+                              using const_children_iterable      = Iterable< const_children_iterator         >;
+                              using const_recurse_iterable       = Iterable< const_recurse_iterator          >;
+
+        template <typename T> using children_data_iterable       = Iterable< children_data_iterator      <T> >;
+        template <typename T> using recurse_data_iterable        = Iterable< recurse_data_iterator       <T> >;
+        template <typename T> using const_children_data_iterable = Iterable< const_children_data_iterator<T> >;
+        template <typename T> using const_recurse_data_iterable  = Iterable< const_recurse_data_iterator <T> >;
+
+                              children_iterable               inline children(index_type item)                  { return make_iterable(begin_children(item), end_children(item));                          }
+                              recurse_iterable                inline recurse(index_type item)                   { return make_iterable(begin_recurse(item), end_recurse(item));                            }
+
+        template <typename T> children_data_iterable<T>       inline children_data(index_type item)             { return make_iterable(begin_children_data<T>(item), end_children_data<T>(item));          }
+        template <typename T> recurse_data_iterable<T>        inline recurse_data(index_type item)              { return make_iterable(begin_recurse_data<T>(item), end_recurse_data<T>(item));            }
+
+                              const_children_iterable         inline const_children(index_type item)      const { return make_iterable(cbegin_children(item), cend_children(item));                        }
+                              const_recurse_iterable          inline const_recurse(index_type item)       const { return make_iterable(cbegin_recurse(item), cend_recurse(item));                          }
+
+        template <typename T> const_children_data_iterable<T> inline const_children_data(index_type item) const { return make_iterable(cbegin_children_data<T>(item), cend_children_data<T>(item));        }
+        template <typename T> const_recurse_data_iterable<T>  inline const_recurse_data(index_type item)  const { return make_iterable(cbegin_recurse_data<T>(item), cend_recurse_data<T>(item));          }
+        #pragma endregion
+
+        #pragma region visitor
+        // same visitors as for Hierarchy, the callback receives node indices
+        template <
+            typename iterator_t = recurse_iterator,
+            typename argument_t = index_type
+        >
+        using Visitor = Hierarchy::Visitor<iterator_t, argument_t>;
+
+        template <
+            typename iterator_t = recurse_iterator,
+            typename argument_t = index_type,
+            typename F
+        >
+        inline void visit(index_type item, F&& cb)
+        {
+            Hierarchy::BasicVisitor<iterator_t, argument_t, std::remove_reference_t<F>> visitor(cb, iterator_t(this, item));
+            visitor.all();
+        }
+        #pragma endregion
+
+        #pragma region mutators
+        inline index_type insert(index_type parent, index_type pos, std::initializer_list<index_type> items)
+        {
+            for (auto& item : items)
+            {
+                insert(parent, pos, item);
+            }
+            return *(items.begin());
+        }
+
+        // insert item into children of parent before pos, pos == node_none appends
+        inline index_type insert(index_type parent, index_type pos, index_type item)
+        {
+            assert((pos == node_none) || (m_nodes[pos].parent == parent));
+            if (item == pos) return item;
+            if (m_nodes[item].parent != node_none)
+            {
+                erase(item);
+            }
+            Node& p = m_nodes[parent];
+            Node& n = m_nodes[item];
+            n.parent = parent;
+            if (p.begin == node_none)
+            {
+                assert(p.countChildren == 0);
+                p.begin = item;
+                p.last = item;
+                n.prev = node_none;
+                n.next = node_none;
+            }
+            else if (pos == p.begin)
+            {
+                n.prev = node_none;
+                n.next = p.begin;
+                m_nodes[p.begin].prev = item;
+                p.begin = item;
+            }
+            else if (pos == node_none)
+            {
+                n.next = node_none;
+                n.prev = p.last;
+                m_nodes[p.last].next = item;
+                p.last = item;
+            }
+            else
+            {
+                // insert before pos
+                Node& at = m_nodes[pos];
+                m_nodes[at.prev].next = item;
+                n.prev = at.prev;
+                n.next = pos;
+                at.prev = item;
+            }
+            ++p.countChildren;
+            touch(parent);
+            return item;
+        }
+
+        // Replaces the children of parent.
+        inline void assign(index_type parent, std::initializer_list<index_type> items)
+        {
+            clear(parent);
+            insert(parent, node_none, items);
+        }
+
+        inline void push_front_into(index_type item, index_type parent)
+        {
+            if (parent != node_none) push_front(parent, item);
+            else erase(item);
+        }
+
+        inline void push_back_into(index_type item, index_type parent)
+        {
+            if (parent != node_none) push_back(parent, item);
+            else erase(item);
+        }
+
+        inline void push_front(index_type parent, index_type item)
+        {
+            insert(parent, m_nodes[parent].begin, item);
+        }
+
+        inline void push_back(index_type parent, index_type item)
+        {
+            insert(parent, node_none, item);
+        }
+
+        // detach all children of parent
+        inline void clear(index_type parent)
+        {
+            Node& p = m_nodes[parent];
+            index_type item = p.begin;
+            while (item != node_none)
+            {
+                Node& n = m_nodes[item];
+                index_type next_item = n.next;
+                n.parent = node_none;
+                n.prev = node_none;
+                n.next = node_none;
+                item = next_item;
+            }
+            p.begin = node_none;
+            p.last = node_none;
+            p.countChildren = 0;
+            touch(parent);
+        }
+
+        inline index_type erase_from_parent(index_type item)
+        {
+            return erase(item);
+        }
+
+        // detach item from its parent, returns the next sibling of item
+        inline index_type erase(index_type item)
+        {
+            Node& n = m_nodes[item];
+            index_type parent = n.parent;
+            if (parent == node_none) return node_none;
+            Node& p = m_nodes[parent];
+            index_type next_item = n.next;
+            if (n.prev != node_none) m_nodes[n.prev].next = n.next;
+            if (n.next != node_none) m_nodes[n.next].prev = n.prev;
+            if (p.begin == item) p.begin = n.next;
+            if (p.last == item) p.last = n.prev;
+            n.parent = node_none;
+            n.prev = node_none;
+            n.next = node_none;
+            --p.countChildren;
+            touch(parent);
+            return next_item;
+        }
+
+        inline void pop_front(index_type parent)
+        {
+            if (m_nodes[parent].begin != node_none) erase(m_nodes[parent].begin);
+        }
+
+        inline void pop_back(index_type parent)
+        {
+            if (m_nodes[parent].last != node_none) erase(m_nodes[parent].last);
+        }
+
+        // forgets all links of item without updating its neighbours, see Hierarchy::release
+        inline void release(index_type item)
+        {
+            m_nodes[item] = Node();
+        }
+        #pragma endregion
+
+    protected:
+        // bump revision of item and all its ancestors
+        inline void touch(index_type item)
+        {
+            for (; item != node_none; item = m_nodes[item].parent)
+                ++m_revisions[item];
+        }
+    };
+    typedef IndexedHierarchy_<uint32_t> IndexedHierarchy;
+    typedef IndexedHierarchy_<uint16_t> IndexedHierarchy16;
+
+} // namespace transform_tree_glm
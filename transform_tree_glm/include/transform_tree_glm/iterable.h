@@ -32,10 +32,10 @@ namespace transform_tree_glm {
         // Iterator must provide conversion operator to convert to Iterator::pointer
         // this way we can also support nullptr
         template<bool _IsConst = IsConst, class = std::enable_if_t<!_IsConst>>
-        operator pointer() { return static_cast<pointer>(static_cast<Iterator::pointer>(*this)); }
+        operator pointer() { return static_cast<pointer>(static_cast<typename Iterator::pointer>(*this)); }
 
         template<bool _IsConst = IsConst, class = std::enable_if_t<_IsConst>>
-        operator pointer() const { return static_cast<pointer>(static_cast<Iterator::pointer>(*this)); }
+        operator pointer() const { return static_cast<pointer>(static_cast<typename Iterator::pointer>(*this)); }
 
         template<bool _IsConst = IsConst, class = std::enable_if_t<!_IsConst>>
         reference operator*()
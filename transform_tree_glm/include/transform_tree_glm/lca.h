@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "transform_tree_glm/transform.h"
+
+namespace transform_tree_glm {
+
+    // Lowest common ancestor index of a Transform_ subtree.
+    // Nodes are numbered in pre-order. For two nodes u before v the lowest common ancestor is
+    // the parent of the shallowest node in the pre-order range (u, v], which a sparse table
+    // answers in O(1) after an O(n log n) rebuild.
+    // Like FlatTree_ the index goes stale when the revision of the subtree changes.
+    // update() rebuilds it then and increments generation(), so callers caching
+    // query results can tell when they are outdated.
+    template <typename transform_t>
+    class LcaIndex_
+    {
+    public:
+        using transform_type = transform_t;
+        using pointer = transform_t*;
+        using const_pointer = const transform_t*;
+        using index_type = typename transform_t::idx_type;
+        using size_type = size_t;
+
+        static constexpr index_type no_index = index_type(-1);
+
+        LcaIndex_(pointer root = nullptr)
+            : m_root(root)
+        {}
+
+        #pragma region attributes
+        inline pointer root() const { return m_root; }
+        inline void setRoot(pointer root)
+        {
+            m_root = root;
+            m_valid = false;
+        }
+
+        inline bool empty() const { return m_nodes.empty(); }
+        inline size_type size() const { return m_nodes.size(); }
+
+        // number of rebuilds so far
+        inline size_type generation() const { return m_generation; }
+
+        // topology of the subtree changed since last rebuild
+        inline bool isStale() const { return !m_valid || (m_root && (m_root->revision() != m_revision)); }
+        #pragma endregion
+
+        #pragma region update
+        // rebuild if necessary, returns whether it did
+        inline bool update()
+        {
+            if (!isStale()) return false;
+            rebuild();
+            return true;
+        }
+
+        inline void rebuild()
+        {
+            m_nodes.clear();
+            m_parents.clear();
+            m_depths.clear();
+            m_index.clear();
+            m_valid = true;
+            ++m_generation;
+            if (m_root != nullptr)
+            {
+                m_revision = m_root->revision();
+                auto end = m_root->end_recurse();
+                for (auto it = m_root->begin_recurse(); it != end; ++it)
+                {
+                    int depth = it.depth();
+                    index_type idx = static_cast<index_type>(m_nodes.size());
+                    m_lastAtDepth.resize(depth + 1);
+                    m_lastAtDepth[depth] = idx;
+                    m_parents.push_back((depth == 0) ? no_index : m_lastAtDepth[depth - 1]);
+                    m_depths.push_back(static_cast<index_type>(depth));
+                    m_nodes.push_back(static_cast<pointer>(it));
+                    m_index.emplace(m_nodes.back(), idx);
+                }
+            }
+            buildTable();
+        }
+        #pragma endregion
+
+        #pragma region queries
+        inline bool contains(const_pointer node) const { return m_index.count(node) > 0; }
+
+        // pre-order index of node, no_index if it is not in the subtree
+        inline index_type index(const_pointer node) const
+        {
+            auto it = m_index.find(node);
+            return (it != m_index.end()) ? it->second : no_index;
+        }
+
+        inline pointer node(index_type idx) const { return m_nodes[idx]; }
+        inline index_type parent(index_type idx) const { return m_parents[idx]; }
+        // depth below root()
+        inline index_type depth(index_type idx) const { return m_depths[idx]; }
+
+        // O(1) on indices
+        inline index_type lca(index_type u, index_type v) const
+        {
+            if (u == v) return u;
+            if (u > v) std::swap(u, v);
+            return m_parents[shallowest(u + 1, v)];
+        }
+
+        // nullptr if a or b are not in the subtree
+        inline pointer lca(const_pointer a, const_pointer b) const
+        {
+            index_type u = index(a);
+            index_type v = index(b);
+            if ((u == no_index) || (v == no_index)) return nullptr;
+            return m_nodes[lca(u, v)];
+        }
+
+        // number of edges on the path between u and v
+        inline index_type distance(index_type u, index_type v) const
+        {
+            return m_depths[u] + m_depths[v] - 2 * m_depths[lca(u, v)];
+        }
+
+        // -1 if a or b are not in the subtree
+        inline index_type distance(const_pointer a, const_pointer b) const
+        {
+            index_type u = index(a);
+            index_type v = index(b);
+            if ((u == no_index) || (v == no_index)) return no_index;
+            return distance(u, v);
+        }
+
+        // Appends the nodes on the path from a up to the common ancestor and down to b to result,
+        // both ends included. Returns false if a or b are not in the subtree.
+        inline bool path(const_pointer a, const_pointer b, std::vector<pointer>& result) const
+        {
+            index_type u = index(a);
+            index_type v = index(b);
+            if ((u == no_index) || (v == no_index)) return false;
+            index_type ancestor = lca(u, v);
+            for (index_type i = u; i != ancestor; i = m_parents[i])
+                result.push_back(m_nodes[i]);
+            result.push_back(m_nodes[ancestor]);
+            size_type down = result.size();
+            for (index_type i = v; i != ancestor; i = m_parents[i])
+                result.push_back(m_nodes[i]);
+            std::reverse(result.begin() + down, result.end());
+            return true;
+        }
+        #pragma endregion
+
+    protected:
+        // m_table[level * n + i] is the shallowest node in [i, i + 2^level)
+        inline void buildTable()
+        {
+            size_type n = m_nodes.size();
+            m_log.assign(n + 1, 0);
+            for (size_type i = 2; i <= n; ++i)
+                m_log[i] = m_log[i / 2] + 1;
+            size_type levels = (n > 0) ? m_log[n] + 1 : 0;
+            m_table.resize(levels * n);
+            for (size_type i = 0; i < n; ++i)
+                m_table[i] = static_cast<index_type>(i);
+            for (size_type level = 1; level < levels; ++level)
+            {
+                const index_type* prev = &m_table[(level - 1) * n];
+                index_type* current = &m_table[level * n];
+                size_type half = size_type(1) << (level - 1);
+                for (size_type i = 0; i + 2 * half <= n; ++i)
+                    current[i] = shallower(prev[i], prev[i + half]);
+            }
+        }
+
+        inline index_type shallower(index_type a, index_type b) const
+        {
+            return (m_depths[b] < m_depths[a]) ? b : a;
+        }
+
+        // shallowest node in [first, last]
+        inline index_type shallowest(index_type first, index_type last) const
+        {
+            size_type n = m_nodes.size();
+            size_type level = m_log[last - first + 1];
+            const index_type* row = &m_table[level * n];
+            return shallower(row[first], row[last + 1 - (size_type(1) << level)]);
+        }
+
+        pointer m_root;
+        bool m_valid = false;
+        size_type m_revision = 0;
+        size_type m_generation = 0;
+
+        std::vector<pointer> m_nodes;
+        std::vector<index_type> m_parents;
+        std::vector<index_type> m_depths;
+        std::unordered_map<const_pointer, index_type> m_index;
+        std::vector<index_type> m_table;
+        std::vector<unsigned char> m_log;
+
+        // scratch space for rebuild()
+        std::vector<index_type> m_lastAtDepth;
+    };
+    typedef LcaIndex_<Transform> LcaIndex;
+
+} // namespace transform_tree_glm
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+
+#include "transform_tree_glm/thread_pool.h"
+
+namespace transform_tree_glm {
+
+    // Calls f(begin, end) for contiguous chunks of [0, count) as tasks of pool, one chunk per worker,
+    // and waits for them, helping with the work. pool == nullptr or count below 2 * minChunk runs
+    // f(0, count) on the calling thread. If f throws, the first exception is rethrown after all
+    // chunks finished. Like ThreadPool::wait(), this also waits for tasks submitted by others.
+    template <typename F>
+    inline void parallelFor(ThreadPool* pool, size_t count, F&& f, size_t minChunk = 4096)
+    {
+        size_t maxChunks = count / std::max<size_t>(minChunk, 1);
+        size_t chunks = (pool != nullptr) ? std::min(pool->size(), maxChunks) : 0;
+        if (chunks <= 1)
+        {
+            f(size_t(0), count);
+            return;
+        }
+        size_t chunk = (count + chunks - 1) / chunks;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        for (size_t begin = 0; begin < count; begin += chunk)
+        {
+            size_t end = std::min(count, begin + chunk);
+            pool->submit([&f, &error, &errorMutex, begin, end]() {
+                try { f(begin, end); }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+            });
+        }
+        pool->wait();
+        if (error) std::rethrow_exception(error);
+    }
+
+} // namespace transform_tree_glm
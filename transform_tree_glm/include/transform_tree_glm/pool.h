@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "transform_tree_glm/transform.h"
+
+namespace transform_tree_glm {
+
+    // Arena for Transform_ nodes.
+    // Nodes live in chunks of contiguous slots, freed slots are reused through a free list.
+    // destroySubtree() and clear() tear down whole subtrees without unlinking every node
+    // from its parent and siblings, as all of them die together.
+    template <typename transform_t>
+    class TransformPool_
+    {
+    public:
+        using transform_type = transform_t;
+        using pointer = transform_t*;
+        using size_type = size_t;
+
+        TransformPool_(size_type chunkSize = 1024)
+            : m_chunkSize(chunkSize > 0 ? chunkSize : 1)
+        {}
+
+        ~TransformPool_()
+        {
+            clear();
+        }
+
+        TransformPool_(const TransformPool_&) = delete;
+        TransformPool_& operator=(const TransformPool_&) = delete;
+
+        #pragma region attributes
+        // number of live nodes
+        inline size_type size() const { return m_size; }
+        inline bool empty() const { return m_size == 0; }
+        // number of slots in all chunks
+        inline size_type capacity() const
+        {
+            size_type result = 0;
+            for (const auto& chunk : m_chunks) result += chunk.size;
+            return result;
+        }
+        #pragma endregion
+
+        #pragma region create and destroy
+        // constructs a node with the arguments of any Transform_ constructor
+        template <typename... Args>
+        inline pointer create(Args&&... args)
+        {
+            Slot* slot = allocate();
+            pointer node = new (slot->storage) transform_type(std::forward<Args>(args)...);
+            slot->live = true;
+            ++m_size;
+            return node;
+        }
+
+        // The next count nodes created are placed in consecutive slots, bypassing the free list,
+        // e.g. to keep the nodes of a subtree created in one go adjacent in memory.
+        // The slots come from the rest of the last chunk, else from a run of free slots in any chunk,
+        // else from a new chunk. Looking for a free run is O(capacity()). Slots of a previous
+        // reservation which were not used yet go back to the free list.
+        inline void reserveContiguous(size_type count)
+        {
+            releaseReserved();
+            if (count == 0) return;
+            Slot* run = nullptr;
+            if (!m_chunks.empty() && (m_chunks.back().size - m_bump >= count))
+            {
+                run = &m_chunks.back().slots[m_bump];
+                m_bump += count;
+            }
+            else
+            {
+                run = takeFreeRun(count);
+            }
+            if (run == nullptr)
+            {
+                addChunk((count > m_chunkSize) ? count : m_chunkSize);
+                run = &m_chunks.back().slots[0];
+                m_bump = count;
+            }
+            m_reserved = run;
+            m_contiguous = count;
+        }
+
+        // destroys a single node, its children are detached like when deleting it
+        inline void destroy(pointer node)
+        {
+            node->~transform_type();
+            deallocate(toSlot(node));
+        }
+
+        // Destroys node and its whole subtree. The subtree is detached from its parent once,
+        // the nodes inside are destroyed without unlinking them from each other.
+        // All nodes of the subtree must have been created by this pool, otherwise the behavior is undefined.
+        inline void destroySubtree(pointer node)
+        {
+            node->m_hierarchy.unlink();
+            m_scratch.clear();
+            auto end = node->end_recurse();
+            for (auto it = node->begin_recurse(); it != end; ++it)
+                m_scratch.push_back(static_cast<pointer>(it));
+            for (pointer item : m_scratch)
+                item->m_hierarchy.release();
+            for (pointer item : m_scratch)
+            {
+                item->~transform_type();
+                deallocate(toSlot(item));
+            }
+        }
+
+        // destroys all live nodes, nodes outside of the pool must not be linked to them
+        inline void clear()
+        {
+            for (auto& chunk : m_chunks)
+                for (size_type i = 0; i < chunk.size; ++i)
+                    if (chunk.slots[i].live) chunk.slots[i].node()->m_hierarchy.release();
+            for (auto& chunk : m_chunks)
+            {
+                for (size_type i = 0; i < chunk.size; ++i)
+                {
+                    if (!chunk.slots[i].live) continue;
+                    chunk.slots[i].node()->~transform_type();
+                    chunk.slots[i].live = false;
+                }
+            }
+            m_chunks.clear();
+            m_freeList = nullptr;
+            m_bump = 0;
+            m_reserved = nullptr;
+            m_contiguous = 0;
+            m_size = 0;
+        }
+        #pragma endregion
+
+    protected:
+        struct Slot
+        {
+            alignas(transform_type) unsigned char storage[sizeof(transform_type)];
+            Slot* nextFree = nullptr;
+            bool live = false;
+
+            inline pointer node() { return reinterpret_cast<pointer>(storage); }
+        };
+
+        struct Chunk
+        {
+            std::unique_ptr<Slot[]> slots;
+            size_type size;
+        };
+
+        static inline Slot* toSlot(pointer node) { return reinterpret_cast<Slot*>(node); }
+
+        // the unused rest of the last chunk goes to the free list
+        inline void addChunk(size_type size)
+        {
+            if (!m_chunks.empty())
+            {
+                Chunk& last = m_chunks.back();
+                for (size_type i = m_bump; i < last.size; ++i)
+                    pushFree(&last.slots[i]);
+            }
+            m_chunks.push_back(Chunk{std::unique_ptr<Slot[]>(new Slot[size]), size});
+            m_bump = 0;
+        }
+
+        // number of slots of chunk c handed out so far
+        inline size_type used(size_type c) const { return (c + 1 == m_chunks.size()) ? m_bump : m_chunks[c].size; }
+
+        inline Slot* allocate()
+        {
+            if (m_contiguous > 0)
+            {
+                --m_contiguous;
+                return m_reserved++;
+            }
+            if (m_freeList != nullptr)
+            {
+                Slot* slot = m_freeList;
+                m_freeList = slot->nextFree;
+                return slot;
+            }
+            if (m_chunks.empty() || (m_bump == m_chunks.back().size)) addChunk(m_chunkSize);
+            return &m_chunks.back().slots[m_bump++];
+        }
+
+        inline void deallocate(Slot* slot)
+        {
+            slot->live = false;
+            pushFree(slot);
+            --m_size;
+        }
+
+        inline void pushFree(Slot* slot)
+        {
+            slot->nextFree = m_freeList;
+            m_freeList = slot;
+        }
+
+        inline void releaseReserved()
+        {
+            for (; m_contiguous > 0; --m_contiguous)
+                pushFree(m_reserved++);
+            m_reserved = nullptr;
+        }
+
+        // Finds count consecutive free slots, removes them from the free list and returns the first one.
+        // The free list holds exactly the slots which are not live, except for the unused rest of the last chunk,
+        // so it is rebuilt from the live flags. nullptr if there is no such run.
+        inline Slot* takeFreeRun(size_type count)
+        {
+            size_type runChunk = m_chunks.size();
+            size_type runBegin = 0;
+            for (size_type c = 0; (c < m_chunks.size()) && (runChunk == m_chunks.size()); ++c)
+            {
+                size_type length = 0;
+                for (size_type i = 0; i < used(c); ++i)
+                {
+                    length = m_chunks[c].slots[i].live ? 0 : length + 1;
+                    if (length == count)
+                    {
+                        runChunk = c;
+                        runBegin = i + 1 - count;
+                        break;
+                    }
+                }
+            }
+            if (runChunk == m_chunks.size()) return nullptr;
+            m_freeList = nullptr;
+            for (size_type c = m_chunks.size(); c-- > 0;)
+            {
+                for (size_type i = used(c); i-- > 0;)
+                {
+                    bool inRun = (c == runChunk) && (i >= runBegin) && (i < runBegin + count);
+                    if (!m_chunks[c].slots[i].live && !inRun) pushFree(&m_chunks[c].slots[i]);
+                }
+            }
+            return &m_chunks[runChunk].slots[runBegin];
+        }
+
+        size_type m_chunkSize;
+        std::vector<Chunk> m_chunks;
+        // next unused slot in the last chunk
+        size_type m_bump = 0;
+        Slot* m_freeList = nullptr;
+        // next slot and number of remaining slots of the reservation of reserveContiguous()
+        Slot* m_reserved = nullptr;
+        size_type m_contiguous = 0;
+        size_type m_size = 0;
+        // scratch space for destroySubtree()
+        std::vector<pointer> m_scratch;
+    };
+    typedef TransformPool_<Transform> TransformPool;
+
+} // namespace transform_tree_glm
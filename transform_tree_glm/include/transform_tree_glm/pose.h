@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cassert>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp> 
 #include <glm/gtc/matrix_inverse.hpp> // glm::affineInverse
@@ -7,196 +9,263 @@
 #include <glm/gtx/matrix_decompose.hpp> // glm::decompose
 #include <glm/gtx/transform.hpp> // glm::scale
 
+#include "transform_tree_glm/affine.h"
+
 namespace transform_tree_glm {
 
-    class Pose 
+    // Local transformation as position, rotation and scale with scalar type T.
+    // Pose_<float> (Pose) uses the SIMD kernels and storage format from affine.h,
+    // Pose_<double> (DPose) is meant for frames far from the origin, e.g. near the root of large maps.
+    // A pose can be switched to rigid at runtime, see setRigid(), so rigid and scaled nodes share one tree.
+    template <typename T>
+    class Pose_
     {
+    public:
+        using scalar_type = T;
+        using vec3_type = glm::vec<3, T>;
+        using vec4_type = glm::vec<4, T>;
+        using quat_type = glm::qua<T>;
+        using mat3_type = glm::mat<3, 3, T>;
+        using mat4_type = glm::mat<4, 4, T>;
+        using mat4x3_type = glm::mat<4, 3, T>;
+        using affine_type = typename affine_storage<T>::matrix;
+        using affine_mat4_result_type = typename affine_storage<T>::mat4_result;
+
     protected:
         #pragma region data members
-        glm::vec3 m_position;
-        glm::quat m_rotation;
-        glm::vec3 m_scale;
+        vec3_type m_position;
+        quat_type m_rotation;
+        vec3_type m_scale;
 
-        glm::mat4 m_pose;
-        // bool m_dirtyPose = true;
+        // lazily built from position, rotation and scale by localPose()
+        mutable affine_type m_pose = affine_type(1);
+        mutable bool m_dirtyPose = true;
+        // scale is locked to (1,1,1), see setRigid()
+        bool m_rigid = false;
         #pragma endregion
 
 
     public:
-        inline static Pose identity() { return Pose(glm::mat4(1)); };
+        inline static Pose_ identity() { return Pose_(mat4_type(1)); };
 
     public:
         #pragma region constructors
-        Pose()
-            : m_position(glm::vec3(0,0,0))
+        Pose_()
+            : m_position(vec3_type(0,0,0))
             , m_rotation()
-            , m_scale(glm::vec3(1,1,1))
+            , m_scale(vec3_type(1,1,1))
         {}
 
-        Pose(const Pose& other)
+        Pose_(const Pose_& other)
             : m_position(other.m_position)
             , m_rotation(other.m_rotation)
             , m_scale(other.m_scale)
+            , m_pose(other.m_pose)
+            , m_dirtyPose(other.m_dirtyPose)
+            , m_rigid(other.m_rigid)
         {}
 
-        Pose(const glm::mat4& pose)
-            : m_position(glm::vec3(0,0,0))
+        // conversion between precisions, e.g. where a float subtree hangs below a double frame
+        template <typename U>
+        explicit Pose_(const Pose_<U>& other)
+            : m_position(vec3_type(other.accessConstLocalPosition()))
+            , m_rotation(quat_type(other.accessConstLocalRotation()))
+            , m_scale(vec3_type(other.accessConstLocalScale()))
+            , m_rigid(other.isRigid())
+        {}
+
+        Pose_(const mat4_type& pose)
+            : m_position(vec3_type(0,0,0))
             , m_rotation()
-            , m_scale(glm::vec3(1,1,1))
+            , m_scale(vec3_type(1,1,1))
         {
             setLocalPose(pose);
         }
 
-        Pose(const glm::mat4& pose, const glm::vec3& scale) 
-            : Pose(pose * glm::scale(scale))
+        Pose_(const mat4_type& pose, const vec3_type& scale) 
+            : Pose_(pose * glm::scale(scale))
         {}
 
-        Pose(const glm::vec3& position, const glm::mat3& rotation, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        Pose_(const vec3_type& position, const mat3_type& rotation, const vec3_type& scale=vec3_type(1,1,1)) 
             : m_position(position)
             , m_rotation(rotation)
             , m_scale(scale)
         {}
-        Pose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        Pose_(const vec3_type& position, const quat_type& rotation, const vec3_type& scale=vec3_type(1,1,1)) 
             : m_position(position)
             , m_rotation(rotation)
             , m_scale(scale)
         {}
 
-        Pose(const glm::vec3& position, const glm::vec3& eulerXYZ, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        Pose_(const vec3_type& position, const vec3_type& eulerXYZ, const vec3_type& scale=vec3_type(1,1,1)) 
             : m_position(position)
             , m_rotation(RotationEulerXYZ(eulerXYZ))
             , m_scale(scale)
         {}
-        Pose(const glm::vec3& position, float eulerX, float eulerY, float eulerZ, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        Pose_(const vec3_type& position, scalar_type eulerX, scalar_type eulerY, scalar_type eulerZ, const vec3_type& scale=vec3_type(1,1,1)) 
             : m_position(position)
             , m_rotation(glm::eulerAngleXYZ(eulerX, eulerY, eulerZ))
             , m_scale(scale)
         {}
 
-        static glm::mat4 RotationEulerXYZ(const glm::vec3& eulerXYZ) 
+        static mat4_type RotationEulerXYZ(const vec3_type& eulerXYZ) 
         {
             return glm::eulerAngleXYZ(eulerXYZ.x, eulerXYZ.y, eulerXYZ.z);
         }
-        static glm::vec3 ExtractEulerXYZ(const glm::mat4& rotation) 
+        static vec3_type ExtractEulerXYZ(const mat4_type& rotation) 
         { 
-            glm::vec3 result; 
+            vec3_type result; 
             glm::extractEulerAngleXYZ(rotation, result.x, result.y, result.z); 
             return result;
         }
+        static mat4_type InvertPose(const mat4_type& pose)
+        {
+            return invertAffine(pose);
+        }
+        static mat4x3_type InvertPose(const mat4x3_type& pose)
+        {
+            return invertAffine(pose);
+        }
         #pragma endregion
 
     public:
         #pragma region directly access transformation parameters position, rotation and scale
 
-        inline const glm::vec3& accessConstLocalPosition() const { return m_position; }
-        inline const glm::quat& accessConstLocalRotation() const { return m_rotation; }
-        inline const glm::vec3& accessConstLocalScale() const { return m_scale; }
-        inline glm::vec3& accessLocalPosition() { return m_position; }
-        inline glm::quat& accessLocalRotation() { return m_rotation; }
-        inline glm::vec3& accessLocalScale() { return m_scale; }
+        inline const vec3_type& accessConstLocalPosition() const { return m_position; }
+        inline const quat_type& accessConstLocalRotation() const { return m_rotation; }
+        inline const vec3_type& accessConstLocalScale() const { return m_scale; }
+        // must not be written to while the pose is rigid
+        // Taking a mutable reference marks the local pose matrix dirty, writing through it does not.
+        // Write right away and do not keep the reference across a call to localPose() or localAffine(),
+        // later writes would leave the cached matrix stale. Take the reference again instead.
+        inline vec3_type& accessLocalPosition() { m_dirtyPose = true; return m_position; }
+        inline quat_type& accessLocalRotation() { m_dirtyPose = true; return m_rotation; }
+        inline vec3_type& accessLocalScale() { m_dirtyPose = true; return m_scale; }
         
         #pragma endregion
 
+    public:
+        #pragma region rigid mode
+        // A rigid pose keeps its scale at (1,1,1), like RigidPose_ but decided per node at runtime.
+        // setLocalPose(mat4) then drops the scale it decomposes. Switching to rigid resets the scale.
+        // The scale is still stored, only RigidPose_ saves its memory. A Transform_ composes the world
+        // pose of a rigid node below rigid ancestors with quaternions and inverts it by transposing.
+        inline bool isRigid() const { return m_rigid; }
+        inline void setRigid(bool rigid)
+        {
+            m_rigid = rigid;
+            if (rigid && (m_scale != vec3_type(1,1,1)))
+            {
+                m_scale = vec3_type(1,1,1);
+                m_dirtyPose = true;
+            }
+        }
+        #pragma endregion
+
     public:
         #pragma region transformation matrices and quaternion for transformation parameters
-        inline glm::mat4 localTranslationMatrix() const { return glm::translate(m_position); }
-        inline glm::mat4 localScaleMatrix() const { return glm::scale(m_scale); }
-        inline glm::quat localRotationQuaternion() const { return m_rotation; }
-        inline glm::mat4 localRotationMatrix() const { return glm::mat4(m_rotation); }
+        inline mat4_type localTranslationMatrix() const { return glm::translate(m_position); }
+        inline mat4_type localScaleMatrix() const { return glm::scale(m_scale); }
+        inline quat_type localRotationQuaternion() const { return m_rotation; }
+        inline mat4_type localRotationMatrix() const { return mat4_type(m_rotation); }
         #pragma endregion
 
     public:
         #pragma region get local pose, position, rotation & scale in various formats
-        glm::vec3 localPosition() const { return m_position; }
-        glm::mat3 localRotation() const { return /*throw away last row and col to make it a rotation matrix*/ glm::mat3(localRotationMatrix()); }
-        glm::vec3 localScale() const { return m_scale; }
+        vec3_type localPosition() const { return m_position; }
+        mat3_type localRotation() const { return /*throw away last row and col to make it a rotation matrix*/ mat3_type(localRotationMatrix()); }
+        vec3_type localScale() const { return m_scale; }
 
-        const glm::mat4& localPose() { 
-            // if (m_dirtyPose)
+        const affine_type& localAffine() const { 
+            if (m_dirtyPose)
             {
-                m_pose = glm::mat4(m_rotation);
-                //m_pose = m_pose * glm::scale(m_scale);
-                m_pose = glm::scale(m_pose, m_scale);
-                m_pose[3].xyz = m_position;
-                // m_dirtyPose = false;
+                m_pose = affineMatrixFromTRS(m_position, m_rotation, m_scale);
+                m_dirtyPose = false;
             }
             return m_pose;
         }
-        glm::vec3 localRotationEulerXYZ() const { return ExtractEulerXYZ(localRotation()); }
+        affine_mat4_result_type localPose() const { return toMat4(localAffine()); }
+        inline bool isLocalPoseDirty() const { return m_dirtyPose; }
+        vec3_type localRotationEulerXYZ() const { return ExtractEulerXYZ(localRotation()); }
 
-        inline operator glm::mat4() const { return localTranslationMatrix(); }
+        inline operator mat4_type() const { return localPose(); }
         #pragma endregion
         
     public:
         #pragma region set local pose, position, rotation & scale in various formats
-        void setLocalPosition(const glm::vec3& position) 
+        void setLocalPosition(const vec3_type& position) 
         { 
             m_position = position;
-            // m_dirtyPose = true;
+            m_dirtyPose = true;
         }
 
-        void setLocalRotation(const glm::mat3& rotation) 
+        void setLocalRotation(const mat3_type& rotation) 
         {
             m_rotation = rotation;
-            // m_dirtyPose = true;
+            m_dirtyPose = true;
         }
-        void setLocalRotation(const glm::quat& rotation) 
+        void setLocalRotation(const quat_type& rotation) 
         {
             m_rotation = rotation;
-            // m_dirtyPose = true;
+            m_dirtyPose = true;
         }
-        void setLocalRotation(const glm::vec3& eulerXYZ) 
+        void setLocalRotation(const vec3_type& eulerXYZ) 
         {
-            setLocalRotation(glm::quat(RotationEulerXYZ(eulerXYZ)));
+            setLocalRotation(quat_type(RotationEulerXYZ(eulerXYZ)));
         }
-        void setLocalRotationEulerXYZ(const glm::vec3& rotation) 
+        void setLocalRotationEulerXYZ(const vec3_type& rotation) 
         {
-            setLocalRotation(glm::quat(RotationEulerXYZ(rotation)));
+            setLocalRotation(quat_type(RotationEulerXYZ(rotation)));
         }
-        void setLocalScale(const glm::vec3& scale)
+        // rigid poses only accept unit scale
+        void setLocalScale(const vec3_type& scale)
         {
+            assert(!m_rigid || (scale == vec3_type(1,1,1)));
+            if (m_rigid) return;
             m_scale = scale;
-            // m_dirtyPose = true;
+            m_dirtyPose = true;
         }
 
-        void setLocalPose(const glm::vec3& position, const glm::mat3& rotation, const glm::vec3& scale = glm::vec3(0,0,0))
+        void setLocalPose(const vec3_type& position, const mat3_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
         {
             setLocalPosition(position);
             setLocalRotation(rotation);
             setLocalScale(scale);
         }
 
-        void setLocalPose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale = glm::vec3(0,0,0))
+        void setLocalPose(const vec3_type& position, const quat_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
         {
             setLocalPosition(position);
             setLocalRotation(rotation);
             setLocalScale(scale);
         }
 
-        void setLocalPose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale = glm::vec3(0,0,0))
+        void setLocalPose(const vec3_type& position, const vec3_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
         {
             setLocalPosition(position);
             setLocalRotation(rotation);
             setLocalScale(scale);
         }
 
-        void setLocalPose(const glm::mat4& pose)
+        // uses the fast path for affine matrices without skew, glm::decompose otherwise.
+        // rigid poses drop the decomposed scale, see setRigid().
+        void setLocalPose(const mat4_type& pose)
         {
-            glm::vec3 scale;
-            glm::quat orientation;
-            glm::vec3 translation;
-            glm::vec3 skew;
-            glm::vec4 perspective;
-            if (glm::decompose(pose, scale, orientation, translation, skew, perspective))
+            vec3_type scale;
+            quat_type orientation;
+            vec3_type translation;
+            if (decompose(pose, translation, orientation, scale))
             {
-                m_scale = scale;
+                if (!m_rigid) m_scale = scale;
                 m_position = translation;
                 m_rotation = orientation;
-                // m_dirtyPose = true;
+                m_dirtyPose = true;
             }
         }
         #pragma endregion
 
     };
+    typedef Pose_<float> Pose;
+    typedef Pose_<double> DPose;
 
 } // namespace transform_tree_glm
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cassert>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp> 
+#include <glm/gtx/euler_angles.hpp> // glm::eulerAngleXYZ
+
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/pose.h"
+
+namespace transform_tree_glm {
+
+    // Pose without scale, only stores rotation and position.
+    // Can be used in place of Pose for Transform_, e.g. for sensor frames and robot links.
+    // Poses compose with quaternion-vector math and invert analytically.
+    // Setting it from a matrix drops the scale, see setLocalPose(mat4).
+    // All nodes of a Transform_ share one pose type. For trees mixing rigid and scaled
+    // nodes use Pose_ and switch the rigid nodes with Pose_::setRigid().
+    template <typename T>
+    class RigidPose_
+    {
+    public:
+        using scalar_type = T;
+        using vec3_type = glm::vec<3, T>;
+        using vec4_type = glm::vec<4, T>;
+        using quat_type = glm::qua<T>;
+        using mat3_type = glm::mat<3, 3, T>;
+        using mat4_type = glm::mat<4, 4, T>;
+        using mat4x3_type = glm::mat<4, 3, T>;
+        using affine_type = typename affine_storage<T>::matrix;
+        using affine_mat4_result_type = typename affine_storage<T>::mat4_result;
+
+    protected:
+        #pragma region data members
+        vec3_type m_position;
+        quat_type m_rotation;
+
+        // lazily built from position and rotation by localPose()
+        mutable affine_type m_pose = affine_type(1);
+        mutable bool m_dirtyPose = true;
+        #pragma endregion
+
+    public:
+        inline static RigidPose_ identity() { return RigidPose_(); };
+
+    public:
+        #pragma region constructors
+        RigidPose_()
+            : m_position(vec3_type(0,0,0))
+            , m_rotation()
+        {}
+
+        RigidPose_(const RigidPose_& other)
+            : m_position(other.m_position)
+            , m_rotation(other.m_rotation)
+            , m_pose(other.m_pose)
+            , m_dirtyPose(other.m_dirtyPose)
+        {}
+
+        template <typename U>
+        explicit RigidPose_(const RigidPose_<U>& other)
+            : m_position(vec3_type(other.accessConstLocalPosition()))
+            , m_rotation(quat_type(other.accessConstLocalRotation()))
+        {}
+
+        // drops the scale of pose
+        explicit RigidPose_(const Pose_<T>& pose)
+            : m_position(pose.accessConstLocalPosition())
+            , m_rotation(pose.accessConstLocalRotation())
+        {}
+
+        RigidPose_(const mat4_type& pose)
+            : m_position(vec3_type(0,0,0))
+            , m_rotation()
+        {
+            setLocalPose(pose);
+        }
+
+        RigidPose_(const vec3_type& position, const mat3_type& rotation) 
+            : m_position(position)
+            , m_rotation(rotation)
+        {}
+        RigidPose_(const vec3_type& position, const quat_type& rotation) 
+            : m_position(position)
+            , m_rotation(rotation)
+        {}
+
+        RigidPose_(const vec3_type& position, const vec3_type& eulerXYZ) 
+            : m_position(position)
+            , m_rotation(RotationEulerXYZ(eulerXYZ))
+        {}
+        RigidPose_(const vec3_type& position, scalar_type eulerX, scalar_type eulerY, scalar_type eulerZ) 
+            : m_position(position)
+            , m_rotation(glm::eulerAngleXYZ(eulerX, eulerY, eulerZ))
+        {}
+
+        static mat4_type RotationEulerXYZ(const vec3_type& eulerXYZ) 
+        {
+            return Pose_<T>::RotationEulerXYZ(eulerXYZ);
+        }
+        static vec3_type ExtractEulerXYZ(const mat4_type& rotation) 
+        { 
+            return Pose_<T>::ExtractEulerXYZ(rotation);
+        }
+        static mat4_type InvertPose(const mat4_type& pose)
+        {
+            return invertRigid(pose);
+        }
+        static mat4x3_type InvertPose(const mat4x3_type& pose)
+        {
+            return invertRigid(pose);
+        }
+        #pragma endregion
+
+    public:
+        #pragma region directly access transformation parameters position and rotation
+        inline const vec3_type& accessConstLocalPosition() const { return m_position; }
+        inline const quat_type& accessConstLocalRotation() const { return m_rotation; }
+        inline const vec3_type& accessConstLocalScale() const { static const vec3_type unit(1,1,1); return unit; }
+        // Taking a mutable reference marks the local pose matrix dirty, writing through it does not.
+        // Do not keep the reference across a call to localPose() or localAffine(), see Pose_.
+        inline vec3_type& accessLocalPosition() { m_dirtyPose = true; return m_position; }
+        inline quat_type& accessLocalRotation() { m_dirtyPose = true; return m_rotation; }
+        #pragma endregion
+
+    public:
+        #pragma region rigid mode
+        // always rigid, for interface compatibility with Pose_
+        inline bool isRigid() const { return true; }
+        inline void setRigid(bool rigid) { assert(rigid); (void)rigid; }
+        #pragma endregion
+
+    public:
+        #pragma region transformation matrices and quaternion for transformation parameters
+        inline mat4_type localTranslationMatrix() const { return glm::translate(m_position); }
+        inline mat4_type localScaleMatrix() const { return mat4_type(1); }
+        inline quat_type localRotationQuaternion() const { return m_rotation; }
+        inline mat4_type localRotationMatrix() const { return mat4_type(m_rotation); }
+        #pragma endregion
+
+    public:
+        #pragma region get local pose, position, rotation & scale in various formats
+        vec3_type localPosition() const { return m_position; }
+        mat3_type localRotation() const { return mat3_type(m_rotation); }
+        vec3_type localScale() const { return vec3_type(1,1,1); }
+
+        const affine_type& localAffine() const { 
+            if (m_dirtyPose)
+            {
+                m_pose = affineMatrixFromTRS(m_position, m_rotation, vec3_type(1,1,1));
+                m_dirtyPose = false;
+            }
+            return m_pose;
+        }
+        affine_mat4_result_type localPose() const { return toMat4(localAffine()); }
+        inline bool isLocalPoseDirty() const { return m_dirtyPose; }
+        vec3_type localRotationEulerXYZ() const { return ExtractEulerXYZ(mat4_type(localRotation())); }
+
+        inline operator mat4_type() const { return localPose(); }
+        // the result is a rigid Pose_, so it keeps rejecting scale inside a Transform_ with Pose_
+        inline operator Pose_<T>() const
+        {
+            Pose_<T> pose(m_position, m_rotation);
+            pose.setRigid(true);
+            return pose;
+        }
+        #pragma endregion
+
+    public:
+        #pragma region set local pose, position & rotation in various formats
+        void setLocalPosition(const vec3_type& position) 
+        { 
+            m_position = position;
+            m_dirtyPose = true;
+        }
+
+        void setLocalRotation(const mat3_type& rotation) 
+        {
+            m_rotation = rotation;
+            m_dirtyPose = true;
+        }
+        void setLocalRotation(const quat_type& rotation) 
+        {
+            m_rotation = rotation;
+            m_dirtyPose = true;
+        }
+        void setLocalRotation(const vec3_type& eulerXYZ) 
+        {
+            setLocalRotation(quat_type(RotationEulerXYZ(eulerXYZ)));
+        }
+        void setLocalRotationEulerXYZ(const vec3_type& rotation) 
+        {
+            setLocalRotation(quat_type(RotationEulerXYZ(rotation)));
+        }
+
+        // scale is only accepted for interface compatibility with Pose and must be unit
+        void setLocalPose(const vec3_type& position, const mat3_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
+        {
+            assert(scale == vec3_type(1,1,1));
+            (void)scale;
+            setLocalPosition(position);
+            setLocalRotation(rotation);
+        }
+
+        void setLocalPose(const vec3_type& position, const quat_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
+        {
+            assert(scale == vec3_type(1,1,1));
+            (void)scale;
+            setLocalPosition(position);
+            setLocalRotation(rotation);
+        }
+
+        void setLocalPose(const vec3_type& position, const vec3_type& rotation, const vec3_type& scale = vec3_type(1,1,1))
+        {
+            assert(scale == vec3_type(1,1,1));
+            (void)scale;
+            setLocalPosition(position);
+            setLocalRotation(rotation);
+        }
+
+        // The upper 3x3 of pose is only a rotation if it has no scale, which is not the case e.g. for
+        // Transform_::setWorldPose() below a scaled parent. The rotation is taken from the decomposition
+        // instead and the scale is dropped, see decompose().
+        void setLocalPose(const mat4_type& pose)
+        {
+            vec3_type scale;
+            quat_type rotation;
+            vec3_type position;
+            if (decompose(pose, position, rotation, scale))
+            {
+                m_position = position;
+                m_rotation = rotation;
+                m_dirtyPose = true;
+            }
+        }
+        #pragma endregion
+
+    public:
+        #pragma region rigid transformation algebra
+        inline RigidPose_ inverse() const
+        {
+            quat_type rotation = glm::conjugate(m_rotation);
+            return RigidPose_(-(rotation * m_position), rotation);
+        }
+
+        inline vec3_type transformPoint(const vec3_type& point) const { return m_rotation * point + m_position; }
+        inline vec3_type transformVector(const vec3_type& vector) const { return m_rotation * vector; }
+        #pragma endregion
+    };
+
+    // a * b
+    template <typename T>
+    inline RigidPose_<T> operator*(const RigidPose_<T>& a, const RigidPose_<T>& b)
+    {
+        return RigidPose_<T>(
+            a.transformPoint(b.accessConstLocalPosition()),
+            a.accessConstLocalRotation() * b.accessConstLocalRotation()
+        );
+    }
+
+    // a * b, a rigid pose as parent of a scaled one keeps the scale of b
+    template <typename T>
+    inline Pose_<T> operator*(const RigidPose_<T>& a, const Pose_<T>& b)
+    {
+        return Pose_<T>(
+            a.transformPoint(b.accessConstLocalPosition()),
+            a.accessConstLocalRotation() * b.accessConstLocalRotation(),
+            b.accessConstLocalScale()
+        );
+    }
+
+    typedef RigidPose_<float> RigidPose;
+    typedef RigidPose_<double> DRigidPose;
+
+} // namespace transform_tree_glm
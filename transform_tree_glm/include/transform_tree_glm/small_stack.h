@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+namespace transform_tree_glm {
+
+    // Stack keeping up to N items inline, only spills to the heap when it grows beyond that.
+    // Not copyable, as the data pointer may point into the object itself.
+    template <typename T, size_t N = 32>
+    class SmallStack
+    {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+
+        SmallStack() = default;
+        SmallStack(const SmallStack&) = delete;
+        SmallStack& operator=(const SmallStack&) = delete;
+
+        inline size_type size()     const { return m_size; }
+        inline bool      empty()    const { return m_size == 0; }
+        inline size_type capacity() const { return m_capacity; }
+        inline bool      onHeap()   const { return m_data != m_inline; }
+
+        inline T&       back()       { assert(m_size > 0); return m_data[m_size-1]; }
+        inline const T& back() const { assert(m_size > 0); return m_data[m_size-1]; }
+
+        inline T&       operator[](size_type i)       { assert(i < m_size); return m_data[i]; }
+        inline const T& operator[](size_type i) const { assert(i < m_size); return m_data[i]; }
+
+        template <typename... Args>
+        inline T& emplace_back(Args&&... args)
+        {
+            if (m_size == m_capacity) grow(2 * m_capacity);
+            m_data[m_size] = T(std::forward<Args>(args)...);
+            return m_data[m_size++];
+        }
+
+        inline void push_back(const T& item) { emplace_back(item); }
+        inline void pop_back() { assert(m_size > 0); --m_size; }
+        inline void clear() { m_size = 0; }
+
+        inline void resize(size_type size)
+        {
+            if (size > m_capacity) grow((size > 2 * m_capacity) ? size : 2 * m_capacity);
+            for (size_type i = m_size; i < size; ++i) m_data[i] = T();
+            m_size = size;
+        }
+
+    protected:
+        inline void grow(size_type capacity)
+        {
+            std::vector<T> bigger(capacity);
+            for (size_type i = 0; i < m_size; ++i) bigger[i] = std::move(m_data[i]);
+            m_heap.swap(bigger);
+            m_data = m_heap.data();
+            m_capacity = capacity;
+        }
+
+        T m_inline[N];
+        std::vector<T> m_heap;
+        T* m_data = m_inline;
+        size_type m_size = 0;
+        size_type m_capacity = N;
+    };
+
+} // namespace transform_tree_glm
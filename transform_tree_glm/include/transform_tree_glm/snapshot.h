@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/flat_tree.h"
+
+namespace transform_tree_glm {
+
+    // Immutable copy of world poses, names and topology of a Transform_ subtree.
+    // Nodes are in parent-before-child order like in FlatTree_ and split into pages of page_size nodes.
+    // Pages are shared between consecutive snapshots when nothing in them changed,
+    // so snapshots can be kept around cheaply and read from any thread.
+    template <typename transform_t, size_t page_size = 64>
+    class TreeSnapshot_
+    {
+    public:
+        using transform_type = transform_t;
+        using index_type = typename transform_t::idx_type;
+        using name_value_type = typename transform_t::name_value_type;
+        using mat4_type = typename transform_t::mat4_type;
+        using affine_type = typename transform_t::affine_type;
+        using affine_mat4_result_type = typename transform_t::affine_mat4_result_type;
+        using size_type = size_t;
+
+        static constexpr index_type no_parent = index_type(-1);
+
+        struct Node
+        {
+            affine_type worldPose;
+            index_type parent;
+            name_value_type name;
+
+            inline bool operator==(const Node& other) const
+            {
+                return (parent == other.parent) && (worldPose == other.worldPose) && (name == other.name);
+            }
+        };
+        using Page = std::vector<Node>;
+        using page_pointer = std::shared_ptr<const Page>;
+
+        #pragma region attributes
+        inline size_type size()        const { return m_size; }
+        inline bool      empty()       const { return m_size == 0; }
+        // number of the capture this snapshot was taken in
+        inline size_type sequence()    const { return m_sequence; }
+        inline const std::vector<page_pointer>& pages() const { return m_pages; }
+        #pragma endregion
+
+        #pragma region node access
+        inline const Node& node(size_type i) const { return (*m_pages[i / page_size])[i % page_size]; }
+
+        inline affine_mat4_result_type worldPose(size_type i) const { return toMat4(node(i).worldPose); }
+        inline const affine_type&      worldAffine(size_type i) const { return node(i).worldPose; }
+        inline index_type              parent(size_type i) const { return node(i).parent; }
+        inline const name_value_type&  name(size_type i) const { return node(i).name; }
+
+        // index of first node with name, -1 if there is none
+        inline index_type find(const name_value_type& name) const
+        {
+            for (size_type i = 0; i < m_size; ++i)
+                if (node(i).name == name) return static_cast<index_type>(i);
+            return no_parent;
+        }
+        #pragma endregion
+
+    protected:
+        template <typename, size_t> friend class SnapshotBuilder_;
+
+        std::vector<page_pointer> m_pages;
+        size_type m_size = 0;
+        size_type m_sequence = 0;
+    };
+
+    // Captures TreeSnapshot_s of a subtree, e.g. at the end of each simulation step.
+    // A page is shared with the previous snapshot when each of its slots still holds the same node,
+    // with the same parent and Transform_::changeRevision(), without reading its world poses or names.
+    // Only the other pages are allocated and copied. Names assigned directly instead of with
+    // Transform_::setName() are not noticed. Snapshots stay valid after the tree was modified or destroyed.
+    // Finding the unchanged pages still reads the revision of every node, so each capture() is O(tree size);
+    // only the copying is proportional to what changed. Nodes do not know the builders watching them,
+    // so there is no invalidation path which could mark pages dirty.
+    template <typename transform_t, size_t page_size = 64>
+    class SnapshotBuilder_
+    {
+    public:
+        using transform_type = transform_t;
+        using pointer = transform_t*;
+        using snapshot_type = TreeSnapshot_<transform_t, page_size>;
+        using snapshot_pointer = std::shared_ptr<const snapshot_type>;
+        using Node = typename snapshot_type::Node;
+        using Page = typename snapshot_type::Page;
+        using size_type = size_t;
+
+        SnapshotBuilder_(pointer root = nullptr)
+            : m_flat(root)
+        {}
+
+        inline pointer root() const { return m_flat.root(); }
+        inline void setRoot(pointer root)
+        {
+            m_flat.setRoot(root);
+            m_last.reset();
+            m_captured.clear();
+            m_capturedRevisions.clear();
+        }
+
+        // last captured snapshot, nullptr before the first capture
+        inline const snapshot_pointer& last() const { return m_last; }
+
+        // must not race with modifications of the tree
+        inline snapshot_pointer capture()
+        {
+            if (m_flat.isStale()) m_flat.rebuild();
+            const auto& nodes = m_flat.nodes();
+            const auto& parents = m_flat.parents();
+            std::shared_ptr<snapshot_type> snapshot(new snapshot_type());
+            snapshot->m_size = nodes.size();
+            snapshot->m_sequence = m_last ? m_last->sequence() + 1 : 0;
+            size_type numPages = (nodes.size() + page_size - 1) / page_size;
+            snapshot->m_pages.reserve(numPages);
+            // the slots of a shrunk last page are compared against nodes which are no longer there
+            size_type lastSize = m_last ? m_last->size() : 0;
+            m_captured.resize(nodes.size(), nullptr);
+            m_capturedRevisions.resize(nodes.size(), 0);
+            for (size_type p = 0; p < numPages; ++p)
+            {
+                size_type begin = p * page_size;
+                size_type end = (begin + page_size < nodes.size()) ? begin + page_size : nodes.size();
+                if ((end <= lastSize) && (m_last->pages()[p]->size() == end - begin) && unchanged(begin, end))
+                {
+                    snapshot->m_pages.push_back(m_last->pages()[p]);
+                    continue;
+                }
+                std::shared_ptr<Page> page = std::make_shared<Page>(end - begin);
+                for (size_type i = begin; i < end; ++i)
+                {
+                    Node& node = (*page)[i - begin];
+                    node.worldPose = nodes[i]->worldAffine();
+                    node.parent = parents[i];
+                    node.name = nodes[i]->name;
+                    m_captured[i] = nodes[i];
+                    m_capturedRevisions[i] = nodes[i]->changeRevision();
+                }
+                snapshot->m_pages.push_back(std::move(page));
+            }
+            m_last = snapshot;
+            return m_last;
+        }
+
+    protected:
+        // nodes [begin, end) are the ones captured into the previous snapshot and did not change since.
+        // reads one pointer and one revision per node, stops at the first change.
+        inline bool unchanged(size_type begin, size_type end) const
+        {
+            const auto& nodes = m_flat.nodes();
+            const auto& parents = m_flat.parents();
+            const Page& page = *m_last->pages()[begin / page_size];
+            for (size_type i = begin; i < end; ++i)
+            {
+                if ((nodes[i] != m_captured[i])
+                    || (nodes[i]->changeRevision() != m_capturedRevisions[i])
+                    || (parents[i] != page[i - begin].parent))
+                    return false;
+            }
+            return true;
+        }
+
+        FlatTree_<transform_t> m_flat;
+        snapshot_pointer m_last;
+        // node and its revision per slot when the slot was last captured
+        std::vector<pointer> m_captured;
+        std::vector<size_t> m_capturedRevisions;
+    };
+    typedef TreeSnapshot_<Transform> TreeSnapshot;
+    typedef SnapshotBuilder_<Transform> SnapshotBuilder;
+
+} // namespace transform_tree_glm
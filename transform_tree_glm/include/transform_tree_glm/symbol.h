@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace transform_tree_glm {
+
+    // Process wide table of interned strings, each string gets a 32 bit id.
+    // Interning is guarded by a mutex, looking up the string of an id is lock free.
+    // Strings live in chunks which never move. Readers find the chunks through a directory
+    // which is copied when it grows; old directories are kept, as readers may still use them.
+    class SymbolTable
+    {
+    public:
+        using id_type = uint32_t;
+
+        static constexpr size_t chunk_bits = 8;
+        static constexpr size_t chunk_size = size_t(1) << chunk_bits;
+
+        SymbolTable()
+        {
+            // id 0 is the empty string
+            intern(std::string_view());
+        }
+
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        static inline SymbolTable& global()
+        {
+            static SymbolTable table;
+            return table;
+        }
+
+        inline id_type intern(std::string_view str)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_ids.find(str);
+            if (it != m_ids.end()) return it->second;
+            assert(m_size < size_t(id_type(-1)));
+            id_type id = static_cast<id_type>(m_size);
+            if ((id & (chunk_size - 1)) == 0) addChunk();
+            std::string& stored = m_chunks.back()[id & (chunk_size - 1)];
+            stored.assign(str.data(), str.size());
+            m_ids.emplace(std::string_view(stored), id);
+            ++m_size;
+            return id;
+        }
+
+        // id must come from intern()
+        inline const std::string& str(id_type id) const
+        {
+            const Directory* directory = m_directory.load(std::memory_order_acquire);
+            return directory->chunks[id >> chunk_bits][id & (chunk_size - 1)];
+        }
+
+        inline size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_size;
+        }
+
+    protected:
+        struct Directory
+        {
+            std::vector<const std::string*> chunks;
+        };
+
+        inline void addChunk()
+        {
+            m_chunks.emplace_back(new std::string[chunk_size]);
+            std::unique_ptr<Directory> directory(new Directory());
+            directory->chunks.reserve(m_chunks.size());
+            for (const auto& chunk : m_chunks)
+                directory->chunks.push_back(chunk.get());
+            m_directory.store(directory.get(), std::memory_order_release);
+            m_directories.push_back(std::move(directory));
+        }
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string_view, id_type> m_ids;
+        std::vector<std::unique_ptr<std::string[]>> m_chunks;
+        std::vector<std::unique_ptr<Directory>> m_directories;
+        std::atomic<const Directory*> m_directory{nullptr};
+        size_t m_size = 0;
+    };
+
+    // Interned string usable as Transform_::name_value_type.
+    // 4 bytes instead of a std::string per node, equality and hashing compare the id only.
+    // Ordering compares ids too, which is not alphabetical.
+    class Symbol
+    {
+    public:
+        using id_type = SymbolTable::id_type;
+
+        Symbol() = default;
+        Symbol(std::string_view str) : m_id(SymbolTable::global().intern(str)) {}
+        Symbol(const std::string& str) : Symbol(std::string_view(str)) {}
+        Symbol(const char* str) : Symbol(std::string_view(str)) {}
+
+        static inline Symbol fromId(id_type id)
+        {
+            Symbol symbol;
+            symbol.m_id = id;
+            return symbol;
+        }
+
+        inline id_type id() const { return m_id; }
+        inline bool empty() const { return m_id == 0; }
+
+        inline const std::string& str() const { return SymbolTable::global().str(m_id); }
+        inline const char* c_str() const { return str().c_str(); }
+        inline size_t size() const { return str().size(); }
+
+        inline operator const std::string&() const { return str(); }
+        inline operator std::string_view() const { return str(); }
+
+        friend inline bool operator==(const Symbol& lhs, const Symbol& rhs) { return lhs.m_id == rhs.m_id; }
+        friend inline bool operator!=(const Symbol& lhs, const Symbol& rhs) { return lhs.m_id != rhs.m_id; }
+        friend inline bool operator<(const Symbol& lhs, const Symbol& rhs)  { return lhs.m_id < rhs.m_id; }
+
+        friend inline std::ostream& operator<<(std::ostream& os, const Symbol& symbol) { return os << symbol.str(); }
+
+    protected:
+        id_type m_id = 0;
+    };
+
+} // namespace transform_tree_glm
+
+namespace std {
+    template <>
+    struct hash<transform_tree_glm::Symbol>
+    {
+        inline size_t operator()(const transform_tree_glm::Symbol& symbol) const noexcept
+        {
+            return std::hash<transform_tree_glm::Symbol::id_type>()(symbol.id());
+        }
+    };
+} // namespace std
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace transform_tree_glm {
+
+    // Work-stealing thread pool.
+    // Every worker has its own task queue, submitted tasks are distributed round robin.
+    // Workers take tasks from the back of their own queue and steal from the front of
+    // the others when it runs empty. The thread calling wait() helps with the work.
+    class ThreadPool
+    {
+    public:
+        using task_type = std::function<void()>;
+
+        // threads == 0 uses std::thread::hardware_concurrency()
+        explicit ThreadPool(unsigned threads = 0)
+        {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            m_queues.reserve(threads);
+            for (unsigned i = 0; i < threads; ++i)
+                m_queues.emplace_back(new Queue());
+            m_workers.reserve(threads);
+            for (unsigned i = 0; i < threads; ++i)
+                m_workers.emplace_back([this, i]() { work(i); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (auto& worker : m_workers)
+                worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        inline size_t size() const { return m_workers.size(); }
+
+        inline void submit(task_type task)
+        {
+            Queue& queue = *m_queues[m_nextQueue++ % m_queues.size()];
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+                m_queued.fetch_add(1, std::memory_order_release);
+            }
+            // a worker checks m_queued under m_mutex before sleeping, so it either saw the task or gets notified
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+            }
+            m_wake.notify_one();
+        }
+
+        // blocks until all submitted tasks are done, executes tasks in the meantime
+        inline void wait()
+        {
+            task_type task;
+            while (m_pending.load(std::memory_order_acquire) > 0)
+            {
+                if (steal(0, task))
+                {
+                    run(task);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_done.wait(lock, [this]() { return (queued() > 0) || (m_pending.load(std::memory_order_acquire) == 0); });
+            }
+        }
+
+    protected:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        inline bool pop(size_t index, task_type& task)
+        {
+            Queue& queue = *m_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // try all queues starting after index
+        inline bool steal(size_t index, task_type& task)
+        {
+            for (size_t i = 1; i <= m_queues.size(); ++i)
+            {
+                Queue& queue = *m_queues[(index + i) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        inline void run(task_type& task)
+        {
+            task();
+            task = nullptr;
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        }
+
+        inline size_t queued() const { return m_queued.load(std::memory_order_acquire); }
+
+        inline void work(size_t index)
+        {
+            task_type task;
+            for (;;)
+            {
+                if (pop(index, task) || steal(index, task))
+                {
+                    run(task);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_stop || (queued() > 0); });
+                if (m_stop && (queued() == 0)) return;
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<size_t> m_nextQueue{0};
+        std::atomic<size_t> m_pending{0};
+
+        // number of tasks in all queues, only changed together with a queue under its mutex,
+        // so it never counts a task which was already taken
+        std::atomic<size_t> m_queued{0};
+
+        // guards m_stop, used for sleeping and waking
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        bool m_stop = false;
+    };
+
+} // namespace transform_tree_glm
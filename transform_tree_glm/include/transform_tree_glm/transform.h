@@ -1,6 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp> 
@@ -9,65 +18,101 @@
 #include <glm/gtx/matrix_decompose.hpp> // glm::decompose
 #include <glm/gtx/transform.hpp> // glm::scale
 
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/concurrent.h"
 #include "transform_tree_glm/pose.h"
+#include "transform_tree_glm/rigid_pose.h"
+#include "transform_tree_glm/symbol.h"
 #include "transform_tree_glm/hierarchy.h"
+#include "transform_tree_glm/history.h"
+#include "transform_tree_glm/parallel.h"
+#include "transform_tree_glm/thread_pool.h"
 
 namespace transform_tree_glm {
 
-    template<typename name_value_t = std::string, typename idx_t = int>
-    class Transform_ : protected Pose
+    template <typename transform_t> class FlatTree_;
+    template <typename transform_t> class TransformPool_;
+
+    namespace detail {
+        // pose of source in the frame of target through their origins, see Transform_::setOrigin
+        template <typename source_t, typename target_t>
+        glm::dmat4 poseAcrossOrigins(source_t* source, target_t* target);
+    }
+
+    template<typename name_value_t = std::string, typename idx_t = int, typename pose_t = Pose>
+    class Transform_ : protected pose_t
     {
+        // batch updaters write computed world poses directly into the cache
+        template <typename transform_t> friend class FlatTree_;
+        // releases hierarchy links for bulk destruction
+        template <typename transform_t> friend class TransformPool_;
+
     public:
         using pointer = Transform_*;
         using const_pointer = const Transform_*;
-        using pose_type = Pose;
+        using pose_type = pose_t;
+        using scalar_type = typename pose_type::scalar_type;
+        using vec3_type = typename pose_type::vec3_type;
+        using vec4_type = typename pose_type::vec4_type;
+        using quat_type = typename pose_type::quat_type;
+        using mat3_type = typename pose_type::mat3_type;
+        using mat4_type = typename pose_type::mat4_type;
+        using affine_type = typename pose_type::affine_type;
+        using affine_mat4_result_type = typename pose_type::affine_mat4_result_type;
+        using history_type = PoseHistory_<pose_type>;
+        using time_type = typename history_type::time_type;
+        using concurrent_pose_type = SeqLockBuffer_<mat4_type>;
+        // double precision tree this tree can be attached to, see setOrigin()
+        using origin_type = Transform_<name_value_t, idx_t, Pose_<double>>;
 
+        // index type of the linearized views FlatTree_, LcaIndex_ and TreeSnapshot_ and of the compact
+        // IndexedHierarchy_ a tree is copied into, the hierarchy of Transform_ itself is linked by pointers
         using idx_type = idx_t;
         using name_value_type = name_value_t;
 
         Transform_()
-            : Pose()
+            : pose_type()
             , m_hierarchy(this)
         {}
-        Transform_(const Pose& pose)
-            : Pose(pose)
+        Transform_(const pose_type& pose)
+            : pose_type(pose)
             , m_hierarchy(this)
         {}
 
-        Transform_(const std::string& name, const Pose& pose = Pose::identity())
-            : Pose(pose)
+        Transform_(const name_value_type& name, const pose_type& pose = pose_type::identity())
+            : pose_type(pose)
             , m_hierarchy(this)
             , name(name)
         {
         }
 
-        Transform_(pointer parent, const Pose& pose = Pose::identity())
-            : Pose(pose)
+        Transform_(pointer parent, const pose_type& pose = pose_type::identity())
+            : pose_type(pose)
             , m_hierarchy(this)
-            , name("")
+            , name()
         {
             setParent(parent);
         }
 
-        Transform_(void* data, pointer parent, const Pose& pose = Pose::identity())
-            : Pose(pose)
+        Transform_(void* data, pointer parent, const pose_type& pose = pose_type::identity())
+            : pose_type(pose)
             , m_hierarchy(this)
             , data(data)
-            , name("")
+            , name()
         {
             setParent(parent);
         }
 
-        Transform_(const std::string& name, pointer parent, const Pose& pose = Pose::identity())
-            : Pose(pose)
+        Transform_(const name_value_type& name, pointer parent, const pose_type& pose = pose_type::identity())
+            : pose_type(pose)
             , m_hierarchy(this)
             , name(name)
         {
             setParent(parent);
         }
 
-        Transform_(const std::string& name, void* data, pointer parent, const Pose& pose = Pose::identity())
-            : Pose(pose)
+        Transform_(const name_value_type& name, void* data, pointer parent, const pose_type& pose = pose_type::identity())
+            : pose_type(pose)
             , m_hierarchy(this)
             , data(data)
             , name(name)
@@ -75,8 +120,43 @@ namespace transform_tree_glm {
             setParent(parent);
         }
 
+        ~Transform_()
+        {
+            // children get detached when m_hierarchy is destroyed, which changes their world pose
+            for (auto& child : children())
+                child.invalidateWorldPose();
+        }
+
     protected:
         Hierarchy m_hierarchy;
+        // cached transformLocalToRoot(), only valid while m_dirtyWorldPose is false.
+        // invariant: a dirty node only has dirty descendants.
+        affine_type m_worldPose = affine_type(1);
+        bool m_dirtyWorldPose = true;
+        // the world pose is rigid, i.e. this node and all its ancestors are rigid.
+        // m_worldRotation then holds the rotation of m_worldPose, see composeWorldPose().
+        bool m_rigidWorld = false;
+        quat_type m_worldRotation = quat_type(1, 0, 0, 0);
+        // cached inverse of m_worldPose, invalidated together with it
+        affine_type m_inverseWorldPose = affine_type(1);
+        bool m_dirtyInverseWorldPose = true;
+        // changes whenever the world pose gets outdated or setName() is called, see changeRevision()
+        size_t m_changeRevision = nextChangeRevision();
+        // timestamped local poses, only allocated when enabled
+        std::unique_ptr<history_type> m_history;
+        // world pose published for readers on other threads, only allocated when enabled
+        std::unique_ptr<concurrent_pose_type> m_publishedWorldPose;
+        // cached split of the subtree for updateWorldTransforms(), only allocated on first call
+        struct UpdatePlan;
+        std::unique_ptr<UpdatePlan> m_updatePlan;
+        // only the one of the root is used, see setOrigin()
+        origin_type* m_origin = nullptr;
+        // children by name, only allocated on first lookup.
+        // rebuilt when the children revision changed, changes further down the subtree keep it.
+        using child_name_map_type = std::unordered_map<std::string_view, pointer>;
+        mutable std::unique_ptr<child_name_map_type> m_childNames;
+        mutable size_t m_childNamesRevision = 0;
+        mutable bool m_dirtyChildNames = true;
     public:
         void* data = nullptr;
         // using Hierarchy::data;
@@ -88,111 +168,598 @@ namespace transform_tree_glm {
         }
 
         #pragma region transformation hierarchy
-        inline glm::mat4 transformParentToRoot() { return parent() ? parent()->transformLocalToRoot() : glm::mat4(1); }
-        inline glm::mat4 transformLocalToRoot() { return transformParentToRoot() * localPose(); }
-        inline const glm::mat4& transformLocalToParent() { return localPose(); }
+        inline mat4_type transformParentToRoot() { return parent() ? parent()->transformLocalToRoot() : mat4_type(1); }
+        inline affine_mat4_result_type transformLocalToRoot() { return toMat4(worldAffine()); }
+        inline mat4_type transformRootToParent() { return parent() ? parent()->transformRootToLocal() : mat4_type(1); }
+        inline affine_mat4_result_type transformRootToLocal() { return toMat4(inverseWorldAffine()); }
+        inline affine_mat4_result_type transformLocalToParent() { return localPose(); }
+
+        // cached world pose in storage format
+        inline const affine_type& worldAffine()
+        { 
+            if (m_dirtyWorldPose)
+            {
+                pointer parentNode = parent();
+                if (parentNode) parentNode->worldAffine();
+                composeWorldPose(parentNode);
+                m_dirtyWorldPose = false;
+            }
+            return m_worldPose; 
+        }
+
+        // cached inverse world pose in storage format
+        inline const affine_type& inverseWorldAffine()
+        {
+            if (m_dirtyInverseWorldPose)
+            {
+                const affine_type& world = worldAffine();
+                m_inverseWorldPose = m_rigidWorld ? invertRigid(world) : pose_type::InvertPose(world);
+                m_dirtyInverseWorldPose = false;
+            }
+            return m_inverseWorldPose;
+        }
+
+        inline bool isWorldPoseDirty() const { return m_dirtyWorldPose; }
+
+        // recompute cached world pose assuming the one of the parent is up to date
+        inline void computeWorldPoseFromParent()
+        {
+            composeWorldPose(parent());
+            m_dirtyWorldPose = false;
+            m_dirtyInverseWorldPose = true;
+        }
+
+        // mark cached world pose of this node and all its descendants as outdated.
+        // as dirty nodes only have dirty descendants, propagation stops at already dirty nodes.
+        inline void invalidateWorldPose()
+        {
+            // the inverse is only ever computed from a clean world pose, so it is dirty here as well
+            if (m_dirtyWorldPose) return;
+            invalidateWorldPose(nextChangeRevision());
+        }
+
+        // Differs from any earlier value of this or another node once the world pose or the name
+        // (through setName()) may have changed. A node whose revision is the same as when its world pose
+        // was last read still has that world pose, see SnapshotBuilder_.
+        inline size_t changeRevision() const { return m_changeRevision; }
+        #pragma endregion
+
+    protected:
+        // World pose from the up to date world pose of parentNode.
+        // A rigid node below a rigid world pose composes rotation and position with quaternion-vector math,
+        // without building its local matrix, everything else multiplies the matrices.
+        inline void composeWorldPose(const_pointer parentNode)
+        {
+            if (isRigid() && (!parentNode || parentNode->m_rigidWorld))
+            {
+                vec3_type position = accessConstLocalPosition();
+                quat_type rotation = accessConstLocalRotation();
+                if (parentNode)
+                {
+                    const affine_type& parentWorld = parentNode->m_worldPose;
+                    position = vec3_type(parentWorld[0]) * position.x + vec3_type(parentWorld[1]) * position.y + vec3_type(parentWorld[2]) * position.z + vec3_type(parentWorld[3]);
+                    rotation = parentNode->m_worldRotation * rotation;
+                }
+                m_worldPose = affineMatrixFromTRS(position, rotation, vec3_type(1,1,1));
+                m_worldRotation = rotation;
+                m_rigidWorld = true;
+                return;
+            }
+            m_worldPose = parentNode ? composeAffine(parentNode->m_worldPose, localAffine()) : localAffine();
+            m_rigidWorld = false;
+        }
+
+        // one revision for all nodes outdated by the same change
+        inline void invalidateWorldPose(size_t revision)
+        {
+            if (m_dirtyWorldPose) return;
+            m_dirtyWorldPose = true;
+            m_dirtyInverseWorldPose = true;
+            m_changeRevision = revision;
+            for (auto& child : children())
+                child.invalidateWorldPose(revision);
+        }
+
+        static inline size_t nextChangeRevision()
+        {
+            static std::atomic<size_t> counter(0);
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        // linearized subtree and its split into work for updateWorldTransforms()
+        struct UpdatePlan
+        {
+            struct Step
+            {
+                size_t begin;
+                size_t end;
+                // [begin, end) is computed as task on the pool, otherwise node begin on the calling thread
+                bool task;
+            };
+            bool valid = false;
+            Hierarchy::size_type revision = 0;
+            size_t grain = 0;
+            std::vector<pointer> nodes;
+            std::vector<Step> steps;
+        };
+
+        // subtreeSize() is maintained by the hierarchy, so the split needs no counting pass
+        inline void planWorldTransformUpdate(UpdatePlan& plan, size_t grain)
+        {
+            plan.nodes.clear();
+            plan.steps.clear();
+            auto end = end_recurse();
+            for (auto it = begin_recurse(); it != end; ++it)
+                plan.nodes.push_back(static_cast<pointer>(it));
+            size_t count = plan.nodes.size();
+            size_t rangeBegin = count;
+            auto flush = [&](size_t rangeEnd)
+            {
+                if (rangeBegin < rangeEnd) plan.steps.push_back({ rangeBegin, rangeEnd, true });
+                rangeBegin = count;
+            };
+            for (size_t k = 0; k < count;)
+            {
+                size_t size = plan.nodes[k]->subtreeSize();
+                if (size > grain)
+                {
+                    flush(k);
+                    plan.steps.push_back({ k, k + 1, false });
+                    k += 1;
+                }
+                else
+                {
+                    if (rangeBegin == count) rangeBegin = k;
+                    k += size;
+                    if (k - rangeBegin >= grain) flush(k);
+                }
+            }
+            flush(count);
+            plan.revision = revision();
+            plan.grain = grain;
+            plan.valid = true;
+        }
+
+    public:
+        #pragma region parallel world update
+        // Computes the world poses of the whole subtree of this on pool.
+        // Nodes with subtrees larger than grain are computed first on the calling thread,
+        // the remaining small subtrees are coalesced into consecutive ranges of about grain 
+        // nodes which are computed as tasks on the pool.
+        // The subtree is linearized in parent-before-child order and split only when its revision()
+        // or grain changed since the last call on this node, otherwise the cached split is reused.
+        inline void updateWorldTransforms(ThreadPool& pool, size_t grain = 1024)
+        {
+            if (grain == 0) grain = 1;
+            if (!m_updatePlan) m_updatePlan.reset(new UpdatePlan());
+            UpdatePlan& plan = *m_updatePlan;
+            if (!plan.valid || (plan.revision != revision()) || (plan.grain != grain))
+                planWorldTransformUpdate(plan, grain);
+            // the subtree root reads the world pose of its parent
+            if (parent()) parent()->worldAffine();
+            pointer* nodes = plan.nodes.data();
+            for (const auto& step : plan.steps)
+            {
+                if (!step.task)
+                {
+                    nodes[step.begin]->computeWorldPoseFromParent();
+                    continue;
+                }
+                pointer* first = nodes + step.begin;
+                pointer* last = nodes + step.end;
+                pool.submit([first, last]() 
+                {
+                    for (pointer* node = first; node != last; ++node)
+                        (*node)->computeWorldPoseFromParent();
+                });
+            }
+            pool.wait();
+        }
+        #pragma endregion
+
+        #pragma region relative transformations
+        // lowest common ancestor of this and other, nullptr if they are not in the same tree
+        inline pointer commonAncestor(pointer other)
+        {
+            int depthThis = 0;
+            int depthOther = 0;
+            for (pointer node = parent(); node != nullptr; node = node->parent()) ++depthThis;
+            for (pointer node = other->parent(); node != nullptr; node = node->parent()) ++depthOther;
+            pointer a = this;
+            pointer b = other;
+            for (; depthThis > depthOther; --depthThis) a = a->parent();
+            for (; depthOther > depthThis; --depthOther) b = b->parent();
+            while (a != b)
+            {
+                a = a->parent();
+                b = b->parent();
+            }
+            return a;
+        }
+
+        // transformation from local frame to frame of ancestor, composed only along the chain in between.
+        // ancestor == nullptr gives the transformation to the root frame.
+        inline affine_type transformLocalToAncestor(const_pointer ancestor)
+        {
+            affine_type result = affine_type(1);
+            for (pointer node = this; node != ancestor; node = node->parent())
+            {
+                assert(node != nullptr); // ancestor is not an ancestor of this
+                result = composeAffine(node->localAffine(), result);
+            }
+            return result;
+        }
+
+        // transformation from local frame of this to local frame of target, i.e. pose of this expressed in target.
+        // only the chains up to the lowest common ancestor are composed and only the target side is inverted,
+        // which is cheaper and more precise than going through the world poses when the root is far away.
+        // for nodes of disjoint trees the chains go up to both roots, which are taken as the same frame.
+        inline mat4_type transformTo(pointer target)
+        {
+            pointer ancestor = commonAncestor(target);
+            if ((ancestor == nullptr) && (origin() || target->origin()))
+                return mat4_type(detail::poseAcrossOrigins(this, target));
+            affine_type sourceToAncestor = transformLocalToAncestor(ancestor);
+            affine_type targetToAncestor = target->transformLocalToAncestor(ancestor);
+            return toMat4(composeAffine(pose_type::InvertPose(targetToAncestor), sourceToAncestor));
+        }
+
+        // transformation from local frame of this to local frame of target, target == nullptr means the root frame
+        inline mat4_type transformToFrame(pointer target)
+        {
+            return (target != nullptr) ? transformTo(target) : mat4_type(transformLocalToRoot());
+        }
+        #pragma endregion
+
+        #pragma region origin of double precision
+        // A tree can hang below a node of a double precision tree, its origin: the root frame of this
+        // tree is the local frame of the origin. This mixes precisions within one scene, e.g. a map in
+        // double near the root with dense float frames at the leaves. World poses of this tree stay in
+        // its own precision and relative to its root frame, so moving the origin invalidates nothing here.
+        // globalPose() and transformTo() between nodes below different origins compose in double,
+        // only the chains below the origins are in the precision of their trees.
+        // The origin of the root applies to the whole tree. It must outlive the tree and must not be in it.
+        inline void setOrigin(origin_type* origin) { m_origin = origin; }
+        inline origin_type* origin() const { return root()->m_origin; }
+
+        // world pose in the frame of the outermost origin, in double precision
+        inline glm::dmat4 globalPose()
+        {
+            glm::dmat4 world(transformLocalToRoot());
+            origin_type* node = origin();
+            return node ? node->globalPose() * world : world;
+        }
+
+        // pose of this in the frame of a node of another precision, e.g. the origin or another
+        // node of the double precision tree, composed in double, see setOrigin()
+        template <typename other_pose_t>
+        inline glm::dmat4 transformTo(Transform_<name_value_t, idx_t, other_pose_t>* target)
+        {
+            return detail::poseAcrossOrigins(this, target);
+        }
+        #pragma endregion
+
+        #pragma region concurrent readers
+        // Opt-in mode for one writer thread and many reader threads.
+        // The writer modifies the tree as usual and calls publishWorldPoses() when done,
+        // readers only use readWorldPose() and readWorldPosition() which never block and never tear.
+        // Each node is published atomically, a reader may see nodes from different publishes.
+
+        // enables publishing for the subtree of this, must not race with readers of the subtree.
+        // nodes later attached below a node with publishing get it as well, addChild, setParent and
+        // spliceChildren initialize their buffers with their world pose at that time.
+        inline void enableConcurrentReads()
+        {
+            if (!m_publishedWorldPose) m_publishedWorldPose.reset(new concurrent_pose_type(mat4_type(transformLocalToRoot())));
+            for (auto& child : children())
+                child.enableConcurrentReads();
+        }
+        inline bool hasConcurrentReads() const { return m_publishedWorldPose != nullptr; }
+
+        // writer side, stores the current world poses of the subtree of this for readers
+        inline void publishWorldPoses()
+        {
+            if (m_publishedWorldPose) m_publishedWorldPose->store(mat4_type(transformLocalToRoot()));
+            for (auto& child : children())
+                child.publishWorldPoses();
+        }
+
+        // reader side, last published world pose, safe to call concurrently with the writer
+        inline mat4_type readWorldPose() const
+        {
+            assert(m_publishedWorldPose); // enableConcurrentReads() was not called
+            return m_publishedWorldPose->load();
+        }
+        inline vec3_type readWorldPosition() const { return vec3_type(readWorldPose()[3]); }
+        #pragma endregion
+
+        #pragma region pose history
+        // keep up to capacity timestamped local poses for lookups in the past.
+        // nodes without history are static, their current local pose is used for all times.
+        inline void enableHistory(size_t capacity)
+        {
+            if (m_history) m_history->setCapacity(capacity);
+            else m_history.reset(new history_type(capacity));
+        }
+        inline void disableHistory() { m_history.reset(); }
+        inline bool hasHistory() const { return m_history != nullptr; }
+        inline history_type*       history()       { return m_history.get(); }
+        inline const history_type* history() const { return m_history.get(); }
+
+        // store the current local pose with timestamp time, see PoseHistory_::insert
+        inline bool recordLocalPose(time_type time)
+        {
+            return m_history && m_history->insert(time, *this);
+        }
+
+        // local pose interpolated at time, false if time is outside of the history
+        inline bool localAffineAt(time_type time, affine_type& result) const
+        {
+            if (!m_history)
+            {
+                result = localAffine();
+                return true;
+            }
+            vec3_type position;
+            quat_type rotation;
+            vec3_type scale;
+            if (!m_history->lookup(time, position, rotation, scale)) return false;
+            result = affineMatrixFromTRS(position, rotation, scale);
+            return true;
+        }
+
+        // transformLocalToAncestor with all local poses of the chain taken at the same time
+        inline bool transformLocalToAncestorAt(const_pointer ancestor, time_type time, affine_type& result) const
+        {
+            result = affine_type(1);
+            for (const_pointer node = this; node != ancestor; node = node->parent())
+            {
+                assert(node != nullptr); // ancestor is not an ancestor of this
+                affine_type local;
+                if (!node->localAffineAt(time, local)) return false;
+                result = composeAffine(local, result);
+            }
+            return true;
+        }
+
+        inline bool transformLocalToRootAt(time_type time, mat4_type& result) const
+        {
+            affine_type localToRoot;
+            if (!transformLocalToAncestorAt(nullptr, time, localToRoot)) return false;
+            result = toMat4(localToRoot);
+            return true;
+        }
+
+        // transformTo at time, false if any frame on the path has no history covering time
+        inline bool transformToAt(pointer target, time_type time, mat4_type& result)
+        {
+            pointer ancestor = commonAncestor(target);
+            affine_type sourceToAncestor;
+            affine_type targetToAncestor;
+            if (!transformLocalToAncestorAt(ancestor, time, sourceToAncestor)) return false;
+            if (!target->transformLocalToAncestorAt(ancestor, time, targetToAncestor)) return false;
+            result = toMat4(composeAffine(pose_type::InvertPose(targetToAncestor), sourceToAncestor));
+            return true;
+        }
+        #pragma endregion
+
+    public:
+        #pragma region batch transformation of points, directions & normals into another frame
+        // the frame to frame matrix is computed once, the arrays are then processed with the
+        // kernels from affine.h, split over the workers of pool if given, see parallelFor.
+        // in and out may be the same array.
+
+        inline void transformPointsTo(pointer target, const vec3_type* in, vec3_type* out, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t begin, size_t end) { transform_tree_glm::transformPoints(m, in + begin, out + begin, end - begin); });
+        }
+        inline void transformDirectionsTo(pointer target, const vec3_type* in, vec3_type* out, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t begin, size_t end) { transform_tree_glm::transformDirections(m, in + begin, out + begin, end - begin); });
+        }
+        inline void transformNormalsTo(pointer target, const vec3_type* in, vec3_type* out, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t begin, size_t end) { transform_tree_glm::transformNormals(m, in + begin, out + begin, end - begin); });
+        }
+
+        inline void transformPointsTo(pointer target, const scalar_type* x, const scalar_type* y, const scalar_type* z, scalar_type* ox, scalar_type* oy, scalar_type* oz, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t b, size_t e) { transform_tree_glm::transformPoints(m, x + b, y + b, z + b, ox + b, oy + b, oz + b, e - b); });
+        }
+        inline void transformDirectionsTo(pointer target, const scalar_type* x, const scalar_type* y, const scalar_type* z, scalar_type* ox, scalar_type* oy, scalar_type* oz, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t b, size_t e) { transform_tree_glm::transformDirections(m, x + b, y + b, z + b, ox + b, oy + b, oz + b, e - b); });
+        }
+        inline void transformNormalsTo(pointer target, const scalar_type* x, const scalar_type* y, const scalar_type* z, scalar_type* ox, scalar_type* oy, scalar_type* oz, size_t count, ThreadPool* pool = nullptr)
+        {
+            mat4_type m = transformToFrame(target);
+            parallelFor(pool, count, [&](size_t b, size_t e) { transform_tree_glm::transformNormals(m, x + b, y + b, z + b, ox + b, oy + b, oz + b, e - b); });
+        }
         #pragma endregion
 
     public:
         #pragma region get local and world pose, position, rotation & scale in various formats
-        inline glm::vec3 worldPosition() { return transformLocalToRoot()[3].xyz; }
-        inline glm::mat3 worldRotation() { return /*throw away last row and col to make it a rotation matrix*/ glm::mat3(transformLocalToRoot()); }
-        inline glm::mat4 worldPose() { return transformLocalToRoot(); }
-        inline glm::vec3 worldRotationEulerXYZ() { return ExtractEulerXYZ(worldRotation()); }
+        inline vec3_type worldPosition() { return transformLocalToRoot()[3].xyz; }
+        inline mat3_type worldRotation() { return /*throw away last row and col to make it a rotation matrix*/ mat3_type(transformLocalToRoot()); }
+        inline mat4_type worldPose() { return transformLocalToRoot(); }
+        inline mat4_type inverseWorldPose() { return transformRootToLocal(); }
+        inline vec3_type worldToLocal(const vec3_type& point) { return vec3_type(transformRootToLocal() * vec4_type(point, 1)); }
+        inline vec3_type localToWorld(const vec3_type& point) { return vec3_type(transformLocalToRoot() * vec4_type(point, 1)); }
+        inline vec3_type worldRotationEulerXYZ() { return ExtractEulerXYZ(worldRotation()); }
         #pragma endregion
 
     public:
         #pragma region set local pose, position, rotation & scale in various formats
 
-        inline void setWorldPosition(const glm::vec3& position) 
+        inline void setWorldPosition(const vec3_type& position) 
         {
-            setWorldPosition(glm::vec4(position, 1));
+            setWorldPosition(vec4_type(position, 1));
         }
-        inline void setWorldPosition(const glm::vec4& position) 
+        inline void setWorldPosition(const vec4_type& position) 
         { 
-            glm::mat4 root_parent = transformParentToRoot();
-            glm::mat4 parent_root = glm::affineInverse(root_parent);
-            glm::vec4 pos_in_parent = parent_root * position;
-            setLocalPosition(pos_in_parent);
+            mat4_type parent_root = transformRootToParent();
+            vec4_type pos_in_parent = parent_root * position;
+            setLocalPosition(vec3_type(pos_in_parent));
         }
 
-        inline void setWorldRotation(const glm::mat3& rotation) 
+        inline void setWorldRotation(const mat3_type& rotation) 
         { 
-            glm::mat4 root_parent = transformParentToRoot();
-            glm::mat4 parent_root = glm::affineInverse(root_parent);
-            glm::mat3 rotation_in_parent = glm::mat3(parent_root) * rotation;
+            mat4_type parent_root = transformRootToParent();
+            mat3_type rotation_in_parent = mat3_type(parent_root) * rotation;
             setLocalRotation(rotation_in_parent);
         }
 
-        inline void setWorldRotation(const glm::quat& rotation) 
+        inline void setWorldRotation(const quat_type& rotation) 
         {
-            setWorldRotation(glm::mat3(rotation));
+            setWorldRotation(mat3_type(rotation));
         }
 
-        inline void setWorldRotation(const glm::vec3& eulerXYZ) 
+        inline void setWorldRotation(const vec3_type& eulerXYZ) 
         {
-            setWorldRotation(glm::quat(RotationEulerXYZ(eulerXYZ)));
+            setWorldRotation(quat_type(RotationEulerXYZ(eulerXYZ)));
         }
 
-        inline void setWorldRotationEulerXYZ(const glm::vec3& rotation) 
+        inline void setWorldRotationEulerXYZ(const vec3_type& rotation) 
         {
-            setWorldRotation(glm::quat(RotationEulerXYZ(rotation)));
+            setWorldRotation(quat_type(RotationEulerXYZ(rotation)));
         }
 
-        inline void setWorldPose(const glm::vec3& position, const glm::mat3& rotation, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        inline void setWorldPose(const vec3_type& position, const mat3_type& rotation, const vec3_type& scale=vec3_type(1,1,1)) 
         {
-            setWorldPose(Pose(position, rotation, scale));
+            setWorldPose(Pose_<scalar_type>(position, rotation, scale));
         }
-        inline void setWorldPose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        inline void setWorldPose(const vec3_type& position, const quat_type& rotation, const vec3_type& scale=vec3_type(1,1,1)) 
         {
-            setWorldPose(Pose(position, rotation, scale));
+            setWorldPose(Pose_<scalar_type>(position, rotation, scale));
         }
-        inline void setWorldPose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale=glm::vec3(1,1,1)) 
+        inline void setWorldPose(const vec3_type& position, const vec3_type& rotation, const vec3_type& scale=vec3_type(1,1,1)) 
         {
-            setWorldPose(Pose(position, rotation, scale));
+            setWorldPose(Pose_<scalar_type>(position, rotation, scale));
         }
 
-        inline void setWorldPose(const glm::mat4& pose)
+        inline void setWorldPose(const mat4_type& pose)
         {
-            glm::mat4 root_parent = transformParentToRoot();
-            glm::mat4 parent_root = glm::affineInverse(root_parent);
-            glm::mat4 pose_in_parent = parent_root * pose;
+            mat4_type parent_root = transformRootToParent();
+            mat4_type pose_in_parent = parent_root * pose;
             setLocalPose(pose_in_parent);
         }
 
         inline bool setParentKeepWorldPose(const pointer& newParent)
         {
-            if (m_parent == newParent) return false;
-            glm::mat4 oldWorldPose = worldPose();
+            if (parent() == newParent) return false;
+            mat4_type oldWorldPose = worldPose();
             setParent(newParent);
             setWorldPose(oldWorldPose);
             return true;
         }        
+
+        // local mutators hide those of pose_type to keep the cached world poses up to date
+        inline void setLocalPosition(const vec3_type& position) 
+        { 
+            pose_type::setLocalPosition(position);
+            invalidateWorldPose();
+        }
+
+        inline void setLocalRotation(const mat3_type& rotation) 
+        {
+            pose_type::setLocalRotation(rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalRotation(const quat_type& rotation) 
+        {
+            pose_type::setLocalRotation(rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalRotation(const vec3_type& eulerXYZ) 
+        {
+            pose_type::setLocalRotation(eulerXYZ);
+            invalidateWorldPose();
+        }
+        inline void setLocalRotationEulerXYZ(const vec3_type& rotation) 
+        {
+            pose_type::setLocalRotationEulerXYZ(rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalScale(const vec3_type& scale)
+        {
+            pose_type::setLocalScale(scale);
+            invalidateWorldPose();
+        }
+
+        // rigid nodes keep unit scale, see Pose_::setRigid()
+        inline void setRigid(bool rigid)
+        {
+            pose_type::setRigid(rigid);
+            invalidateWorldPose();
+        }
+
+        // without scale argument the default scale of pose_type applies
+        inline void setLocalPose(const vec3_type& position, const mat3_type& rotation)
+        {
+            pose_type::setLocalPose(position, rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const vec3_type& position, const quat_type& rotation)
+        {
+            pose_type::setLocalPose(position, rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const vec3_type& position, const vec3_type& rotation)
+        {
+            pose_type::setLocalPose(position, rotation);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const vec3_type& position, const mat3_type& rotation, const vec3_type& scale)
+        {
+            pose_type::setLocalPose(position, rotation, scale);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const vec3_type& position, const quat_type& rotation, const vec3_type& scale)
+        {
+            pose_type::setLocalPose(position, rotation, scale);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const vec3_type& position, const vec3_type& rotation, const vec3_type& scale)
+        {
+            pose_type::setLocalPose(position, rotation, scale);
+            invalidateWorldPose();
+        }
+        inline void setLocalPose(const mat4_type& pose)
+        {
+            pose_type::setLocalPose(pose);
+            invalidateWorldPose();
+        }
+
+        // Handing out a mutable reference invalidates the local and world poses once.
+        // Writes through a reference kept across a pose query are not seen, see Pose_::accessLocalPosition.
+        inline vec3_type& accessLocalPosition() { invalidateWorldPose(); return pose_type::accessLocalPosition(); }
+        inline quat_type& accessLocalRotation() { invalidateWorldPose(); return pose_type::accessLocalRotation(); }
+        inline vec3_type& accessLocalScale()    { invalidateWorldPose(); return pose_type::accessLocalScale(); }
         #pragma endregion
     public:
-        #pragma region Pose access
-        using Pose::RotationEulerXYZ;
-        using Pose::ExtractEulerXYZ;
-        using Pose::accessConstLocalPosition;
-        using Pose::accessConstLocalRotation;
-        using Pose::accessConstLocalScale;
-        using Pose::accessLocalPosition;
-        using Pose::accessLocalRotation;
-        using Pose::accessLocalScale;
-        using Pose::localTranslationMatrix;
-        using Pose::localScaleMatrix;
-        using Pose::localRotationQuaternion;
-        using Pose::localRotationMatrix;
-        using Pose::localPosition;
-        using Pose::localRotation;
-        using Pose::localScale;
-        using Pose::localPose;
-        using Pose::localRotationEulerXYZ;
-        using Pose::setLocalPosition;
-        using Pose::setLocalRotation;
-        using Pose::setLocalRotationEulerXYZ;
-        using Pose::setLocalScale;
-        using Pose::setLocalPose;     
+        #pragma region pose_type access
+        using pose_type::InvertPose;
+        using pose_type::RotationEulerXYZ;
+        using pose_type::ExtractEulerXYZ;
+        using pose_type::accessConstLocalPosition;
+        using pose_type::accessConstLocalRotation;
+        using pose_type::accessConstLocalScale;
+        using pose_type::isRigid;
+        using pose_type::localTranslationMatrix;
+        using pose_type::localScaleMatrix;
+        using pose_type::localRotationQuaternion;
+        using pose_type::localRotationMatrix;
+        using pose_type::localPosition;
+        using pose_type::localRotation;
+        using pose_type::localScale;
+        using pose_type::localPose;
+        using pose_type::localAffine;
+        using pose_type::localRotationEulerXYZ;
         #pragma endregion
 
     public:
@@ -205,11 +772,10 @@ namespace transform_tree_glm {
         // inline pointer& pointer() { return hierarchy.pointer(); }
         // inline const pointer& cpointer() const { return hierarchy.cpointer(); }
 
-        // inline idx_type indexInParent() const { return hierarchy.indexInParent(); }
-        // inline void updateIndexInParent(idx_type idx) { hierarchy.updateIndexInParent(idx); }
-
         inline bool empty()                   const { return m_hierarchy.empty(); }
         inline Hierarchy::size_type size() const { return m_hierarchy.size(); }
+        inline Hierarchy::size_type revision() const { return m_hierarchy.revision(); }
+        inline Hierarchy::size_type childrenRevision() const { return m_hierarchy.childrenRevision(); }
 
         inline const_pointer parent() const { return m_hierarchy.parent() ? static_cast<const_pointer>(m_hierarchy.parent()->data) : nullptr;  }
         inline pointer       parent()       { return m_hierarchy.parent() ? static_cast<pointer>(m_hierarchy.parent()->data)       : nullptr; }
@@ -225,6 +791,80 @@ namespace transform_tree_glm {
 
         inline const_pointer back()   const { return m_hierarchy.back() ? static_cast<const_pointer>(m_hierarchy.back()->data) : nullptr;  }
         inline pointer       back()         { return m_hierarchy.back() ? static_cast<pointer>(m_hierarchy.back()->data)       : nullptr; }
+
+        // cached in the hierarchy, see Hierarchy::depth()
+        inline Hierarchy::size_type depth()       const { return m_hierarchy.depth(); }
+        inline Hierarchy::size_type subtreeSize() const { return m_hierarchy.subtreeSize(); }
+        inline const_pointer root() const { return static_cast<const_pointer>(m_hierarchy.root()->data); }
+        inline pointer       root()       { return static_cast<pointer>(m_hierarchy.root()->data); }
+
+        // O(1) while both nodes are in the tour of the same OrderList, see Hierarchy::isAncestorOf
+        inline bool isAncestorOf(const_pointer other) const { return other && m_hierarchy.isAncestorOf(&other->m_hierarchy); }
+        #pragma endregion
+
+        #pragma region name lookup
+        // Sets name and invalidates the child name map of the parent.
+        // Direct assignments to name are not noticed by findChild() and find().
+        inline void setName(const name_value_type& value)
+        {
+            name = value;
+            m_changeRevision = nextChangeRevision();
+            if (m_hierarchy.parent()) parent()->m_dirtyChildNames = true;
+        }
+
+        // first child with name, O(1) once the child name map is built.
+        // the map is a mutable cache built by the first lookup after the children changed,
+        // so even the const lookups must not run concurrently on the same node.
+        inline const_pointer findChild(std::string_view childName) const
+        {
+            const child_name_map_type& map = childNames();
+            auto it = map.find(childName);
+            return (it != map.end()) ? it->second : nullptr;
+        }
+        inline pointer findChild(std::string_view childName)
+        {
+            return const_cast<pointer>(static_cast<const Transform_*>(this)->findChild(childName));
+        }
+
+        // descends along the '/' separated child names in path, e.g. "base/arm/wrist".
+        // empty segments are skipped, nullptr if a segment is not found.
+        inline const_pointer find(std::string_view path) const
+        {
+            const_pointer node = this;
+            while ((node != nullptr) && !path.empty())
+            {
+                size_t separator = path.find('/');
+                std::string_view segment = path.substr(0, separator);
+                if (!segment.empty()) node = node->findChild(segment);
+                path = (separator == std::string_view::npos) ? std::string_view() : path.substr(separator + 1);
+            }
+            return node;
+        }
+        inline pointer find(std::string_view path)
+        {
+            return const_cast<pointer>(static_cast<const Transform_*>(this)->find(path));
+        }
+
+    protected:
+        inline const child_name_map_type& childNames() const
+        {
+            if (!m_childNames) m_childNames.reset(new child_name_map_type());
+            if (m_dirtyChildNames || (m_childNamesRevision != childrenRevision()))
+            {
+                m_childNames->clear();
+                auto end = cend_children();
+                for (auto it = cbegin_children(); it != end; ++it)
+                {
+                    const_pointer child = static_cast<const_pointer>(it);
+                    m_childNames->emplace(std::string_view(child->name), const_cast<pointer>(child));
+                }
+                m_childNamesRevision = childrenRevision();
+                m_dirtyChildNames = false;
+            }
+            return *m_childNames;
+        }
+
+    public:
         #pragma endregion
 
         #pragma region hierarchy iterators and iterables
@@ -263,11 +903,11 @@ namespace transform_tree_glm {
         template <typename T> inline recurse_data_iterator<T>        end_recurse_data()            { return recurse_data_iterator<T>(end_recurse()); }
 
 
-                              inline const_children_iterator         cbegin_children()       const { return m_hierarchy.cbegin_children_data<Transform_>(); }
-                              inline const_children_iterator         cend_children()         const { return m_hierarchy.cend_children_data<Transform_>(); }
+                              inline const_children_iterator         cbegin_children()       const { return m_hierarchy.cbegin_children_data_as<Transform_>(); }
+                              inline const_children_iterator         cend_children()         const { return m_hierarchy.cend_children_data_as<Transform_>(); }
 
-                              inline const_recurse_iterator          cbegin_recurse()        const { return m_hierarchy.cbegin_recurse_data<Transform_>(); }
-                              inline const_recurse_iterator          cend_recurse()          const { return m_hierarchy.cend_recurse_data<Transform_>(); }
+                              inline const_recurse_iterator          cbegin_recurse()        const { return m_hierarchy.cbegin_recurse_data_as<Transform_>(); }
+                              inline const_recurse_iterator          cend_recurse()          const { return m_hierarchy.cend_recurse_data_as<Transform_>(); }
 
         template <typename T> inline const_children_data_iterator<T> cbegin_children_data()  const { return const_children_data_iterator<T>(cbegin_children()); }
         template <typename T> inline const_children_data_iterator<T> cend_children_data()    const { return const_children_data_iterator<T>(cend_children()); }
@@ -296,10 +936,11 @@ namespace transform_tree_glm {
         template <typename T> using data_visitor       = Hierarchy::Visitor< recurse_data_iterator<T>       >;
         template <typename T> using const_data_visitor = Hierarchy::Visitor< const_recurse_data_iterator<T> >;
         
-                              inline void visit( const typename visitor::CallbackType& cb )                     { m_hierarchy.visit<visitor::iterator, visitor::argument_type>(cb); }
-                              inline void cvisit( const typename const_visitor::CallbackType& cb )              { m_hierarchy.visit<const_visitor::iterator, const_visitor::argument_type>(cb); }
-        template <typename T> inline void visit_data( const typename data_visitor<T>::CallbackType& cb )        { m_hierarchy.visit<data_visitor<T>::iterator, data_visitor<T>::argument_type>(cb); }
-        template <typename T> inline void cvisit_data( const typename const_data_visitor<T>::CallbackType& cb ) { m_hierarchy.visit<const_data_visitor<T>::iterator, const_data_visitor<T>::argument_type>(cb); }
+        // cb can be any callable taking (visitor::Visit&, visitor::argument_type), see Hierarchy::visit
+        template <typename F>             inline void visit( F&& cb )       { m_hierarchy.visit<typename visitor::iterator, typename visitor::argument_type>(std::forward<F>(cb)); }
+        template <typename F>             inline void cvisit( F&& cb )      { m_hierarchy.visit<typename const_visitor::iterator, typename const_visitor::argument_type>(std::forward<F>(cb)); }
+        template <typename T, typename F> inline void visit_data( F&& cb )  { m_hierarchy.visit<typename data_visitor<T>::iterator, typename data_visitor<T>::argument_type>(std::forward<F>(cb)); }
+        template <typename T, typename F> inline void cvisit_data( F&& cb ) { m_hierarchy.visit<typename const_data_visitor<T>::iterator, typename const_data_visitor<T>::argument_type>(std::forward<F>(cb)); }
 
         #pragma endregion
 
@@ -308,7 +949,8 @@ namespace transform_tree_glm {
         // inline bool removeChild(const pointer& child, bool enableSetParent = true) 
         {
             if (child->parent() != this) return false;
-            m_hierarchy.erase_from_parent(*child); 
+            m_hierarchy.unlink(*child);
+            child->invalidateWorldPose();
             return true;
         }
         // { return hierarchy.removeChild(&child->hierarchy, enableSetParent); }
@@ -317,16 +959,80 @@ namespace transform_tree_glm {
         // inline bool addChild(const pointer& child, bool enableSetParent = true, bool avoidDuplicateChild = false) 
         {
             m_hierarchy.push_back(*child);
+            child->invalidateWorldPose();
+            if (m_publishedWorldPose) child->enableConcurrentReads();
         }
         // { return hierarchy.addChild(&child->hierarchy, enableSetParent, avoidDuplicateChild); }
 
         inline void setParent(const pointer& newParent) 
         // inline bool setParent(const pointer& newParent, bool enableRemoveChild = true, bool enableAddChild = true, bool avoidDuplicateChild = false) 
         { 
-            m_hierarchy.push_back_into(*newParent);
+            m_hierarchy.push_back_into(newParent ? static_cast<Hierarchy::pointer>(*newParent) : nullptr);
+            invalidateWorldPose();
+            if (newParent && newParent->m_publishedWorldPose) enableConcurrentReads();
         }
         // { return hierarchy.setParent(&newParent->hierarchy, enableRemoveChild, enableAddChild, avoidDuplicateChild); }
 
+        // Moves the children [first, last) of other before pos, see Hierarchy::splice.
+        // pos == nullptr appends, last == nullptr moves all children of other starting at first.
+        inline void spliceChildren(pointer pos, pointer other, pointer first, pointer last = nullptr)
+        {
+            if (first == last) return;
+            // the range ends before pos after the splice, so invalidate while it still ends at last
+            for (pointer item = first; item != last; item = item->next())
+                item->invalidateWorldPose();
+            m_hierarchy.splice(
+                pos ? static_cast<Hierarchy::pointer>(*pos) : nullptr,
+                *other,
+                *first,
+                last ? static_cast<Hierarchy::pointer>(*last) : nullptr
+            );
+            // the moved range now ends at pos
+            if (m_publishedWorldPose)
+                for (pointer item = first; item != pos; item = item->next())
+                    item->enableConcurrentReads();
+        }
+
+        // Moves each moves[i].first to the end of the children of moves[i].second (nullptr detaches).
+        // With keepWorldPose the world poses of all moved nodes are captured once before relinking
+        // and the inverse world pose of each new parent is computed once, instead of
+        // recomputing both for every node like setParentKeepWorldPose does.
+        // A new parent may lie inside another moved subtree, so the local poses are set in order of
+        // the new depth: the world pose of each new parent is final before it is inverted.
+        static inline void reparent(const std::pair<pointer, pointer>* moves, size_t count, bool keepWorldPose = false)
+        {
+            thread_local std::vector<affine_type> worldPoses;
+            thread_local std::vector<std::pair<Hierarchy::size_type, size_t>> order;
+            if (keepWorldPose)
+            {
+                worldPoses.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                    worldPoses[i] = moves[i].first->worldAffine();
+            }
+            for (size_t i = 0; i < count; ++i)
+                moves[i].first->setParent(moves[i].second);
+            if (!keepWorldPose) return;
+            order.clear();
+            for (size_t i = 0; i < count; ++i)
+                order.emplace_back(moves[i].first->depth(), i);
+            std::sort(order.begin(), order.end());
+            for (const auto& entry : order)
+            {
+                size_t i = entry.second;
+                pointer child = moves[i].first;
+                pointer newParent = child->parent();
+                child->setLocalPose(mat4_type(newParent
+                    ? toMat4(composeAffine(newParent->inverseWorldAffine(), worldPoses[i]))
+                    : toMat4(worldPoses[i])
+                ));
+            }
+        }
+
+        static inline void reparent(const std::vector<std::pair<pointer, pointer>>& moves, bool keepWorldPose = false)
+        {
+            reparent(moves.data(), moves.size(), keepWorldPose);
+        }
+
         // Hierarchy<T> itself provides conversion to arbitrary Hierarchy<U>*
 
         // inline void setParent(const Hierarchy* newParent) 
@@ -340,6 +1046,67 @@ namespace transform_tree_glm {
         // { return hierarchy.setParentKeepWorldPose(&newParent->hierarchy, enableRemoveChild, enableAddChild, avoidDuplicateChild); }
         #pragma endregion
     };
+
+    // pose of source expressed in frame of target, see Transform_::transformTo
+    template<typename name_value_t, typename idx_t, typename pose_t>
+    inline typename Transform_<name_value_t, idx_t, pose_t>::mat4_type lookupTransform(Transform_<name_value_t, idx_t, pose_t>* target, Transform_<name_value_t, idx_t, pose_t>* source)
+    {
+        return source->transformTo(target);
+    }
+
+    // pose of source expressed in frame of target at time, see Transform_::transformToAt
+    template<typename name_value_t, typename idx_t, typename pose_t>
+    inline bool lookupTransform(
+        Transform_<name_value_t, idx_t, pose_t>* target, 
+        Transform_<name_value_t, idx_t, pose_t>* source, 
+        typename Transform_<name_value_t, idx_t, pose_t>::time_type time,
+        typename Transform_<name_value_t, idx_t, pose_t>::mat4_type& result)
+    {
+        return source->transformToAt(target, time, result);
+    }
+
+    // pose of source expressed in frame of target for nodes of different precision, see Transform_::setOrigin
+    template<typename name_value_t, typename idx_t, typename target_pose_t, typename source_pose_t>
+    inline glm::dmat4 lookupTransform(Transform_<name_value_t, idx_t, target_pose_t>* target, Transform_<name_value_t, idx_t, source_pose_t>* source)
+    {
+        return detail::poseAcrossOrigins(source, target);
+    }
+
+    namespace detail {
+
+        template <typename transform_t>
+        inline size_t originDepth(transform_t* node)
+        {
+            size_t depth = 0;
+            for (auto* origin = node->origin(); origin != nullptr; origin = origin->origin()) ++depth;
+            return depth;
+        }
+
+        // the node below more origins goes up to its origin until both are in the same tree,
+        // which then relates them by transformTo. disjoint trees without origins share the root frame.
+        template <typename source_t, typename target_t>
+        inline glm::dmat4 poseAcrossOrigins(source_t* source, target_t* target)
+        {
+            if constexpr (std::is_same<source_t, target_t>::value)
+            {
+                if (source->root() == target->root()) return glm::dmat4(source->transformTo(target));
+            }
+            size_t sourceDepth = originDepth(source);
+            size_t targetDepth = originDepth(target);
+            glm::dmat4 sourceToRoot(source->transformLocalToRoot());
+            if ((sourceDepth == 0) && (targetDepth == 0))
+                return invertAffine(glm::dmat4(target->transformLocalToRoot())) * sourceToRoot;
+            if (sourceDepth >= targetDepth)
+                return poseAcrossOrigins(source->origin(), target) * sourceToRoot;
+            return invertAffine(glm::dmat4(target->transformLocalToRoot())) * poseAcrossOrigins(source, target->origin());
+        }
+
+    } // namespace detail
+
     typedef Transform_<> Transform;
+    typedef Transform_<std::string, int, RigidPose> RigidTransform;
+    typedef Transform_<std::string, int, DPose> DTransform;
+    typedef Transform_<std::string, int, DRigidPose> DRigidTransform;
+    typedef Transform_<Symbol> SymbolTransform;
     
 } // namespace transform_tree_glm
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "transform_tree_glm/hierarchy.h"
+
+namespace transform_tree_glm {
+namespace test {
+
+    // Brute force model of a forest of Hierarchy nodes: the parent and the ordered children of each node.
+    // Nodes are addressed by their slot, destroyed slots hold nullptr until a node is created in them again.
+    // Mutations are applied to the Hierarchy and to the model, matches() compares both.
+    struct HierarchyReference
+    {
+        static constexpr int none = -1;
+
+        std::vector<std::unique_ptr<Hierarchy>> nodes;
+        std::vector<int> parent;
+        std::vector<std::vector<int>> children;
+
+        explicit HierarchyReference(size_t count = 0)
+        {
+            for (size_t i = 0; i < count; ++i) create();
+        }
+
+        #pragma region model queries
+        inline size_t slots() const { return nodes.size(); }
+        inline bool alive(int i) const { return nodes[i] != nullptr; }
+        inline Hierarchy* node(int i) const { return (i == none) ? nullptr : nodes[i].get(); }
+
+        inline int slot(const Hierarchy* item) const
+        {
+            if (item == nullptr) return none;
+            for (size_t i = 0; i < nodes.size(); ++i)
+                if (nodes[i].get() == item) return int(i);
+            return none;
+        }
+
+        inline bool isAncestorOf(int ancestor, int item) const
+        {
+            for (item = parent[item]; item != none; item = parent[item])
+                if (item == ancestor) return true;
+            return false;
+        }
+
+        inline int root(int item) const
+        {
+            while (parent[item] != none) item = parent[item];
+            return item;
+        }
+
+        inline size_t depth(int item) const
+        {
+            size_t result = 0;
+            for (item = parent[item]; item != none; item = parent[item]) ++result;
+            return result;
+        }
+
+        inline void preorder(int item, std::vector<int>& out) const
+        {
+            out.push_back(item);
+            for (int child : children[item]) preorder(child, out);
+        }
+
+        inline std::vector<int> preorder(int item) const
+        {
+            std::vector<int> result;
+            preorder(item, result);
+            return result;
+        }
+
+        inline size_t indexInParent(int item) const
+        {
+            const auto& siblings = children[parent[item]];
+            return size_t(std::find(siblings.begin(), siblings.end(), item) - siblings.begin());
+        }
+        #pragma endregion
+
+        #pragma region mutations of both
+        inline int create()
+        {
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (nodes[i]) continue;
+                nodes[i].reset(new Hierarchy());
+                return int(i);
+            }
+            nodes.emplace_back(new Hierarchy());
+            parent.push_back(none);
+            children.emplace_back();
+            return int(nodes.size() - 1);
+        }
+
+        // destroys the node, its children become roots
+        inline void destroy(int item)
+        {
+            nodes[item].reset();
+            detach(item);
+            for (int child : children[item]) parent[child] = none;
+            children[item].clear();
+        }
+
+        // item before pos in the children of p, pos == none appends
+        inline void insert(int p, int pos, int item)
+        {
+            node(p)->insert(node(pos), node(item));
+            if (item == pos) return;
+            detach(item);
+            attach(p, pos, item);
+        }
+
+        inline void erase(int item)
+        {
+            node(item)->erase_from_parent();
+            detach(item);
+        }
+
+        inline void clear(int p)
+        {
+            node(p)->clear();
+            for (int child : children[p]) parent[child] = none;
+            children[p].clear();
+        }
+
+        // the children [first, last) of other before pos in the children of p, last == none moves all from first on
+        inline void splice(int p, int pos, int other, int first, int last)
+        {
+            node(p)->splice(node(pos), node(other), node(first), node(last));
+            spliceModel(p, pos, other, first, last);
+        }
+        #pragma endregion
+
+        #pragma region mutations of the model only
+        inline void detach(int item)
+        {
+            if (parent[item] == none) return;
+            auto& siblings = children[parent[item]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), item));
+            parent[item] = none;
+        }
+
+        inline void attach(int p, int pos, int item)
+        {
+            auto& siblings = children[p];
+            auto at = (pos == none) ? siblings.end() : std::find(siblings.begin(), siblings.end(), pos);
+            siblings.insert(at, item);
+            parent[item] = p;
+        }
+
+        inline void spliceModel(int p, int pos, int other, int first, int last)
+        {
+            if ((first == last) || (first == pos)) return;
+            auto& from = children[other];
+            auto begin = std::find(from.begin(), from.end(), first);
+            auto end = (last == none) ? from.end() : std::find(from.begin(), from.end(), last);
+            std::vector<int> moved(begin, end);
+            from.erase(begin, end);
+            for (int item : moved) parent[item] = p;
+            auto& to = children[p];
+            auto at = (pos == none) ? to.end() : std::find(to.begin(), to.end(), pos);
+            to.insert(at, moved.begin(), moved.end());
+        }
+        #pragma endregion
+
+        // links, child counts, cached depth, root and subtree size, and the recursion of every live node
+        inline bool matches() const
+        {
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (!alive(int(i))) continue;
+                const Hierarchy* item = nodes[i].get();
+                const auto& kids = children[i];
+                if (item->parent() != node(parent[i])) return false;
+                if ((item->size() != kids.size()) || (item->empty() != kids.empty())) return false;
+                if (item->front() != (kids.empty() ? nullptr : node(kids.front()))) return false;
+                if (item->back() != (kids.empty() ? nullptr : node(kids.back()))) return false;
+                for (size_t k = 0; k < kids.size(); ++k)
+                {
+                    const Hierarchy* child = node(kids[k]);
+                    if (child->prev() != ((k == 0) ? nullptr : node(kids[k - 1]))) return false;
+                    if (child->next() != ((k + 1 == kids.size()) ? nullptr : node(kids[k + 1]))) return false;
+                }
+                std::vector<int> expected = preorder(int(i));
+                if (item->depth() != depth(int(i))) return false;
+                if (item->root() != node(root(int(i)))) return false;
+                if (item->subtreeSize() != expected.size()) return false;
+                size_t k = 0;
+                auto end = item->cend_recurse();
+                for (auto it = item->cbegin_recurse(); it != end; ++it, ++k)
+                {
+                    if ((k >= expected.size()) || (static_cast<const Hierarchy*>(it) != node(expected[k]))) return false;
+                    if (size_t(it.depth()) != depth(expected[k]) - depth(int(i))) return false;
+                }
+                if (k != expected.size()) return false;
+            }
+            return true;
+        }
+
+        // preorder of the subtree of each live node, to tell whose topology a mutation changed
+        inline std::vector<std::vector<int>> subtrees() const
+        {
+            std::vector<std::vector<int>> result(nodes.size());
+            for (size_t i = 0; i < nodes.size(); ++i)
+                if (alive(int(i))) result[i] = preorder(int(i));
+            return result;
+        }
+
+        inline std::vector<size_t> revisions() const
+        {
+            std::vector<size_t> result(nodes.size(), 0);
+            for (size_t i = 0; i < nodes.size(); ++i)
+                if (alive(int(i))) result[i] = nodes[i]->revision();
+            return result;
+        }
+
+        // every live node whose subtree changed between two states got a new revision
+        inline bool revisionsChanged(const std::vector<std::vector<int>>& subtreesBefore, const std::vector<size_t>& revisionsBefore) const
+        {
+            for (size_t i = 0; (i < nodes.size()) && (i < subtreesBefore.size()); ++i)
+            {
+                if (!alive(int(i)) || subtreesBefore[i].empty()) continue;
+                if ((preorder(int(i)) != subtreesBefore[i]) && (nodes[i]->revision() == revisionsBefore[i])) return false;
+            }
+            return true;
+        }
+    };
+
+} // namespace test
+} // namespace transform_tree_glm
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Minimal checks for the test executables.
+// A failed CHECK is reported and counted, main returns test::result() at the end.
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++transform_tree_glm::test::failures(); \
+        } \
+    } while (0)
+
+namespace transform_tree_glm {
+namespace test {
+
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result()
+    {
+        if (failures() > 0) std::fprintf(stderr, "%d checks failed\n", failures());
+        return (failures() > 0) ? 1 : 0;
+    }
+
+    // largest difference of a and b relative to the magnitude of b, at least 1
+    template <glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+    inline T difference(const glm::mat<C, R, T, Q>& a, const glm::mat<C, R, T, Q>& b)
+    {
+        T result = 0;
+        for (glm::length_t c = 0; c < C; ++c)
+            for (glm::length_t r = 0; r < R; ++r)
+                result = std::max(result, std::abs(a[c][r] - b[c][r]) / std::max(T(1), std::abs(b[c][r])));
+        return result;
+    }
+
+    template <glm::length_t L, typename T, glm::qualifier Q>
+    inline T difference(const glm::vec<L, T, Q>& a, const glm::vec<L, T, Q>& b)
+    {
+        T result = 0;
+        for (glm::length_t i = 0; i < L; ++i)
+            result = std::max(result, std::abs(a[i] - b[i]) / std::max(T(1), std::abs(b[i])));
+        return result;
+    }
+
+    template <glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+    inline bool isFinite(const glm::mat<C, R, T, Q>& m)
+    {
+        for (glm::length_t c = 0; c < C; ++c)
+            for (glm::length_t r = 0; r < R; ++r)
+                if (!std::isfinite(m[c][r])) return false;
+        return true;
+    }
+
+    // random inputs, seeded so failures are reproducible
+    struct Random
+    {
+        std::mt19937 engine;
+
+        Random(unsigned seed = 1) : engine(seed) {}
+
+        inline float uniform(float min, float max)
+        {
+            return std::uniform_real_distribution<float>(min, max)(engine);
+        }
+        inline size_t index(size_t count)
+        {
+            return std::uniform_int_distribution<size_t>(0, count - 1)(engine);
+        }
+        inline glm::vec3 position(float range = 10)
+        {
+            return glm::vec3(uniform(-range, range), uniform(-range, range), uniform(-range, range));
+        }
+        inline glm::quat rotation()
+        {
+            glm::vec4 v;
+            do { v = glm::vec4(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-1, 1)); }
+            while (glm::dot(v, v) < 1e-2f);
+            v = glm::normalize(v);
+            return glm::quat(v.w, v.x, v.y, v.z);
+        }
+        // magnitudes in [0.25, 4], each axis negative with probability 1/4
+        inline glm::vec3 scale()
+        {
+            glm::vec3 s;
+            for (int i = 0; i < 3; ++i)
+                s[i] = std::exp2(uniform(-2, 2)) * ((uniform(0, 1) < 0.25f) ? -1.0f : 1.0f);
+            return s;
+        }
+    };
+
+} // namespace test
+} // namespace transform_tree_glm
@@ -0,0 +1,377 @@
+// Compares the affine kernels with the glm results they replace.
+// Built as test_affine (default instruction set), test_affine_scalar (TRANSFORM_TREE_GLM_DISABLE_SIMD)
+// and test_affine_avx2 (-mavx2), so every code path of affine.h is covered.
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "transform_tree_glm/affine.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+using test::difference;
+using test::isFinite;
+
+namespace {
+
+    const float tolerance = 1e-5f;
+    // the inverse divides by the determinant, which loses a few more bits
+    const float inverseTolerance = 1e-4f;
+
+    glm::mat4 referenceTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        return glm::translate(glm::mat4(1), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1), scale);
+    }
+
+    struct Input
+    {
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 scale;
+        // zero scale, the inverse does not exist
+        bool singular;
+    };
+
+    // random poses followed by the degenerate cases
+    std::vector<Input> inputs(test::Random& random, size_t count)
+    {
+        std::vector<Input> result;
+        for (size_t i = 0; i < count; ++i)
+            result.push_back({ random.position(), random.rotation(), random.scale(), false });
+        result.push_back({ glm::vec3(0), glm::quat(1, 0, 0, 0), glm::vec3(1), false });
+        result.push_back({ random.position(), glm::quat(1, 0, 0, 0), glm::vec3(1), false });
+        result.push_back({ random.position(), random.rotation(), glm::vec3(-1), false });
+        result.push_back({ random.position(), random.rotation(), glm::vec3(-2, 1, 3), false });
+        result.push_back({ random.position(), random.rotation(), glm::vec3(0), true });
+        result.push_back({ random.position(), random.rotation(), glm::vec3(1, 0, 1), true });
+        result.push_back({ random.position(1e4f), random.rotation(), glm::vec3(1e-3f, 1e3f, 1), false });
+        return result;
+    }
+
+    void testTRS(const std::vector<Input>& in)
+    {
+        for (const Input& i : in)
+        {
+            glm::mat4 expected = referenceTRS(i.position, i.rotation, i.scale);
+            CHECK(difference(affineFromTRS(i.position, i.rotation, i.scale), expected) <= tolerance);
+            CHECK(difference(toMat4(compactAffineFromTRS(i.position, i.rotation, i.scale)), expected) <= tolerance);
+        }
+    }
+
+    void testCompose(test::Random& random, const std::vector<Input>& in)
+    {
+        for (const Input& i : in)
+        {
+            const Input& j = in[random.index(in.size())];
+            glm::mat4 a = referenceTRS(i.position, i.rotation, i.scale);
+            glm::mat4 b = referenceTRS(j.position, j.rotation, j.scale);
+            glm::mat4 expected = a * b;
+            CHECK(difference(composeAffine(a, b), expected) <= tolerance);
+            CHECK(difference(toMat4(composeAffine(toMat4x3(a), toMat4x3(b))), expected) <= tolerance);
+        }
+    }
+
+    void testInverse(const std::vector<Input>& in)
+    {
+        for (const Input& i : in)
+        {
+            glm::mat4 m = referenceTRS(i.position, i.rotation, i.scale);
+            glm::mat4 expected = glm::affineInverse(m);
+            if (i.singular)
+            {
+                // glm divides by a zero determinant, the kernels must not hide that
+                CHECK(!isFinite(expected));
+                CHECK(!isFinite(invertAffine(m)));
+                CHECK(!isFinite(toMat4(invertAffine(toMat4x3(m)))));
+                continue;
+            }
+            CHECK(difference(invertAffine(m), expected) <= inverseTolerance);
+            CHECK(difference(toMat4(invertAffine(toMat4x3(m))), expected) <= inverseTolerance);
+            if (i.scale == glm::vec3(1))
+            {
+                CHECK(difference(invertRigid(m), expected) <= inverseTolerance);
+                CHECK(difference(toMat4(invertRigid(toMat4x3(m))), expected) <= inverseTolerance);
+            }
+        }
+    }
+
+    // sizes not divisible by 8 or 4 run the wide kernels and the scalar tail
+    void testBatch(test::Random& random, const std::vector<Input>& in)
+    {
+        size_t count = in.size();
+        std::vector<float> px(count), py(count), pz(count), qx(count), qy(count), qz(count), qw(count), sx(count), sy(count), sz(count);
+        for (size_t k = 0; k < count; ++k)
+        {
+            px[k] = in[k].position.x; py[k] = in[k].position.y; pz[k] = in[k].position.z;
+            qx[k] = in[k].rotation.x; qy[k] = in[k].rotation.y; qz[k] = in[k].rotation.z; qw[k] = in[k].rotation.w;
+            sx[k] = in[k].scale.x;    sy[k] = in[k].scale.y;    sz[k] = in[k].scale.z;
+        }
+        SoATRS soa = { px.data(), py.data(), pz.data(), qx.data(), qy.data(), qz.data(), qw.data(), sx.data(), sy.data(), sz.data() };
+        for (size_t n : { count, count - 1, size_t(13), size_t(8), size_t(5), size_t(3), size_t(0) })
+        {
+            std::vector<glm::mat4> out(n + 1, glm::mat4(7));
+            affineFromTRS(soa, n, out.data());
+            for (size_t k = 0; k < n; ++k)
+                CHECK(difference(out[k], referenceTRS(in[k].position, in[k].rotation, in[k].scale)) <= tolerance);
+            // nothing written past the end
+            CHECK(out[n] == glm::mat4(7));
+        }
+
+        std::vector<glm::mat4> a(count), b(count), composed(count), inverted(count);
+        for (size_t k = 0; k < count; ++k)
+        {
+            const Input& j = in[random.index(count)];
+            a[k] = referenceTRS(in[k].position, in[k].rotation, in[k].scale);
+            b[k] = referenceTRS(j.position, j.rotation, j.scale);
+        }
+        composeAffine(a.data(), b.data(), count, composed.data());
+        invertAffine(a.data(), count, inverted.data());
+        for (size_t k = 0; k < count; ++k)
+        {
+            CHECK(difference(composed[k], a[k] * b[k]) <= tolerance);
+            if (!in[k].singular) CHECK(difference(inverted[k], glm::affineInverse(a[k])) <= inverseTolerance);
+        }
+    }
+
+    // structure-of-arrays copy of matrices, one array per element of the upper 3 rows
+    struct SoAMatrices
+    {
+        std::vector<float> elements[4][3];
+
+        SoAMatrices(const std::vector<glm::mat4>& in)
+        {
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    for (const glm::mat4& m : in) elements[col][row].push_back(m[col][row]);
+        }
+
+        SoAAffine arrays()
+        {
+            SoAAffine result;
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    result.m[col][row] = elements[col][row].data();
+            return result;
+        }
+
+        glm::mat4 operator[](size_t k) const
+        {
+            glm::mat4 result(1);
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 3; ++row)
+                    result[col][row] = elements[col][row][k];
+            return result;
+        }
+    };
+
+    // the lanes of the structure-of-arrays kernels must agree with the single matrix kernels and glm
+    void testSoABatch(test::Random& random, const std::vector<Input>& in)
+    {
+        size_t count = in.size();
+        std::vector<glm::mat4> a(count), b(count);
+        for (size_t k = 0; k < count; ++k)
+        {
+            const Input& j = in[random.index(count)];
+            a[k] = referenceTRS(in[k].position, in[k].rotation, in[k].scale);
+            b[k] = referenceTRS(j.position, j.rotation, j.scale);
+        }
+        SoAMatrices sa(a), sb(b);
+        for (size_t n : { count, count - 1, size_t(13), size_t(8), size_t(5), size_t(3), size_t(0) })
+        {
+            SoAMatrices composed(std::vector<glm::mat4>(count, glm::mat4(7)));
+            SoAMatrices inverted(std::vector<glm::mat4>(count, glm::mat4(7)));
+            composeAffine(sa.arrays(), sb.arrays(), n, composed.arrays());
+            invertAffine(sa.arrays(), n, inverted.arrays());
+            for (size_t k = 0; k < n; ++k)
+            {
+                CHECK(difference(composed[k], composeAffine(a[k], b[k])) <= tolerance);
+                CHECK(difference(composed[k], a[k] * b[k]) <= tolerance);
+                if (in[k].singular)
+                {
+                    CHECK(!isFinite(inverted[k]));
+                    continue;
+                }
+                CHECK(difference(inverted[k], invertAffine(a[k])) <= inverseTolerance);
+                CHECK(difference(inverted[k], glm::affineInverse(a[k])) <= inverseTolerance);
+            }
+            // nothing written past the end
+            glm::mat4 untouched = SoAMatrices(std::vector<glm::mat4>(1, glm::mat4(7)))[0];
+            for (size_t k = n; k < count; ++k)
+                CHECK((composed[k] == untouched) && (inverted[k] == untouched));
+        }
+
+        // in place, a = a * b and then b = inverse(b)
+        SoAMatrices inPlaceA(a), inPlaceB(b);
+        composeAffine(inPlaceA.arrays(), inPlaceB.arrays(), count, inPlaceA.arrays());
+        invertAffine(inPlaceB.arrays(), count, inPlaceB.arrays());
+        for (size_t k = 0; k < count; ++k)
+        {
+            CHECK(difference(inPlaceA[k], a[k] * b[k]) <= tolerance);
+            if (!isFinite(glm::affineInverse(b[k]))) continue;
+            CHECK(difference(inPlaceB[k], glm::affineInverse(b[k])) <= inverseTolerance);
+        }
+    }
+
+    // the double overloads are plain templates, they must agree with glm as well
+    void testDouble(test::Random& random)
+    {
+        for (int k = 0; k < 100; ++k)
+        {
+            glm::dvec3 position(random.position());
+            glm::dquat rotation(random.rotation());
+            glm::dvec3 scale(random.scale());
+            glm::dmat4 m = affineFromTRS(position, rotation, scale);
+            glm::dmat4 expected = glm::translate(glm::dmat4(1), position) * glm::mat4_cast(rotation) * glm::scale(glm::dmat4(1), scale);
+            CHECK(difference(m, expected) <= 1e-12);
+            CHECK(difference(composeAffine(m, expected), m * expected) <= 1e-12);
+            CHECK(difference(invertAffine(m), glm::affineInverse(m)) <= 1e-12);
+        }
+    }
+
+    // glm::decompose for reference. the quaternions of both may differ in sign, so the results are compared recomposed.
+    // glm refuses matrices with a determinant within epsilon of zero, decomposeAffine does not.
+    bool referenceDecompose(const glm::mat4& m, glm::mat4& recomposed)
+    {
+        glm::vec3 scale, position, skew;
+        glm::quat rotation;
+        glm::vec4 perspective;
+        if (!glm::decompose(m, scale, rotation, position, skew, perspective)) return false;
+        recomposed = referenceTRS(position, rotation, scale);
+        return true;
+    }
+
+    // decomposeAffine recomposes to its input and agrees with glm::decompose, for mirrored
+    // and near-singular scales as well. singular, skewed and projective matrices are left to glm.
+    void testDecompose(test::Random& random, const std::vector<Input>& in)
+    {
+        std::vector<Input> poses = in;
+        for (float tiny : { 1e-2f, 1e-4f, 1e-6f })
+        {
+            poses.push_back({ random.position(), random.rotation(), glm::vec3(tiny, 1, 1), false });
+            poses.push_back({ random.position(), random.rotation(), glm::vec3(-1, tiny, 2), false });
+            poses.push_back({ random.position(), random.rotation(), glm::vec3(tiny, -tiny, tiny), false });
+        }
+        for (const Input& i : poses)
+        {
+            glm::mat4 m = referenceTRS(i.position, i.rotation, i.scale);
+            glm::vec3 position, scale;
+            glm::quat rotation;
+            if (i.singular)
+            {
+                CHECK(!decomposeAffine(m, position, rotation, scale));
+                continue;
+            }
+            CHECK(decomposeAffine(m, position, rotation, scale));
+            CHECK(std::abs(glm::length(rotation) - 1) <= tolerance);
+            // mirroring always negates all three axes, like glm::decompose
+            float sign = (i.scale.x * i.scale.y * i.scale.z < 0) ? -1.0f : 1.0f;
+            CHECK(difference(scale, sign * glm::abs(i.scale)) <= tolerance);
+            CHECK(difference(referenceTRS(position, rotation, scale), m) <= inverseTolerance);
+            glm::mat4 reference;
+            if (referenceDecompose(m, reference)) CHECK(difference(referenceTRS(position, rotation, scale), reference) <= inverseTolerance);
+            else CHECK(std::abs(glm::determinant(glm::mat3(m))) < 1e-6f);
+
+            glm::vec3 position2, scale2;
+            glm::quat rotation2;
+            CHECK(decompose(m, position2, rotation2, scale2));
+            CHECK((position2 == position) && (rotation2 == rotation) && (scale2 == scale));
+
+            glm::dvec3 dposition, dscale;
+            glm::dquat drotation;
+            CHECK(decomposeAffine(glm::dmat4(m), dposition, drotation, dscale));
+            CHECK(difference(glm::mat4(referenceTRS(glm::vec3(dposition), glm::quat(drotation), glm::vec3(dscale))), m) <= inverseTolerance);
+        }
+
+        // a little noise off orthogonal is tolerated, the rotation is still orthonormal
+        for (int k = 0; k < 100; ++k)
+        {
+            glm::vec3 s = random.scale();
+            glm::mat4 m = referenceTRS(random.position(), random.rotation(), s);
+            // columns 5e-5 off orthogonal, half the tolerance of decomposeAffine
+            m[1] += (5e-5f * s.y / s.x) * m[0];
+            glm::vec3 position, scale;
+            glm::quat rotation;
+            CHECK(decomposeAffine(m, position, rotation, scale));
+            CHECK(std::abs(glm::length(rotation) - 1) <= tolerance);
+            glm::mat3 r = glm::mat3_cast(rotation);
+            CHECK(difference(glm::transpose(r) * r, glm::mat3(1)) <= tolerance);
+            CHECK(difference(referenceTRS(position, rotation, scale), m) <= 1e-3f);
+        }
+
+        // skew and perspective make decomposeAffine fail, decompose falls back to glm::decompose
+        for (int k = 0; k < 100; ++k)
+        {
+            glm::mat4 m = referenceTRS(random.position(), random.rotation(), random.scale());
+            if (k % 2) m[1] += 0.5f * m[0];
+            else m[0][3] = 0.25f;
+            glm::vec3 position, scale, skew, referencePosition, referenceScale;
+            glm::quat rotation, referenceRotation;
+            glm::vec4 perspective;
+            CHECK(!decomposeAffine(m, position, rotation, scale));
+            bool decomposed = glm::decompose(m, referenceScale, referenceRotation, referencePosition, skew, perspective);
+            CHECK(decompose(m, position, rotation, scale) == decomposed);
+            CHECK(!decomposed || ((position == referencePosition) && (rotation == referenceRotation) && (scale == referenceScale)));
+        }
+
+        // the batch counts the matrices it could not decompose and leaves their outputs untouched
+        std::vector<glm::mat4> matrices;
+        for (const Input& i : in) matrices.push_back(referenceTRS(i.position, i.rotation, i.scale));
+        matrices.push_back(glm::mat4(0));
+        size_t count = matrices.size();
+        size_t singular = 1;
+        for (const Input& i : in) singular += i.singular ? 1 : 0;
+        std::vector<glm::vec3> positions(count, glm::vec3(7)), scales(count, glm::vec3(7));
+        std::vector<glm::quat> rotations(count, glm::quat(7, 7, 7, 7));
+        CHECK(decompose(matrices.data(), count, positions.data(), rotations.data(), scales.data()) == singular);
+        CHECK((positions.back() == glm::vec3(7)) && (scales.back() == glm::vec3(7)));
+        for (size_t k = 0; k < in.size(); ++k)
+            if (!in[k].singular) CHECK(difference(referenceTRS(positions[k], rotations[k], scales[k]), matrices[k]) <= inverseTolerance);
+    }
+
+    // worldPose() of a chain composes the local poses with the kernels above
+    void testWorldPose(test::Random& random)
+    {
+        std::vector<std::unique_ptr<Transform>> chain;
+        glm::mat4 expected(1);
+        for (int k = 0; k < 8; ++k)
+        {
+            glm::vec3 position = random.position();
+            glm::quat rotation = random.rotation();
+            glm::vec3 scale = random.scale();
+            Transform* parent = chain.empty() ? nullptr : chain.back().get();
+            chain.emplace_back(new Transform(parent, Pose(position, rotation, scale)));
+            expected = expected * referenceTRS(position, rotation, scale);
+            CHECK(difference(chain.back()->worldPose(), expected) <= inverseTolerance);
+            CHECK(difference(chain.back()->inverseWorldPose(), glm::affineInverse(expected)) <= 1e-3f);
+        }
+    }
+
+} // namespace
+
+int main()
+{
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        std::printf("skipped, the CPU has no AVX2\n");
+        return 77;
+    }
+#endif
+    test::Random random(4);
+    std::vector<Input> in = inputs(random, 1000);
+    testTRS(in);
+    testCompose(random, in);
+    testInverse(in);
+    testBatch(random, in);
+    testSoABatch(random, in);
+    testDouble(random);
+    testDecompose(random, in);
+    testWorldPose(random);
+    return test::result();
+}
@@ -0,0 +1,218 @@
+// Stress test of SeqLockBuffer_ and the concurrent world pose reads of Transform_:
+// one writer thread stores poses while several reader threads load them.
+// Every loaded pose must be one the writer stored, never a mix of two stores, and
+// a reader must never see an older pose after a newer one.
+// Nodes attached after publishing was enabled can be read as well.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "transform_tree_glm/concurrent.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    const size_t stores = 200000;
+    const size_t readerCount = 6;
+    const size_t tableSize = 61;
+
+    // pose number k is table[k % tableSize] tagged with k in the last row, which affine poses do not use
+    glm::mat4 tagged(const std::vector<glm::mat4>& table, size_t k)
+    {
+        glm::mat4 m = table[k % table.size()];
+        m[0][3] = float(k);
+        return m;
+    }
+
+    void testSeqLockBuffer(test::Random& random)
+    {
+        std::vector<glm::mat4> table;
+        for (size_t i = 0; i < tableSize; ++i)
+            table.push_back(glm::translate(glm::mat4(1), random.position()) * glm::mat4_cast(random.rotation()) * glm::scale(glm::mat4(1), random.scale()));
+
+        SeqLockBuffer_<glm::mat4> buffer(tagged(table, 0));
+        std::atomic<bool> done(false);
+        std::atomic<size_t> torn(0), stale(0), reads(0);
+
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < readerCount; ++r)
+        {
+            readers.emplace_back([&]() {
+                size_t last = 0;
+                size_t count = 0;
+                while (!done.load(std::memory_order_acquire))
+                {
+                    glm::mat4 m = buffer.load();
+                    size_t k = size_t(m[0][3]);
+                    if ((float(k) != m[0][3]) || (k > stores) || (m != tagged(table, k))) ++torn;
+                    else if (k < last) ++stale;
+                    else last = k;
+                    ++count;
+                }
+                reads += count;
+            });
+        }
+
+        for (size_t k = 1; k <= stores; ++k)
+        {
+            buffer.store(tagged(table, k));
+            // give the readers a chance to run on machines with few cores
+            if ((k & 1023) == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& reader : readers) reader.join();
+
+        CHECK(torn == 0);
+        CHECK(stale == 0);
+        CHECK(reads > 0);
+        CHECK(buffer.version() == stores);
+        CHECK(buffer.load() == tagged(table, stores));
+    }
+
+    // the writer moves the root, readers check the published world positions of the subtree
+    void testPublishedWorldPoses()
+    {
+        Transform root;
+        Transform child(&root);
+        Transform grandchild(&child);
+        Transform sibling(&root);
+        root.enableConcurrentReads();
+        CHECK(grandchild.hasConcurrentReads());
+
+        const size_t publishes = 50000;
+        std::atomic<bool> done(false);
+        std::atomic<size_t> torn(0), stale(0);
+
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < readerCount; ++r)
+        {
+            readers.emplace_back([&, r]() {
+                const Transform* nodes[] = { &root, &child, &grandchild, &sibling };
+                const Transform& node = *nodes[r % 4];
+                float last = 0;
+                while (!done.load(std::memory_order_acquire))
+                {
+                    // root at (k, 2k, 3k), the other nodes have identity local poses
+                    glm::vec3 p = node.readWorldPosition();
+                    if ((p.y != 2 * p.x) || (p.z != 3 * p.x) || (p.x > float(publishes))) ++torn;
+                    else if (p.x < last) ++stale;
+                    else last = p.x;
+                }
+            });
+        }
+
+        for (size_t k = 1; k <= publishes; ++k)
+        {
+            float x = float(k);
+            root.setLocalPosition(glm::vec3(x, 2 * x, 3 * x));
+            root.publishWorldPoses();
+            if ((k & 255) == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& reader : readers) reader.join();
+
+        CHECK(torn == 0);
+        CHECK(stale == 0);
+        CHECK(grandchild.readWorldPosition() == glm::vec3(publishes, 2 * publishes, 3 * publishes));
+    }
+
+    // nodes attached after enableConcurrentReads() get buffers as well, holding their world pose
+    // at the time they were attached until the next publish
+    void testLateChildren()
+    {
+        Transform root(nullptr, Pose(glm::vec3(1, 2, 3), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+        root.enableConcurrentReads();
+        glm::vec3 offset(0, 0, 10);
+        Transform constructed(&root, Pose(offset, glm::quat(1, 0, 0, 0), glm::vec3(1)));
+        Transform added;
+        root.addChild(&added);
+        Transform moved;
+        Transform movedChild(&moved);
+        moved.setParent(&constructed);
+        // a subtree from a tree without publishing
+        Transform other;
+        Transform spliced(&other, Pose(offset, glm::quat(1, 0, 0, 0), glm::vec3(1)));
+        Transform splicedChild(&spliced);
+        Transform kept(&other);
+        root.spliceChildren(&added, &other, &spliced, &kept);
+        Transform reparented;
+        Transform::reparent({ { &reparented, &added } });
+
+        for (const Transform* node : { &constructed, &added, &moved, &movedChild, &spliced, &splicedChild, &reparented })
+            CHECK(node->hasConcurrentReads());
+        CHECK(!other.hasConcurrentReads() && !kept.hasConcurrentReads());
+        CHECK(constructed.readWorldPosition() == glm::vec3(1, 2, 13));
+        CHECK(movedChild.readWorldPosition() == glm::vec3(1, 2, 13));
+        CHECK(splicedChild.readWorldPosition() == glm::vec3(1, 2, 13));
+        CHECK(reparented.readWorldPosition() == glm::vec3(1, 2, 3));
+
+        root.setLocalPosition(glm::vec3(4, 5, 6));
+        CHECK(movedChild.readWorldPosition() == glm::vec3(1, 2, 13));
+        root.publishWorldPoses();
+        CHECK(movedChild.readWorldPosition() == glm::vec3(4, 5, 16));
+        CHECK(reparented.readWorldPosition() == glm::vec3(4, 5, 6));
+
+        // attaching below a node without publishing adds no buffer
+        Transform plain;
+        Transform plainChild(&plain);
+        CHECK(!plainChild.hasConcurrentReads());
+    }
+
+    // the writer keeps attaching new leaves and hands them to the readers after publishing
+    void testGrowingTree()
+    {
+        const size_t leaves = 2000;
+        Transform root;
+        root.enableConcurrentReads();
+        std::vector<std::unique_ptr<Transform>> nodes(leaves);
+        std::atomic<size_t> published(0);
+        std::atomic<size_t> wrong(0);
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < readerCount; ++r)
+        {
+            readers.emplace_back([&]() {
+                while (published.load(std::memory_order_acquire) < leaves)
+                {
+                    size_t count = published.load(std::memory_order_acquire);
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        // leaf i sits at x = i below a root at y = k, for some k of a later publish
+                        glm::vec3 p = nodes[i]->readWorldPosition();
+                        if ((p.x != float(i)) || (p.y < float(i))) ++wrong;
+                    }
+                }
+            });
+        }
+        for (size_t i = 0; i < leaves; ++i)
+        {
+            nodes[i].reset(new Transform(&root, Pose(glm::vec3(float(i), 0, 0), glm::quat(1, 0, 0, 0), glm::vec3(1))));
+            root.setLocalPosition(glm::vec3(0, float(i), 0));
+            root.publishWorldPoses();
+            published.store(i + 1, std::memory_order_release);
+        }
+        for (auto& reader : readers) reader.join();
+        CHECK(wrong == 0);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(13);
+    testSeqLockBuffer(random);
+    testPublishedWorldPoses();
+    testLateChildren();
+    testGrowingTree();
+    return test::result();
+}
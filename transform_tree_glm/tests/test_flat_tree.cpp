@@ -0,0 +1,163 @@
+// FlatTree_ patched by update() after random mutations, against a FlatTree_ linearized from scratch:
+// nodes, parents and the internal subtree ranges and revisions must be the same, and so must the world poses.
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform_tree_glm/flat_tree.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    // exposes the arrays rebuild() patches from
+    struct InspectFlatTree : public FlatTree
+    {
+        using FlatTree::FlatTree;
+        const std::vector<index_type>& ends() const { return m_ends; }
+        const std::vector<Hierarchy::size_type>& revisions() const { return m_revisions; }
+    };
+
+    struct Tree
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+
+        Transform* randomNode(test::Random& random)
+        {
+            std::unique_ptr<Transform>& node = nodes[random.index(nodes.size())];
+            return node ? node.get() : &root;
+        }
+    };
+
+    // product of the local poses up to the root
+    glm::mat4 referenceWorldPose(Transform* node)
+    {
+        glm::mat4 result(1);
+        for (; node != nullptr; node = node->parent())
+            result = glm::mat4(node->localPose()) * result;
+        return result;
+    }
+
+    bool matches(InspectFlatTree& flat)
+    {
+        InspectFlatTree fresh(flat.root());
+        fresh.rebuild();
+        if (flat.isStale()) return false;
+        if ((flat.nodes() != fresh.nodes()) || (flat.parents() != fresh.parents())) return false;
+        if ((flat.ends() != fresh.ends()) || (flat.revisions() != fresh.revisions())) return false;
+        // parent before child, preorder of the subtree
+        size_t k = 0;
+        for (auto& node : flat.root()->recurse())
+            if ((k >= flat.size()) || (flat.nodes()[k++] != &node)) return false;
+        if (k != flat.size()) return false;
+        for (size_t i = 0; i < flat.size(); ++i)
+        {
+            if (test::difference(glm::mat4(toMat4(flat.worldPoses()[i])), referenceWorldPose(flat.nodes()[i])) > 1e-3f) return false;
+            if (flat.nodes()[i]->isWorldPoseDirty()) return false;
+        }
+        return true;
+    }
+
+    void testRandom(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            Tree tree;
+            for (int i = 0; i < 40; ++i)
+            {
+                Transform* parent = tree.nodes.empty() ? &tree.root : tree.randomNode(random);
+                tree.nodes.emplace_back(new Transform(parent, Pose(random.position(), random.rotation(), glm::vec3(1))));
+            }
+            InspectFlatTree flat(&tree.root);
+            flat.update();
+            CHECK(matches(flat));
+            for (int step = 0; step < 200; ++step)
+            {
+                // several mutations between updates, so more than one subtree is patched at once
+                size_t mutations = 1 + random.index(3);
+                for (size_t m = 0; m < mutations; ++m)
+                {
+                    std::unique_ptr<Transform>& slot = tree.nodes[random.index(tree.nodes.size())];
+                    Transform* other = tree.randomNode(random);
+                    size_t action = random.index(8);
+                    if (!slot)
+                    {
+                        slot.reset(new Transform(other, Pose(random.position(), random.rotation(), glm::vec3(1))));
+                        continue;
+                    }
+                    Transform* node = slot.get();
+                    if (action < 3)
+                    {
+                        // nullptr takes the subtree out of the flat tree until it is moved back
+                        if ((other == node) || node->isAncestorOf(other)) continue;
+                        node->setParent((random.index(6) == 0) ? nullptr : other);
+                    }
+                    else if (action < 5)
+                    {
+                        if (node->empty() || (other == node) || node->isAncestorOf(other)) continue;
+                        Transform* first = node->front();
+                        for (size_t k = random.index(node->size()); k > 0; --k) first = first->next();
+                        Transform* pos = other->empty() || (random.index(3) == 0) ? nullptr : other->front();
+                        other->spliceChildren(pos, node, first);
+                    }
+                    else if (action == 5) node->setLocalPose(random.position(), random.rotation());
+                    else if (action == 6) slot.reset();
+                    else if (!node->empty()) node->removeChild(node->back());
+                }
+                flat.update();
+                CHECK(matches(flat));
+            }
+
+            // an interior root, then the whole tree again
+            Transform* node = tree.randomNode(random);
+            flat.setRoot(node);
+            flat.update();
+            CHECK(matches(flat));
+            flat.setRoot(&tree.root);
+            flat.update();
+            CHECK(matches(flat));
+        }
+    }
+
+    // an update without changes keeps the arrays, local poses changed in between are picked up
+    void testUnchanged(test::Random& random)
+    {
+        Tree tree;
+        for (int i = 0; i < 100; ++i)
+            tree.nodes.emplace_back(new Transform(tree.nodes.empty() ? &tree.root : tree.randomNode(random)));
+        InspectFlatTree flat(&tree.root);
+        flat.update();
+        std::vector<Transform*> nodes = flat.nodes();
+        CHECK(!flat.isStale());
+        tree.nodes[17]->setLocalPosition(glm::vec3(1, 2, 3));
+        CHECK(!flat.isStale());
+        flat.update();
+        CHECK(flat.nodes() == nodes);
+        CHECK(matches(flat));
+
+        // an empty tree and a single node
+        FlatTree empty;
+        empty.update();
+        CHECK(empty.empty());
+        Transform single;
+        InspectFlatTree one(&single);
+        one.update();
+        CHECK(one.size() == 1);
+        CHECK(matches(one));
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(3);
+    testRandom(random);
+    testUnchanged(random);
+    return test::result();
+}
@@ -0,0 +1,464 @@
+// Hierarchy and the Transform_ tree operations built on it, against the brute force model of hierarchy_reference.h.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "transform_tree_glm/flat_tree.h"
+#include "transform_tree_glm/hierarchy.h"
+#include "transform_tree_glm/transform.h"
+
+#include "hierarchy_reference.h"
+#include "test.h"
+
+using namespace transform_tree_glm;
+using test::HierarchyReference;
+
+namespace {
+
+    const int none = HierarchyReference::none;
+
+    // random forest, each node under a random earlier one or a root
+    void randomForest(test::Random& random, HierarchyReference& ref, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            int item = ref.create();
+            if ((item > 0) && (random.index(5) != 0))
+                ref.insert(int(random.index(size_t(item))), none, item);
+        }
+    }
+
+    #pragma region splice
+    void testSpliceCases()
+    {
+        // 0 has children 1..5, 6 has children 7, 8, 9 is a separate root with child 10
+        HierarchyReference ref(11);
+        for (int i = 1; i <= 5; ++i) ref.insert(0, none, i);
+        ref.insert(6, none, 7);
+        ref.insert(6, none, 8);
+        ref.insert(0, 3, 6);
+        ref.insert(9, none, 10);
+        CHECK(ref.matches());
+
+        // within one parent, backwards and forwards
+        ref.splice(0, 1, 0, 4, 5);
+        CHECK(ref.matches());
+        ref.splice(0, none, 0, 1, 6);
+        CHECK(ref.matches());
+        // first == pos and an empty range change nothing
+        auto before = ref.subtrees();
+        ref.splice(0, 2, 0, 2, none);
+        ref.splice(0, none, 0, 2, 2);
+        CHECK(ref.subtrees() == before);
+        CHECK(ref.matches());
+        // one level deeper, with a subtree
+        ref.splice(4, none, 0, 6, 3);
+        CHECK(ref.matches());
+        CHECK(ref.node(8)->depth() == 3);
+        // into another tree, roots and depths of the moved subtrees change
+        ref.splice(10, none, 0, ref.children[0].front(), none);
+        CHECK(ref.matches());
+        CHECK(ref.node(0)->empty());
+        CHECK(ref.node(8)->root() == ref.node(9));
+        // all children of another node at the front
+        ref.splice(0, none, 10, ref.children[10].front(), none);
+        ref.spliceModel(0, ref.children[0].front(), 6, ref.children[6].front(), none);
+        ref.node(0)->splice(ref.node(0)->front(), ref.node(6));
+        CHECK(ref.node(6)->empty());
+        CHECK(ref.matches());
+
+        // the overload taking back and count
+        int back = ref.children[0][2];
+        ref.node(9)->splice(nullptr, ref.node(0), ref.node(ref.children[0][0]), ref.node(back), 3);
+        ref.spliceModel(9, none, 0, ref.children[0][0], ref.indexInParent(back) + 1 < ref.children[0].size() ? ref.children[0][ref.indexInParent(back) + 1] : none);
+        CHECK(ref.matches());
+    }
+
+    void testRandomSplice(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            HierarchyReference ref;
+            randomForest(random, ref, 40);
+            for (int step = 0; step < 200; ++step)
+            {
+                int other = int(random.index(ref.slots()));
+                const auto& from = ref.children[other];
+                if (from.empty()) continue;
+                size_t i = random.index(from.size());
+                size_t j = i + 1 + random.index(from.size() - i);
+                int first = from[i];
+                int last = (j == from.size()) ? none : from[j];
+                std::vector<int> moved(from.begin() + i, from.begin() + j);
+
+                int p = int(random.index(ref.slots()));
+                bool valid = true;
+                for (int item : moved)
+                    if ((item == p) || ref.isAncestorOf(item, p)) valid = false;
+                if (!valid) continue;
+                const auto& to = ref.children[p];
+                int pos = (to.empty() || (random.index(4) == 0)) ? none : to[random.index(to.size())];
+                if ((p == other) && (pos != none) && (ref.indexInParent(pos) >= i) && (ref.indexInParent(pos) < j)) continue;
+
+                auto subtrees = ref.subtrees();
+                auto revisions = ref.revisions();
+                ref.splice(p, pos, other, first, last);
+                CHECK(ref.matches());
+                CHECK(ref.revisionsChanged(subtrees, revisions));
+            }
+        }
+    }
+    #pragma endregion
+
+    #pragma region Transform_ splice and reparent
+    struct Tree
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+    };
+
+    // non-uniform scales under rotated parents give world poses with skew, which no local TRS pose reproduces
+    void randomTree(test::Random& random, Tree& tree, size_t count, bool uniformScale = false)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Transform* parent = (tree.nodes.empty() || (random.index(4) == 0)) ? &tree.root : tree.nodes[random.index(tree.nodes.size())].get();
+            glm::vec3 scale = uniformScale ? glm::vec3(random.uniform(0.5f, 2)) : random.scale();
+            tree.nodes.emplace_back(new Transform(parent, Pose(random.position(), random.rotation(), scale)));
+        }
+    }
+
+    // product of the local poses up to the root
+    glm::mat4 referenceWorldPose(Transform* node)
+    {
+        glm::mat4 result(1);
+        for (; node != nullptr; node = node->parent())
+            result = glm::mat4(node->localPose()) * result;
+        return result;
+    }
+
+    bool worldPosesMatch(Tree& tree)
+    {
+        for (auto& node : tree.nodes)
+            if (test::difference(node->worldPose(), referenceWorldPose(node.get())) > 1e-3f) return false;
+        return true;
+    }
+
+    void testSpliceChildren(test::Random& random)
+    {
+        for (int run = 0; run < 50; ++run)
+        {
+            Tree tree;
+            randomTree(random, tree, 30);
+            CHECK(worldPosesMatch(tree));
+            Transform* other = tree.nodes[random.index(tree.nodes.size())].get();
+            Transform* target = tree.nodes[random.index(tree.nodes.size())].get();
+            if (other->empty() || (target == other) || other->isAncestorOf(target)) continue;
+            // world poses are cached before, the moved subtrees must be recomputed after
+            size_t count = other->size();
+            Transform* first = other->front();
+            target->spliceChildren(nullptr, other, first);
+            CHECK(other->empty());
+            CHECK(target->size() >= count);
+            CHECK(worldPosesMatch(tree));
+        }
+    }
+
+    void testReparent(test::Random& random)
+    {
+        for (bool keepWorldPose : { false, true })
+        {
+            for (int run = 0; run < 50; ++run)
+            {
+                Tree tree;
+                randomTree(random, tree, 30, keepWorldPose);
+                std::vector<std::pair<Transform*, Transform*>> moves;
+                std::vector<glm::mat4> worldBefore, localBefore;
+                // parents after the moves so far, to reject moves which would create a cycle when they are applied
+                std::map<Transform*, Transform*> parents;
+                for (auto& node : tree.nodes) parents[node.get()] = node->parent();
+                for (int m = 0; m < 5; ++m)
+                {
+                    Transform* child = tree.nodes[random.index(tree.nodes.size())].get();
+                    Transform* parent = (random.index(5) == 0) ? nullptr : tree.nodes[random.index(tree.nodes.size())].get();
+                    // new parents may lie inside moved subtrees and moved nodes may be new parents,
+                    // but each node moves once and never below itself
+                    bool valid = true;
+                    for (Transform* node = parent; node != nullptr; node = parents[node])
+                        if (node == child) valid = false;
+                    for (auto& move : moves)
+                        if (move.first == child) valid = false;
+                    if (!valid) continue;
+                    parents[child] = parent;
+                    moves.emplace_back(child, parent);
+                    worldBefore.push_back(child->worldPose());
+                    localBefore.push_back(child->localPose());
+                }
+                Transform::reparent(moves, keepWorldPose);
+                for (size_t m = 0; m < moves.size(); ++m)
+                {
+                    CHECK(moves[m].first->parent() == moves[m].second);
+                    if (keepWorldPose) CHECK(test::difference(moves[m].first->worldPose(), worldBefore[m]) <= 1e-3f);
+                    else CHECK(moves[m].first->localPose() == localBefore[m]);
+                }
+                CHECK(worldPosesMatch(tree));
+            }
+        }
+
+        // root -> { x, a -> b, c }: c moves below b while a moves below x, in both orders
+        for (bool cFirst : { true, false })
+        {
+            Transform root;
+            Transform x(&root, Pose(glm::vec3(100, 0, 0), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+            Transform a(&root, Pose(glm::vec3(1, 0, 0), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+            Transform b(&a, Pose(glm::vec3(0, 1, 0), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+            Transform c(&root, Pose(glm::vec3(0, 0, 5), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+            std::vector<std::pair<Transform*, Transform*>> moves = { { &c, &b }, { &a, &x } };
+            if (!cFirst) std::swap(moves[0], moves[1]);
+            Transform::reparent(moves, true);
+            CHECK((c.parent() == &b) && (a.parent() == &x));
+            CHECK(test::difference(glm::vec3(c.worldPose()[3]), glm::vec3(0, 0, 5)) <= 1e-5f);
+            CHECK(test::difference(glm::vec3(a.worldPose()[3]), glm::vec3(1, 0, 0)) <= 1e-5f);
+            CHECK(test::difference(glm::vec3(b.worldPose()[3]), glm::vec3(1, 1, 0)) <= 1e-5f);
+        }
+    }
+    #pragma endregion
+
+    #pragma region cached depth, root and subtree size
+    // random insert, erase, splice, clear and destroy sequences, matches() compares the cached values with the model
+    void testRandomMutations(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            HierarchyReference ref;
+            randomForest(random, ref, 30);
+            for (int step = 0; step < 300; ++step)
+            {
+                size_t action = random.index(10);
+                int a = int(random.index(ref.slots()));
+                int b = int(random.index(ref.slots()));
+                if (!ref.alive(a) || (action == 9))
+                {
+                    ref.create();
+                    continue;
+                }
+                if (action < 4)
+                {
+                    if (!ref.alive(b) || (a == b) || ref.isAncestorOf(a, b)) continue;
+                    const auto& siblings = ref.children[b];
+                    int pos = (siblings.empty() || (random.index(3) == 0)) ? none : siblings[random.index(siblings.size())];
+                    if (pos == a) continue;
+                    ref.insert(b, pos, a);
+                }
+                else if (action < 6)
+                {
+                    const auto& from = ref.children[a];
+                    if (from.empty() || !ref.alive(b) || (a == b)) continue;
+                    size_t i = random.index(from.size());
+                    size_t j = i + 1 + random.index(from.size() - i);
+                    bool valid = true;
+                    for (size_t k = i; k < j; ++k)
+                        if ((from[k] == b) || ref.isAncestorOf(from[k], b)) valid = false;
+                    if (!valid) continue;
+                    ref.splice(b, none, a, from[i], (j == from.size()) ? none : from[j]);
+                }
+                else if (action == 6) ref.erase(a);
+                else if (action == 7) ref.clear(a);
+                else ref.destroy(a);
+                CHECK(ref.matches());
+            }
+        }
+    }
+
+    // tearing down from the top re-roots the detached subtrees right away
+    void testTopDownDestruction()
+    {
+        const int count = 200;
+        HierarchyReference ref(count);
+        for (int i = 1; i < count; ++i) ref.insert(i / 2, none, i);
+        for (int i = 0; i < count / 2; ++i)
+        {
+            ref.destroy(i);
+            if ((i % 16) == 0) CHECK(ref.matches());
+        }
+        CHECK(ref.matches());
+        for (int i = count / 2 + 1; i < count; ++i) ref.insert(count / 2, none, i);
+        CHECK(ref.matches());
+        CHECK(ref.node(count - 1)->depth() == 1);
+        CHECK(ref.node(count - 1)->root() == ref.node(count / 2));
+
+        // a chain cut below its top, depth and root are valid without touching the rest
+        HierarchyReference chain(count);
+        for (int i = 1; i < count; ++i) chain.insert(i - 1, none, i);
+        chain.destroy(0);
+        chain.destroy(1);
+        CHECK(chain.node(count - 1)->depth() == size_t(count - 3));
+        CHECK(chain.node(count - 1)->root() == chain.node(2));
+        // a tree left behind by a cleared node does not affect other trees
+        Hierarchy other, child;
+        other.push_back(&child);
+        CHECK((child.depth() == 1) && (child.root() == &other));
+        int leaf = chain.create();
+        chain.insert(count - 1, none, leaf);
+        CHECK(chain.node(leaf)->depth() == size_t(count - 2));
+        CHECK(chain.matches());
+    }
+    #pragma endregion
+
+    #pragma region bounded recursion
+    // whole forest in preorder, roots in slot order
+    std::vector<int> forestPreorder(const HierarchyReference& ref)
+    {
+        std::vector<int> result;
+        for (size_t i = 0; i < ref.slots(); ++i)
+            if (ref.alive(int(i)) && (ref.parent[i] == none)) ref.preorder(int(i), result);
+        return result;
+    }
+
+    // iteration from item with an explicit root visits expected, with depths relative to item
+    bool iteratesAs(const HierarchyReference& ref, int item, int root, const std::vector<int>& expected)
+    {
+        size_t k = 0;
+        Hierarchy::const_recurse_iterator end(nullptr);
+        for (Hierarchy::const_recurse_iterator it(ref.node(item), ref.node(root)); it != end; ++it, ++k)
+        {
+            if ((k >= expected.size()) || (static_cast<const Hierarchy*>(it) != ref.node(expected[k]))) return false;
+            if (it.depth() != int(ref.depth(expected[k])) - int(ref.depth(item))) return false;
+        }
+        return k == expected.size();
+    }
+
+    void testBoundedRecursion(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            HierarchyReference ref;
+            randomForest(random, ref, 60);
+            // recursion from each node without explicit root is checked by matches()
+            CHECK(ref.matches());
+
+            // the roots are in one chain of siblings, so a walk from a node without root continues through all following trees
+            Hierarchy top;
+            for (size_t i = 0; i < ref.slots(); ++i)
+                if (ref.parent[i] == none) top.push_back(ref.node(int(i)));
+            std::vector<int> all = forestPreorder(ref);
+            for (size_t k = 0; k < all.size(); ++k)
+            {
+                int item = all[k];
+                // without root the walk climbs out of item, through top and stops there
+                std::vector<int> rest(all.begin() + k, all.end());
+                std::vector<const Hierarchy*> walked;
+                for (Hierarchy::const_recurse_iterator it(ref.node(item), nullptr), end(nullptr); it != end; ++it)
+                    walked.push_back(it);
+                CHECK(walked.size() == rest.size());
+                for (size_t w = 0; (w < walked.size()) && (w < rest.size()); ++w)
+                    CHECK(walked[w] == ref.node(rest[w]));
+
+                // with an ancestor as root the walk ends after the last descendant of that ancestor
+                std::vector<int> ancestors;
+                for (int a = ref.parent[item]; a != none; a = ref.parent[a]) ancestors.push_back(a);
+                if (ancestors.empty()) continue;
+                int root = ancestors[random.index(ancestors.size())];
+                std::vector<int> subtree = ref.preorder(root);
+                auto from = std::find(subtree.begin(), subtree.end(), item);
+                CHECK(iteratesAs(ref, item, root, std::vector<int>(from, subtree.end())));
+            }
+            top.clear();
+
+            // visitors and skipChildren stay inside the subtree they start from
+            for (size_t i = 0; i < ref.slots(); ++i)
+            {
+                int item = int(i);
+                std::vector<int> expected = ref.preorder(item);
+                std::vector<Hierarchy*> visited;
+                bool depthsMatch = true;
+                ref.node(item)->visit([&](auto& visit, Hierarchy* node) {
+                    visited.push_back(node);
+                    if (visit.depth != int(ref.depth(ref.slot(node)) - ref.depth(item))) depthsMatch = false;
+                });
+                CHECK(depthsMatch);
+                CHECK(visited.size() == expected.size());
+                for (size_t k = 0; (k < visited.size()) && (k < expected.size()); ++k)
+                    CHECK(visited[k] == ref.node(expected[k]));
+
+                // range-for over a Hierarchy visits all descendants, without the node itself
+                std::vector<Hierarchy*> descendants;
+                for (Hierarchy& node : *ref.node(item)) descendants.push_back(&node);
+                std::vector<const Hierarchy*> constDescendants;
+                const Hierarchy* constItem = ref.node(item);
+                for (auto it = constItem->cbegin(); it != constItem->cend(); ++it) constDescendants.push_back(it);
+                CHECK((descendants.size() + 1 == expected.size()) && (constDescendants.size() == descendants.size()));
+                for (size_t k = 0; (k < descendants.size()) && (k + 1 < expected.size()) && (k < constDescendants.size()); ++k)
+                    CHECK((descendants[k] == ref.node(expected[k + 1])) && (constDescendants[k] == descendants[k]));
+
+                size_t count = 0;
+                auto end = ref.node(item)->end_recurse();
+                for (auto it = ref.node(item)->begin_recurse(); it != end; ++it, ++count)
+                    if (it.depth() == 1) it.skipChildren();
+                CHECK(count == 1 + ref.children[item].size());
+            }
+        }
+    }
+
+    // root -> { a -> a1, b, c }: a range-for over root visits a, a1, b and c
+    void testRangeFor()
+    {
+        Hierarchy root, a, a1, b, c;
+        root.push_back(&a);
+        a.push_back(&a1);
+        root.push_back(&b);
+        root.push_back(&c);
+        std::vector<Hierarchy*> visited;
+        for (Hierarchy& node : root) visited.push_back(&node);
+        CHECK((visited == std::vector<Hierarchy*>{ &a, &a1, &b, &c }));
+        visited.clear();
+        for (Hierarchy& node : a) visited.push_back(&node);
+        CHECK((visited == std::vector<Hierarchy*>{ &a1 }));
+        CHECK(b.begin() == b.end());
+    }
+
+    // FlatTree_ of an interior node holds only that subtree, and only its world poses
+    void testFlatTreeOfSubtree(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            Tree tree;
+            randomTree(random, tree, 40);
+            Transform* node = tree.nodes[random.index(tree.nodes.size())].get();
+            std::vector<Transform*> expected;
+            for (auto& item : node->recurse()) expected.push_back(&item);
+            CHECK(expected.size() == node->subtreeSize());
+
+            FlatTree flat(node);
+            flat.update();
+            CHECK(flat.nodes() == expected);
+            CHECK(flat.parents().front() == FlatTree::no_parent);
+            for (size_t k = 1; k < expected.size(); ++k)
+                CHECK(flat.nodes()[flat.parents()[k]] == expected[k]->parent());
+            CHECK(worldPosesMatch(tree));
+        }
+    }
+    #pragma endregion
+
+} // namespace
+
+int main()
+{
+    test::Random random(18);
+    testSpliceCases();
+    testRandomSplice(random);
+    testSpliceChildren(random);
+    testReparent(random);
+    testRandomMutations(random);
+    testTopDownDestruction();
+    testBoundedRecursion(random);
+    testRangeFor();
+    testFlatTreeOfSubtree(random);
+    return test::result();
+}
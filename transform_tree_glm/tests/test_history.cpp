@@ -0,0 +1,258 @@
+// PoseHistory_ ring buffer and the timed lookups of Transform_ built on it: wraparound against the
+// last samples inserted, setCapacity, times outside of the history, and interpolation against
+// hand-computed poses.
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "transform_tree_glm/history.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    typedef PoseHistory_<Pose> History;
+
+    const float tolerance = 1e-5f;
+
+    // rotation by angle about z
+    glm::quat rotationZ(float angle)
+    {
+        return glm::quat(std::cos(angle / 2), 0, 0, std::sin(angle / 2));
+    }
+
+    // same rotation, q and -q included
+    bool sameRotation(const glm::quat& a, const glm::quat& b)
+    {
+        return std::abs(std::abs(glm::dot(a, b)) - 1) <= tolerance;
+    }
+
+    bool sameSample(const History::Sample& a, const History::Sample& b)
+    {
+        return (a.time == b.time) && (a.position == b.position) && (a.rotation == b.rotation) && (a.scale == b.scale);
+    }
+
+    bool matches(const History& history, const std::deque<History::Sample>& expected)
+    {
+        if (history.size() != expected.size()) return false;
+        if (history.empty() != expected.empty()) return false;
+        for (size_t i = 0; i < expected.size(); ++i)
+            if (!sameSample(history[i], expected[i])) return false;
+        return expected.empty() || ((history.oldestTime() == expected.front().time) && (history.newestTime() == expected.back().time));
+    }
+
+    // random inserts, some rejected, against the newest capacity samples
+    void testWraparound(test::Random& random)
+    {
+        for (size_t capacity : { size_t(1), size_t(2), size_t(5), size_t(16) })
+        {
+            History history(capacity);
+            std::deque<History::Sample> expected;
+            double time = 0;
+            for (int step = 0; step < 200; ++step)
+            {
+                History::Sample sample = { time, random.position(), random.rotation(), random.scale() };
+                size_t action = random.index(6);
+                if ((action == 0) && !expected.empty())
+                {
+                    // older than the newest sample
+                    CHECK(!history.insert(expected.back().time - 0.25, sample.position, sample.rotation, sample.scale));
+                }
+                else if ((action == 1) && !expected.empty())
+                {
+                    // same time as the newest sample replaces it
+                    sample.time = expected.back().time;
+                    CHECK(history.insert(sample.time, sample.position, sample.rotation, sample.scale));
+                    expected.back() = sample;
+                }
+                else
+                {
+                    CHECK(history.insert(sample.time, sample.position, sample.rotation, sample.scale));
+                    expected.push_back(sample);
+                    if (expected.size() > capacity) expected.pop_front();
+                    time += 0.5 + random.uniform(0, 1);
+                }
+                CHECK(history.capacity() == capacity);
+                CHECK(matches(history, expected));
+            }
+
+            // every stored sample is found at its time
+            History::Sample sample;
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                CHECK(history.lookup(expected[i].time, sample.position, sample.rotation, sample.scale));
+                CHECK((sample.position == expected[i].position) && (sample.scale == expected[i].scale));
+                CHECK(sameRotation(sample.rotation, expected[i].rotation));
+            }
+            CHECK(!history.lookup(expected.front().time - 1e-3, sample.position, sample.rotation, sample.scale));
+            CHECK(!history.lookup(expected.back().time + 1e-3, sample.position, sample.rotation, sample.scale));
+
+            history.clear();
+            CHECK(history.empty() && (history.capacity() == capacity));
+            CHECK(!history.lookup(expected.back().time, sample.position, sample.rotation, sample.scale));
+            // after clear, older times are accepted again
+            CHECK(history.insert(0, sample.position, sample.rotation, sample.scale));
+        }
+
+        // no capacity, nothing is stored
+        History none;
+        CHECK(!none.insert(0, glm::vec3(0), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+        CHECK(none.empty());
+    }
+
+    // shrinking keeps the newest samples, growing keeps all of them, also after the ring wrapped around
+    void testSetCapacity(test::Random& random)
+    {
+        History history(4);
+        std::deque<History::Sample> expected;
+        for (int i = 0; i < 7; ++i)
+        {
+            History::Sample sample = { double(i), random.position(), random.rotation(), random.scale() };
+            history.insert(sample.time, sample.position, sample.rotation, sample.scale);
+            expected.push_back(sample);
+            if (expected.size() > 4) expected.pop_front();
+        }
+        history.setCapacity(8);
+        CHECK(history.capacity() == 8);
+        CHECK(matches(history, expected));
+        for (int i = 7; i < 12; ++i)
+        {
+            History::Sample sample = { double(i), random.position(), random.rotation(), random.scale() };
+            history.insert(sample.time, sample.position, sample.rotation, sample.scale);
+            expected.push_back(sample);
+            if (expected.size() > 8) expected.pop_front();
+        }
+        CHECK(matches(history, expected));
+        history.setCapacity(3);
+        while (expected.size() > 3) expected.pop_front();
+        CHECK(history.capacity() == 3);
+        CHECK(matches(history, expected));
+        history.setCapacity(0);
+        CHECK(history.empty() && (history.capacity() == 0));
+    }
+
+    // lerp of position and scale, slerp of rotation, against poses computed by hand
+    void testInterpolation()
+    {
+        const float pi = 3.14159265358979f;
+        History history(4);
+        history.insert(1, glm::vec3(0, 0, 0), rotationZ(0), glm::vec3(1));
+        history.insert(3, glm::vec3(2, 4, 6), rotationZ(pi / 2), glm::vec3(3, 1, 1));
+        history.insert(4, glm::vec3(2, 4, 6), rotationZ(pi / 2), glm::vec3(3, 1, 1));
+        // the shorter way from 90 degrees to 180 degrees is stored as -q
+        history.insert(5, glm::vec3(0, 0, 0), -rotationZ(pi), glm::vec3(1));
+
+        glm::vec3 position, scale;
+        glm::quat rotation;
+        CHECK(history.lookup(1.5, position, rotation, scale));
+        CHECK(test::difference(position, glm::vec3(0.5f, 1, 1.5f)) <= tolerance);
+        CHECK(test::difference(scale, glm::vec3(1.5f, 1, 1)) <= tolerance);
+        CHECK(sameRotation(rotation, rotationZ(pi / 8)));
+        CHECK(history.lookup(2, position, rotation, scale));
+        CHECK(test::difference(position, glm::vec3(1, 2, 3)) <= tolerance);
+        CHECK(sameRotation(rotation, rotationZ(pi / 4)));
+        // constant between equal samples
+        CHECK(history.lookup(3.7, position, rotation, scale));
+        CHECK(test::difference(position, glm::vec3(2, 4, 6)) <= tolerance);
+        CHECK(sameRotation(rotation, rotationZ(pi / 2)));
+        CHECK(history.lookup(4.5, position, rotation, scale));
+        CHECK(test::difference(position, glm::vec3(1, 2, 3)) <= tolerance);
+        CHECK(sameRotation(rotation, rotationZ(3 * pi / 4)));
+        CHECK(history.lookup(5, position, rotation, scale));
+        CHECK(sameRotation(rotation, rotationZ(pi)));
+        CHECK(!history.lookup(0.999, position, rotation, scale));
+        CHECK(!history.lookup(5.001, position, rotation, scale));
+    }
+
+    glm::mat4 referenceTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale = glm::vec3(1))
+    {
+        return glm::translate(glm::mat4(1), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1), scale);
+    }
+
+    // root (static) -> arm (history) -> hand (history), and root -> camera (history)
+    void testTransform()
+    {
+        const float pi = 3.14159265358979f;
+        Transform root(nullptr, Pose(glm::vec3(10, 0, 0), glm::quat(1, 0, 0, 0), glm::vec3(1)));
+        Transform arm(&root);
+        Transform hand(&arm);
+        Transform camera(&root);
+
+        // without history nothing is recorded and the current local pose holds for all times
+        CHECK(!arm.recordLocalPose(0));
+        CHECK(!arm.hasHistory() && (arm.history() == nullptr));
+        Transform::affine_type local;
+        CHECK(root.localAffineAt(-1e9, local) && (toMat4(local) == toMat4(root.localAffine())));
+
+        arm.enableHistory(3);
+        hand.enableHistory(8);
+        camera.enableHistory(8);
+        CHECK(arm.hasHistory() && (arm.history()->capacity() == 3));
+        for (int i = 0; i <= 4; ++i)
+        {
+            // the arm turns about z and moves along x, the hand moves along y
+            arm.setLocalPose(glm::vec3(float(i), 0, 0), rotationZ(float(i) * pi / 4));
+            hand.setLocalPose(glm::vec3(0, float(2 * i), 0), glm::quat(1, 0, 0, 0));
+            camera.setLocalPose(glm::vec3(0, 0, float(i)), glm::quat(1, 0, 0, 0));
+            CHECK(arm.recordLocalPose(double(i)));
+            CHECK(hand.recordLocalPose(double(i)));
+            CHECK(camera.recordLocalPose(double(i)));
+        }
+        // recording an older time fails, the arm only keeps times 2, 3 and 4
+        CHECK(!arm.recordLocalPose(1));
+        CHECK(arm.history()->size() == 3);
+        CHECK(!arm.localAffineAt(1.5, local));
+        CHECK(arm.localAffineAt(2.5, local));
+        CHECK(test::difference(toMat4(local), referenceTRS(glm::vec3(2.5f, 0, 0), rotationZ(2.5f * pi / 4))) <= tolerance);
+
+        // hand in root frame at 2.5: arm at x 2.5 turned by 2.5 * 45 degrees, hand at y 5 in it, root at x 10
+        glm::mat4 expectedHand = referenceTRS(glm::vec3(10, 0, 0), glm::quat(1, 0, 0, 0))
+            * referenceTRS(glm::vec3(2.5f, 0, 0), rotationZ(2.5f * pi / 4)) * referenceTRS(glm::vec3(0, 5, 0), glm::quat(1, 0, 0, 0));
+        glm::mat4 result;
+        CHECK(hand.transformLocalToRootAt(2.5, result));
+        CHECK(test::difference(result, expectedHand) <= tolerance);
+
+        // hand in camera frame, camera at z 2.5
+        glm::mat4 cameraInRoot = referenceTRS(glm::vec3(10, 0, 2.5f), glm::quat(1, 0, 0, 0));
+        glm::mat4 expected = glm::inverse(cameraInRoot) * expectedHand;
+        CHECK(hand.transformToAt(&camera, 2.5, result));
+        CHECK(test::difference(result, expected) <= tolerance);
+        CHECK(lookupTransform(&camera, &hand, 2.5, result));
+        CHECK(test::difference(result, expected) <= tolerance);
+        // the hand keeps time 1, the arm does not, the camera has nothing after 4
+        CHECK(!hand.transformToAt(&camera, 1, result));
+        CHECK(!hand.transformToAt(&camera, 4.5, result));
+        // the arm is not on the path from camera to root
+        CHECK(camera.transformToAt(&root, 1, result));
+        CHECK(test::difference(result, referenceTRS(glm::vec3(0, 0, 1), glm::quat(1, 0, 0, 0))) <= tolerance);
+
+        // the history does not change the current pose, and can be grown and dropped
+        CHECK(test::difference(hand.transformTo(&camera), glm::inverse(referenceTRS(glm::vec3(10, 0, 4), glm::quat(1, 0, 0, 0)))
+            * referenceTRS(glm::vec3(10, 0, 0), glm::quat(1, 0, 0, 0)) * referenceTRS(glm::vec3(4, 0, 0), rotationZ(pi))
+            * referenceTRS(glm::vec3(0, 8, 0), glm::quat(1, 0, 0, 0))) <= tolerance);
+        arm.enableHistory(10);
+        CHECK((arm.history()->capacity() == 10) && (arm.history()->size() == 3));
+        arm.disableHistory();
+        CHECK(!arm.hasHistory());
+        CHECK(hand.transformToAt(&camera, 1, result));
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(12);
+    testWraparound(random);
+    testSetCapacity(random);
+    testInterpolation();
+    testTransform();
+    return test::result();
+}
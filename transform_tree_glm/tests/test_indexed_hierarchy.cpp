@@ -0,0 +1,277 @@
+// IndexedHierarchy_ against a brute force reference of parent and child lists,
+// over random create, destroy, insert, erase and clear sequences with 32 and 16 bit indices.
+// Transform_ trees copied into the table and linked back onto the same and onto other nodes.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "transform_tree_glm/indexed_hierarchy.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    template <typename hierarchy_t>
+    struct Reference
+    {
+        using index_type = typename hierarchy_t::index_type;
+        static constexpr index_type none = hierarchy_t::node_none;
+
+        std::vector<bool> alive;
+        std::vector<index_type> parent;
+        std::vector<std::vector<index_type>> children;
+
+        void create(index_type item)
+        {
+            if (alive.size() <= item)
+            {
+                alive.resize(item + 1, false);
+                parent.resize(item + 1, none);
+                children.resize(item + 1);
+            }
+            alive[item] = true;
+            parent[item] = none;
+            children[item].clear();
+        }
+        void erase(index_type item)
+        {
+            if (parent[item] == none) return;
+            auto& siblings = children[parent[item]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), item));
+            parent[item] = none;
+        }
+        void insert(index_type p, index_type pos, index_type item)
+        {
+            if (item == pos) return;
+            erase(item);
+            auto& siblings = children[p];
+            auto at = (pos == none) ? siblings.end() : std::find(siblings.begin(), siblings.end(), pos);
+            siblings.insert(at, item);
+            parent[item] = p;
+        }
+        void clear(index_type p)
+        {
+            for (index_type child : children[p]) parent[child] = none;
+            children[p].clear();
+        }
+        void destroy(index_type item)
+        {
+            erase(item);
+            clear(item);
+            alive[item] = false;
+        }
+        bool isAncestorOf(index_type ancestor, index_type item) const
+        {
+            for (; item != none; item = parent[item])
+                if (item == ancestor) return true;
+            return false;
+        }
+        void preorder(index_type item, std::vector<index_type>& out) const
+        {
+            out.push_back(item);
+            for (index_type child : children[item]) preorder(child, out);
+        }
+    };
+
+    template <typename hierarchy_t>
+    bool matches(hierarchy_t& h, const Reference<hierarchy_t>& ref)
+    {
+        using index_type = typename hierarchy_t::index_type;
+        const index_type none = hierarchy_t::node_none;
+        size_t alive = 0;
+        for (size_t i = 0; i < ref.alive.size(); ++i)
+        {
+            if (!ref.alive[i]) continue;
+            ++alive;
+            index_type item = static_cast<index_type>(i);
+            const auto& children = ref.children[i];
+            if (h.parent(item) != ref.parent[i]) return false;
+            if (h.size(item) != children.size()) return false;
+            if (h.empty(item) != children.empty()) return false;
+            if (h.front(item) != (children.empty() ? none : children.front())) return false;
+            if (h.back(item) != (children.empty() ? none : children.back())) return false;
+            std::vector<index_type> iterated;
+            for (index_type child : h.children(item)) iterated.push_back(child);
+            if (iterated != children) return false;
+            for (size_t k = 0; k < children.size(); ++k)
+            {
+                if (h.prev(children[k]) != ((k == 0) ? none : children[k - 1])) return false;
+                if (h.next(children[k]) != ((k + 1 == children.size()) ? none : children[k + 1])) return false;
+            }
+            // recursion stays in the subtree it started from, visitors see the same nodes with depths
+            std::vector<index_type> expected, recursed, visited;
+            ref.preorder(item, expected);
+            for (index_type node : h.recurse(item)) recursed.push_back(node);
+            if (recursed != expected) return false;
+            h.visit(item, [&](auto&, index_type node) { visited.push_back(node); });
+            if (visited != expected) return false;
+            auto it = h.begin_recurse(item);
+            for (; it != h.end_recurse(item); ++it)
+            {
+                int depth = 0;
+                for (index_type node = it; node != item; node = ref.parent[node]) ++depth;
+                if (it.depth() != depth) return false;
+            }
+        }
+        return h.numNodes() == alive;
+    }
+
+    template <typename hierarchy_t>
+    void testRandom(test::Random& random, size_t maxNodes)
+    {
+        using index_type = typename hierarchy_t::index_type;
+        const index_type none = hierarchy_t::node_none;
+        hierarchy_t h;
+        Reference<hierarchy_t> ref;
+        std::vector<index_type> live;
+        for (int step = 0; step < 4000; ++step)
+        {
+            size_t action = random.index(10);
+            if (live.size() < 2 || ((action < 3) && (live.size() < maxNodes)))
+            {
+                index_type item = h.create();
+                ref.create(item);
+                live.push_back(item);
+                continue;
+            }
+            index_type a = live[random.index(live.size())];
+            index_type b = live[random.index(live.size())];
+            if (action < 6)
+            {
+                // insert a before a random child of b, or at the end
+                if (ref.isAncestorOf(a, b)) continue;
+                const auto& siblings = ref.children[b];
+                index_type pos = siblings.empty() || (random.index(3) == 0) ? none : siblings[random.index(siblings.size())];
+                size_t before = h.revision(b);
+                if (pos == a) continue;
+                h.insert(b, pos, a);
+                ref.insert(b, pos, a);
+                CHECK(h.revision(b) != before);
+            }
+            else if (action == 6)
+            {
+                if (random.index(2) == 0)
+                {
+                    if (ref.isAncestorOf(a, b)) continue;
+                    index_type front = ref.children[b].empty() ? none : ref.children[b].front();
+                    h.push_front(b, a);
+                    ref.insert(b, front, a);
+                }
+                else
+                {
+                    h.erase(a);
+                    ref.erase(a);
+                }
+            }
+            else if (action == 7)
+            {
+                if (random.index(2) == 0)
+                {
+                    h.pop_back(a);
+                    if (!ref.children[a].empty()) ref.erase(ref.children[a].back());
+                }
+                else
+                {
+                    h.clear(a);
+                    ref.clear(a);
+                }
+            }
+            else
+            {
+                // destroyed indices are reused by later creates
+                h.destroy(a);
+                ref.destroy(a);
+                live.erase(std::find(live.begin(), live.end(), a));
+            }
+            if ((step % 13) == 0) CHECK(matches(h, ref));
+        }
+        CHECK(matches(h, ref));
+    }
+
+    typedef IndexedHierarchy_<Transform::idx_type> TransformTopology;
+
+    // names of the nodes of the subtree in parent-before-child order, with the name of their parent
+    std::vector<std::string> describe(Transform* root)
+    {
+        std::vector<std::string> result;
+        for (auto& node : root->recurse())
+            result.push_back(node.name + " in " + ((&node == root) ? std::string("-") : node.parent()->name));
+        return result;
+    }
+
+    void testTransform(test::Random& random)
+    {
+        // random tree, the root below an outside node
+        Transform outside("outside");
+        std::vector<std::unique_ptr<Transform>> nodes;
+        for (int i = 0; i < 300; ++i)
+        {
+            Transform* parent = nodes.empty() ? &outside : nodes[random.index(nodes.size())].get();
+            nodes.emplace_back(new Transform(std::to_string(i), parent));
+        }
+        Transform* root = nodes[0].get();
+        std::vector<std::string> expected = describe(root);
+
+        TransformTopology table;
+        table.copyTopology(root);
+        CHECK(table.numNodes() == root->subtreeSize());
+        CHECK(table.data(0) == root);
+        bool links = true;
+        for (TransformTopology::index_type k = 1; k < TransformTopology::index_type(table.numNodes()); ++k)
+        {
+            Transform* node = static_cast<Transform*>(table.data(k));
+            links = links && (table.data(table.parent(k)) == node->parent()) && (table.parent(k) < k);
+            // siblings in the same order, linked both ways
+            Transform* next = (table.next(k) == TransformTopology::node_none) ? nullptr : static_cast<Transform*>(table.data(table.next(k)));
+            auto siblings = node->parent()->children();
+            auto at = std::find_if(siblings.begin(), siblings.end(), [&](Transform& sibling) { return &sibling == node; });
+            ++at;
+            links = links && ((at == siblings.end()) ? (next == nullptr) : (&*at == next));
+            links = links && ((table.next(k) == TransformTopology::node_none) || (table.prev(table.next(k)) == k));
+            links = links && ((table.prev(k) != TransformTopology::node_none) || (table.front(table.parent(k)) == k));
+            links = links && ((table.next(k) != TransformTopology::node_none) || (table.back(table.parent(k)) == k));
+            links = links && (table.size(table.parent(k)) == node->parent()->size());
+        }
+        CHECK(links);
+
+        // scramble the tree, linking back restores it, the root stays below outside
+        for (int i = 0; i < 200; ++i)
+        {
+            Transform* node = nodes[1 + random.index(nodes.size() - 1)].get();
+            Transform* parent = nodes[random.index(nodes.size())].get();
+            if (!node->isAncestorOf(parent) && (node != parent)) node->setParent(parent);
+        }
+        table.linkTopology<Transform>(0);
+        CHECK(describe(root) == expected);
+        CHECK((root->parent() == &outside) && (root->subtreeSize() == nodes.size()));
+
+        // onto other nodes with the same names
+        std::vector<std::unique_ptr<Transform>> copies;
+        for (TransformTopology::index_type k = 0; k < TransformTopology::index_type(table.numNodes()); ++k)
+        {
+            copies.emplace_back(new Transform(static_cast<Transform*>(table.data(k))->name));
+            table.data(k) = copies.back().get();
+        }
+        table.linkTopology<Transform>(0);
+        CHECK(describe(copies[0].get()) == expected);
+        CHECK(copies[0]->parent() == nullptr);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(17);
+    testTransform(random);
+    for (int run = 0; run < 5; ++run)
+    {
+        testRandom<IndexedHierarchy>(random, 64);
+        testRandom<IndexedHierarchy16>(random, 200);
+    }
+    return test::result();
+}
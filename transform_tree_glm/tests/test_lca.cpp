@@ -0,0 +1,178 @@
+// LcaIndex_ against brute force lowest common ancestors found by walking up the parents,
+// for all pairs of nodes in random trees, chains and stars of many sizes, and for subtrees of a larger tree.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "transform_tree_glm/lca.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    struct Tree
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+
+        Transform* add(Transform* parent)
+        {
+            nodes.emplace_back(new Transform(parent));
+            return nodes.back().get();
+        }
+    };
+
+    enum class Shape { Random, Chain, Star };
+
+    // count nodes below root
+    void build(test::Random& random, Tree& tree, size_t count, Shape shape)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Transform* parent = &tree.root;
+            if (!tree.nodes.empty())
+            {
+                if (shape == Shape::Chain) parent = tree.nodes.back().get();
+                else if (shape == Shape::Random) parent = (random.index(8) == 0) ? &tree.root : tree.nodes[random.index(tree.nodes.size())].get();
+            }
+            tree.add(parent);
+        }
+    }
+
+    // path from a up to and including ancestor
+    std::vector<Transform*> pathUp(Transform* a, const Transform* ancestor)
+    {
+        std::vector<Transform*> result;
+        for (; a != ancestor; a = a->parent()) result.push_back(a);
+        result.push_back(a);
+        return result;
+    }
+
+    Transform* referenceLca(Transform* a, Transform* b)
+    {
+        std::vector<Transform*> ancestors;
+        for (Transform* node = a; node != nullptr; node = node->parent()) ancestors.push_back(node);
+        for (; b != nullptr; b = b->parent())
+            if (std::find(ancestors.begin(), ancestors.end(), b) != ancestors.end()) return b;
+        return nullptr;
+    }
+
+    // every query of index for every pair of nodes in the subtree of root, and nodes outside of it
+    bool matches(const LcaIndex& index, Transform* root, const std::vector<Transform*>& outside)
+    {
+        std::vector<Transform*> nodes;
+        for (auto& node : root->recurse()) nodes.push_back(&node);
+        if (index.size() != nodes.size()) return false;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            LcaIndex::index_type idx = index.index(nodes[i]);
+            if ((idx != LcaIndex::index_type(i)) || (index.node(idx) != nodes[i]) || !index.contains(nodes[i])) return false;
+            if (index.depth(idx) != LcaIndex::index_type(nodes[i]->depth() - root->depth())) return false;
+            if ((i == 0) ? (index.parent(idx) != LcaIndex::no_index) : (index.node(index.parent(idx)) != nodes[i]->parent())) return false;
+        }
+        for (Transform* a : nodes)
+        {
+            for (Transform* b : nodes)
+            {
+                Transform* expected = referenceLca(a, b);
+                if (index.lca(a, b) != expected) return false;
+                if (index.lca(index.index(a), index.index(b)) != index.index(expected)) return false;
+                size_t distance = (a->depth() - expected->depth()) + (b->depth() - expected->depth());
+                if (index.distance(a, b) != LcaIndex::index_type(distance)) return false;
+
+                std::vector<Transform*> path, expectedPath = pathUp(a, expected), down = pathUp(b, expected);
+                expectedPath.insert(expectedPath.end(), down.rbegin() + 1, down.rend());
+                if (!index.path(a, b, path) || (path != expectedPath)) return false;
+            }
+            for (Transform* b : outside)
+            {
+                std::vector<Transform*> path;
+                if ((index.lca(a, b) != nullptr) || (index.lca(b, a) != nullptr)) return false;
+                if (index.distance(a, b) != LcaIndex::no_index) return false;
+                if (index.path(a, b, path) || !path.empty()) return false;
+            }
+        }
+        for (Transform* b : outside)
+            if (index.contains(b) || (index.index(b) != LcaIndex::no_index)) return false;
+        return true;
+    }
+
+    // sizes around the powers of two, where the sparse table gains a level
+    void testShapes(test::Random& random)
+    {
+        for (Shape shape : { Shape::Random, Shape::Chain, Shape::Star })
+        {
+            for (size_t count = 0; count < 70; ++count)
+            {
+                Tree tree;
+                build(random, tree, count, shape);
+                LcaIndex index(&tree.root);
+                CHECK(index.update());
+                CHECK(matches(index, &tree.root, {}));
+            }
+        }
+    }
+
+    // the index of an interior node ignores the rest of the tree
+    void testSubtrees(test::Random& random)
+    {
+        Tree tree;
+        build(random, tree, 150, Shape::Random);
+        for (int run = 0; run < 20; ++run)
+        {
+            Transform* root = tree.nodes[random.index(tree.nodes.size())].get();
+            std::vector<Transform*> outside;
+            if (root->parent()) outside.push_back(root->parent());
+            if (root->next()) outside.push_back(root->next());
+            if (root->prev()) outside.push_back(root->prev());
+            outside.push_back(&tree.root);
+            if (!root->empty()) outside.erase(std::remove(outside.begin(), outside.end(), root->front()), outside.end());
+
+            LcaIndex index(root);
+            index.update();
+            CHECK(matches(index, root, outside));
+        }
+    }
+
+    // mutations make the index stale, update() rebuilds it once and bumps the generation
+    void testStale(test::Random& random)
+    {
+        Tree tree;
+        build(random, tree, 60, Shape::Random);
+        LcaIndex index(&tree.root);
+        CHECK(index.isStale());
+        CHECK(index.update());
+        CHECK(!index.update());
+        size_t generation = index.generation();
+        for (int step = 0; step < 20; ++step)
+        {
+            Transform* child = tree.nodes[random.index(tree.nodes.size())].get();
+            Transform* parent = tree.nodes[random.index(tree.nodes.size())].get();
+            if ((child == parent) || child->isAncestorOf(parent)) continue;
+            child->setParent(parent);
+            CHECK(index.isStale());
+            CHECK(index.update());
+            CHECK(index.generation() == ++generation);
+            CHECK(!index.isStale());
+            CHECK(matches(index, &tree.root, {}));
+        }
+        index.setRoot(tree.nodes.front().get());
+        CHECK(index.isStale());
+        CHECK(index.update());
+        CHECK(matches(index, tree.nodes.front().get(), { &tree.root }));
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(23);
+    testShapes(random);
+    testSubtrees(random);
+    testStale(random);
+    return test::result();
+}
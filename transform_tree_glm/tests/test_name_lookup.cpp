@@ -0,0 +1,173 @@
+// Transform_::findChild and Transform_::find against linear scans of the children,
+// over random reparenting, renaming through setName() and destruction of nodes.
+// Names come from a small set, so siblings often share a name and the first one must be found.
+// The child name map is only rebuilt when the direct children change.
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    const std::vector<std::string> names = { "a", "b", "arm", "wrist", "", "a/b" };
+
+    Transform* referenceFindChild(Transform* node, std::string_view name)
+    {
+        for (Transform* child = node->front(); child != nullptr; child = child->next())
+            if (child->name == name) return child;
+        return nullptr;
+    }
+
+    // descends along the segments, skipping empty ones
+    Transform* referenceFind(Transform* node, const std::vector<std::string>& segments)
+    {
+        for (const std::string& segment : segments)
+        {
+            if (node == nullptr) return nullptr;
+            if (!segment.empty()) node = referenceFindChild(node, segment);
+        }
+        return node;
+    }
+
+    bool matches(test::Random& random, const std::vector<std::unique_ptr<Transform>>& nodes)
+    {
+        for (auto& node : nodes)
+        {
+            if (!node) continue;
+            const Transform* constNode = node.get();
+            for (const std::string& name : names)
+            {
+                // "a/b" is not a valid child name for findChild, but it must not match anything else
+                Transform* expected = referenceFindChild(node.get(), name);
+                if ((node->findChild(name) != expected) || (constNode->findChild(name) != expected)) return false;
+            }
+            // random paths with leading, trailing and repeated separators
+            for (int k = 0; k < 4; ++k)
+            {
+                std::vector<std::string> segments;
+                std::string path;
+                size_t count = random.index(4);
+                for (size_t s = 0; s < count; ++s)
+                {
+                    std::string segment = names[random.index(4)];
+                    if (random.index(5) == 0) segment.clear();
+                    segments.push_back(segment);
+                    path += (s == 0) ? segment : "/" + segment;
+                }
+                if (random.index(4) == 0) path = "/" + path;
+                if (random.index(4) == 0) path += "/";
+                Transform* expected = referenceFind(node.get(), segments);
+                if ((node->find(path) != expected) || (constNode->find(path) != expected)) return false;
+            }
+        }
+        return true;
+    }
+
+    void testRandom(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            std::vector<std::unique_ptr<Transform>> nodes;
+            for (int i = 0; i < 40; ++i)
+            {
+                Transform* parent = ((i == 0) || (random.index(6) == 0)) ? nullptr : nodes[random.index(nodes.size())].get();
+                nodes.emplace_back(new Transform(names[random.index(names.size() - 1)], parent));
+            }
+            CHECK(matches(random, nodes));
+            for (int step = 0; step < 100; ++step)
+            {
+                auto& node = nodes[random.index(nodes.size())];
+                size_t action = random.index(6);
+                if (!node)
+                {
+                    Transform* parent = nodes[random.index(nodes.size())].get();
+                    node.reset(new Transform(names[random.index(names.size() - 1)], parent));
+                }
+                else if (action < 3)
+                {
+                    // maps of the old and the new parent are built before, both must notice the move
+                    Transform* parent = nodes[random.index(nodes.size())].get();
+                    if ((parent == node.get()) || node->isAncestorOf(parent)) continue;
+                    node->setParent(parent);
+                }
+                else if (action < 5) node->setName(names[random.index(names.size() - 1)]);
+                else node.reset();
+                CHECK(matches(random, nodes));
+            }
+        }
+    }
+
+    // the map views the names of the children, renaming one must not leave a view of its old name behind
+    void testRename()
+    {
+        Transform root("root", nullptr);
+        Transform first("arm", &root);
+        Transform second("arm", &root);
+        CHECK(root.findChild("arm") == &first);
+        first.setName("leg");
+        CHECK(root.findChild("arm") == &second);
+        CHECK(root.findChild("leg") == &first);
+        second.setName(std::string(64, 'x'));
+        CHECK(root.findChild("arm") == nullptr);
+        CHECK(root.findChild(std::string(64, 'x')) == &second);
+        Transform wrist("wrist", &second);
+        CHECK(root.find(std::string(64, 'x') + "/wrist") == &wrist);
+        CHECK(root.find("leg/wrist") == nullptr);
+        CHECK(root.find("") == &root);
+        CHECK(root.find("//") == &root);
+    }
+
+    // revision the child name map of a node was built at
+    struct ChildNames : public Transform
+    {
+        static size_t revision(const Transform& node) { return node.*(&ChildNames::m_childNamesRevision); }
+    };
+
+    // changes below the children leave the map of root alone, changes of the children rebuild it
+    void testRebuild()
+    {
+        Transform root("root", nullptr);
+        Transform arm("arm", &root);
+        Transform leg("leg", &root);
+        CHECK(root.findChild("arm") == &arm);
+        size_t built = ChildNames::revision(root);
+        CHECK(built == root.childrenRevision());
+
+        Transform wrist("wrist", &arm);
+        Transform hand("hand", &wrist);
+        hand.setParent(&leg);
+        wrist.setParent(nullptr);
+        CHECK(root.revision() != built);
+        CHECK(root.childrenRevision() == built);
+        CHECK(root.findChild("leg") == &leg);
+        CHECK(ChildNames::revision(root) == built);
+
+        // reordering the children changes which of two equal names is found first
+        Transform second("arm", &root);
+        CHECK(root.findChild("arm") == &arm);
+        CHECK(ChildNames::revision(root) != built);
+        root.spliceChildren(root.front(), &root, &second);
+        CHECK(root.findChild("arm") == &second);
+        arm.setParent(&leg);
+        second.setParent(&leg);
+        CHECK(root.findChild("arm") == nullptr);
+        CHECK(leg.findChild("arm") == &arm);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(24);
+    testRandom(random);
+    testRename();
+    testRebuild();
+    return test::result();
+}
@@ -0,0 +1,221 @@
+// OrderList against the brute force model of hierarchy_reference.h: the tag list must be the Euler tour
+// of the attached subtree with strictly increasing labels, over random mutations of a forest with two tours
+// and over long runs of inserts into one gap, which force relabeling.
+
+#include <utility>
+#include <vector>
+
+#include "transform_tree_glm/hierarchy.h"
+
+#include "hierarchy_reference.h"
+#include "test.h"
+
+using namespace transform_tree_glm;
+using test::HierarchyReference;
+
+namespace {
+
+    const int none = HierarchyReference::none;
+
+    // exposes the tags for inspection
+    struct TourList : public OrderList
+    {
+        // tags from head to tail as (node, exit), false if labels are not strictly increasing
+        bool tags(std::vector<std::pair<const Hierarchy*, bool>>& out) const
+        {
+            out.clear();
+            label_type label = m_head.label;
+            for (const Tag* tag = m_head.next; tag != &m_tail; tag = tag->next)
+            {
+                if ((tag->label <= label) || (tag->list != this) || (tag->next->prev != tag)) return false;
+                label = tag->label;
+                out.emplace_back(tag->node, tag->exit);
+            }
+            return (label < m_tail.label) && (out.size() == m_numTags);
+        }
+    };
+
+    using Tour = std::vector<std::pair<const Hierarchy*, bool>>;
+
+    void eulerTour(const HierarchyReference& ref, int item, Tour& out)
+    {
+        out.emplace_back(ref.node(item), false);
+        for (int child : ref.children[item]) eulerTour(ref, child, out);
+        out.emplace_back(ref.node(item), true);
+    }
+
+    // the tags of list are the Euler tour of root in the model, root == none for an empty list
+    bool tourMatches(const HierarchyReference& ref, const TourList& list, int root)
+    {
+        Tour tags, expected;
+        if (!list.tags(tags)) return false;
+        if (root != none) eulerTour(ref, root, expected);
+        if ((tags != expected) || (list.root() != ref.node(root))) return false;
+        return (list.size() * 2 == expected.size()) && (list.empty() == expected.empty());
+    }
+
+    // Tours of the lists match the subtrees of their model roots, forEach and forEachDescendant sweep them.
+    // Ancestry queries agree with the model for all pairs, in the same tour or not.
+    bool matches(const HierarchyReference& ref, const std::vector<TourList*>& lists, const std::vector<int>& roots)
+    {
+        std::vector<const OrderList*> owner(ref.slots(), nullptr);
+        for (size_t l = 0; l < lists.size(); ++l)
+        {
+            const TourList& list = *lists[l];
+            if (!tourMatches(ref, list, roots[l])) return false;
+            if (roots[l] == none) continue;
+            for (int item : ref.preorder(roots[l])) owner[item] = &list;
+
+            std::vector<int> preorder = ref.preorder(roots[l]);
+            std::vector<Hierarchy*> swept;
+            list.forEach([&](Hierarchy* node) { swept.push_back(node); });
+            for (size_t k = 0; k < preorder.size(); ++k)
+                if ((k >= swept.size()) || (swept[k] != ref.node(preorder[k]))) return false;
+            if (swept.size() != preorder.size()) return false;
+
+            for (int item : preorder)
+            {
+                std::vector<int> descendants = ref.preorder(item);
+                std::vector<Hierarchy*> sweptDescendants;
+                list.forEachDescendant(ref.node(item), [&](Hierarchy* node) { sweptDescendants.push_back(node); });
+                if (sweptDescendants.size() + 1 != descendants.size()) return false;
+                for (size_t k = 0; k < sweptDescendants.size(); ++k)
+                    if (sweptDescendants[k] != ref.node(descendants[k + 1])) return false;
+            }
+        }
+        for (size_t a = 0; a < ref.slots(); ++a)
+        {
+            if (!ref.alive(int(a))) continue;
+            const Hierarchy* node = ref.node(int(a));
+            if ((node->orderList() != owner[a]) || (node->isOrdered() != (owner[a] != nullptr))) return false;
+            for (size_t b = 0; b < ref.slots(); ++b)
+                if (ref.alive(int(b)) && (node->isAncestorOf(ref.node(int(b))) != ref.isAncestorOf(int(a), int(b)))) return false;
+        }
+        return true;
+    }
+
+    // a root nested below the tour of another list leaves its own list, whose tour then is empty
+    void updateRoots(const HierarchyReference& ref, std::vector<int>& roots)
+    {
+        for (int& root : roots)
+        {
+            if ((root != none) && !ref.alive(root)) root = none;
+        }
+        for (int& root : roots)
+        {
+            for (int other : roots)
+                if ((root != none) && (other != none) && ref.isAncestorOf(other, root)) root = none;
+        }
+    }
+
+    void testRandom(test::Random& random)
+    {
+        for (int run = 0; run < 30; ++run)
+        {
+            HierarchyReference ref;
+            for (int i = 0; i < 40; ++i)
+            {
+                int item = ref.create();
+                if ((item > 1) && (random.index(6) != 0)) ref.insert(int(random.index(size_t(item))), none, item);
+            }
+            TourList first, second;
+            std::vector<TourList*> lists = { &first, &second };
+            std::vector<int> roots = { ref.root(0), ref.root(1) };
+            if (roots[0] == roots[1]) roots[1] = none;
+            first.attach(ref.node(roots[0]));
+            second.attach(ref.node(roots[1]));
+            CHECK(matches(ref, lists, roots));
+
+            for (int step = 0; step < 150; ++step)
+            {
+                size_t action = random.index(10);
+                int a = int(random.index(ref.slots()));
+                int b = int(random.index(ref.slots()));
+                if (!ref.alive(a) || !ref.alive(b))
+                {
+                    if (!ref.alive(a)) ref.create();
+                    continue;
+                }
+                if (action < 5)
+                {
+                    if ((a == b) || ref.isAncestorOf(a, b)) continue;
+                    const auto& siblings = ref.children[b];
+                    int pos = (siblings.empty() || (random.index(3) == 0)) ? none : siblings[random.index(siblings.size())];
+                    if (pos == a) continue;
+                    ref.insert(b, pos, a);
+                }
+                else if (action < 7)
+                {
+                    const auto& from = ref.children[a];
+                    if (from.empty()) continue;
+                    size_t i = random.index(from.size());
+                    size_t j = i + 1 + random.index(from.size() - i);
+                    bool valid = true;
+                    for (size_t k = i; k < j; ++k)
+                        if ((from[k] == b) || ref.isAncestorOf(from[k], b)) valid = false;
+                    if (!valid || (a == b)) continue;
+                    ref.splice(b, none, a, from[i], (j == from.size()) ? none : from[j]);
+                }
+                else if (action == 7) ref.erase(a);
+                else if (action == 8) ref.clear(a);
+                else ref.destroy(a);
+                updateRoots(ref, roots);
+                CHECK(ref.matches());
+                CHECK(matches(ref, lists, roots));
+            }
+
+            // attaching again rebuilds the tour, detaching empties it
+            int root = ref.root(int(random.index(ref.slots())));
+            if (ref.alive(root) && (root != roots[1]))
+            {
+                roots[0] = root;
+                first.attach(ref.node(root));
+                updateRoots(ref, roots);
+                CHECK(matches(ref, lists, roots));
+            }
+            first.detach();
+            roots[0] = none;
+            CHECK(matches(ref, lists, roots));
+        }
+    }
+
+    // inserting again and again into the same gap runs out of labels, so windows get relabeled
+    void testRelabel(test::Random& random)
+    {
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            HierarchyReference ref(2);
+            ref.insert(0, none, 1);
+            TourList list;
+            list.attach(ref.node(0));
+            int last = 1;
+            for (int i = 0; i < 3000; ++i)
+            {
+                int item = ref.create();
+                // before the same node, as a chain growing downwards, or after the same node
+                if (mode == 0) ref.insert(0, 1, item);
+                else if (mode == 1) ref.insert(last, none, item);
+                else ref.insert(1, none, item);
+                last = item;
+                if ((i % 500) == 0) CHECK(tourMatches(ref, list, 0));
+            }
+            CHECK(tourMatches(ref, list, 0));
+            CHECK(list.size() == ref.slots());
+            for (int k = 0; k < 2000; ++k)
+            {
+                int a = int(random.index(ref.slots()));
+                int b = int(random.index(ref.slots()));
+                CHECK(ref.node(a)->isAncestorOf(ref.node(b)) == ref.isAncestorOf(a, b));
+            }
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(21);
+    testRandom(random);
+    testRelabel(random);
+    return test::result();
+}
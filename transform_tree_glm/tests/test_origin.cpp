@@ -0,0 +1,151 @@
+// Float trees attached to nodes of a double precision tree far from the origin, see Transform_::setOrigin.
+// globalPose(), transformTo() and lookupTransform() across origins against the local poses composed
+// in double, and the float world poses, which stay relative to the root of their tree.
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    // local poses composed in double up to the root, then on through the origins
+    template <typename transform_t>
+    glm::dmat4 referenceGlobalPose(transform_t* node)
+    {
+        glm::dmat4 result(1);
+        for (transform_t* n = node; n != nullptr; n = n->parent())
+            result = glm::dmat4(n->localPose()) * result;
+        DTransform* origin = node->origin();
+        return origin ? referenceGlobalPose(origin) * result : result;
+    }
+
+    double positionError(const glm::dmat4& m, const glm::dmat4& expected)
+    {
+        return glm::length(glm::dvec3(m[3]) - glm::dvec3(expected[3]));
+    }
+
+    // a map in double far from the origin with two sites, a float tree on each site
+    struct Scene
+    {
+        DTransform map;
+        DTransform road;
+        DTransform siteA;
+        DTransform siteB;
+        std::vector<std::unique_ptr<Transform>> a;
+        std::vector<std::unique_ptr<Transform>> b;
+
+        Scene(test::Random& random)
+            : map(nullptr, DPose(glm::dvec3(3e7, -2e7, 1e3) + glm::dvec3(random.position(1)), glm::dquat(random.rotation()), glm::dvec3(1)))
+            , road(&map, DPose(glm::dvec3(5e5, 1e5, 0) + glm::dvec3(random.position(1)), glm::dquat(random.rotation()), glm::dvec3(1)))
+            , siteA(&road, DPose(glm::dvec3(random.position()), glm::dquat(random.rotation()), glm::dvec3(1)))
+            , siteB(&road, DPose(glm::dvec3(random.position()), glm::dquat(random.rotation()), glm::dvec3(1)))
+        {
+            chain(random, a, &siteA);
+            chain(random, b, &siteB);
+        }
+
+        static void chain(test::Random& random, std::vector<std::unique_ptr<Transform>>& nodes, DTransform* origin)
+        {
+            for (int k = 0; k < 6; ++k)
+            {
+                Transform* parent = nodes.empty() ? nullptr : nodes.back().get();
+                nodes.emplace_back(new Transform(parent, Pose(random.position(), random.rotation(), glm::vec3(1))));
+            }
+            nodes.front()->setOrigin(origin);
+        }
+    };
+
+    void testScene(test::Random& random)
+    {
+        Scene scene(random);
+        Transform* leafA = scene.a.back().get();
+        Transform* leafB = scene.b.back().get();
+
+        // the origin of the root applies to the whole tree
+        CHECK(leafA->origin() == &scene.siteA);
+        CHECK(scene.a[2]->origin() == &scene.siteA);
+        CHECK(scene.map.origin() == nullptr);
+
+        // global poses keep double precision 3e7 units from the origin
+        glm::dmat4 globalA = referenceGlobalPose(leafA);
+        glm::dmat4 globalB = referenceGlobalPose(leafB);
+        CHECK(positionError(leafA->globalPose(), globalA) <= 1e-4);
+        CHECK(positionError(leafB->globalPose(), globalB) <= 1e-4);
+        CHECK(test::difference(scene.siteA.globalPose(), glm::dmat4(scene.siteA.worldPose())) == 0);
+        // the world pose stays relative to the root of the float tree
+        CHECK(test::difference(glm::dmat4(leafA->worldPose()), glm::affineInverse(referenceGlobalPose(&scene.siteA)) * globalA) <= 1e-4);
+
+        // between the float trees through the map, to the map and back
+        glm::dmat4 aInB = glm::affineInverse(globalB) * globalA;
+        CHECK(positionError(glm::dmat4(leafA->transformTo(leafB)), aInB) <= 1e-4);
+        CHECK(positionError(glm::dmat4(lookupTransform(leafB, leafA)), aInB) <= 1e-4);
+        glm::dmat4 aInRoad = glm::affineInverse(referenceGlobalPose(&scene.road)) * globalA;
+        CHECK(positionError(leafA->transformTo(&scene.road), aInRoad) <= 1e-4);
+        CHECK(positionError(lookupTransform(&scene.road, leafA), aInRoad) <= 1e-4);
+        CHECK(positionError(scene.road.transformTo(leafA), glm::affineInverse(aInRoad)) <= 1e-4);
+        CHECK(positionError(leafA->transformTo(&scene.siteA), glm::dmat4(leafA->worldPose())) <= 1e-9);
+        // within one float tree transformTo stays in float
+        CHECK(positionError(glm::dmat4(scene.a[1]->transformTo(leafA)), glm::affineInverse(globalA) * referenceGlobalPose(scene.a[1].get())) <= 1e-4);
+
+        // moving the map leaves the float world poses cached
+        for (auto& node : scene.a) node->worldPose();
+        scene.map.setLocalPosition(scene.map.localPosition() + glm::dvec3(1e6, 0, 0));
+        for (auto& node : scene.a) CHECK(!node->isWorldPoseDirty());
+        CHECK(positionError(leafA->globalPose(), referenceGlobalPose(leafA)) <= 1e-4);
+        CHECK(positionError(leafA->globalPose(), globalA) >= 1e5);
+
+        // another site, and a subtree taken out of the tree loses the origin
+        scene.a.front()->setOrigin(&scene.siteB);
+        CHECK(positionError(glm::dmat4(leafA->transformTo(leafB)), glm::affineInverse(referenceGlobalPose(leafB)) * referenceGlobalPose(leafA)) <= 1e-4);
+        scene.a[3]->setParent(nullptr);
+        CHECK(leafA->origin() == nullptr);
+        CHECK(scene.a[2]->origin() == &scene.siteB);
+        CHECK(test::difference(leafA->globalPose(), glm::dmat4(leafA->worldPose())) == 0);
+    }
+
+    // double trees attached to double trees, and float trees without origins.
+    // the float poses carry rotation errors of float, which grow with the distance of 1e3 here.
+    void testChains(test::Random& random)
+    {
+        auto pose = [&random]() { return DPose(glm::dvec3(random.position(1e3f)), glm::dquat(random.rotation()), glm::dvec3(1)); };
+        DTransform world(nullptr, pose());
+        DTransform region(nullptr, pose());
+        DTransform city(&region, pose());
+        region.setOrigin(&world);
+        Transform building(nullptr, Pose(random.position(), random.rotation(), glm::vec3(1)));
+        Transform room(&building, Pose(random.position(), random.rotation(), glm::vec3(1)));
+        building.setOrigin(&city);
+        glm::dmat4 expected = glm::dmat4(world.localPose()) * glm::dmat4(region.localPose()) * glm::dmat4(city.localPose())
+            * glm::dmat4(building.localPose()) * glm::dmat4(room.localPose());
+        CHECK(positionError(room.globalPose(), expected) <= 1e-3);
+        CHECK(positionError(room.transformTo(&world), glm::affineInverse(glm::dmat4(world.localPose())) * expected) <= 1e-3);
+        CHECK(positionError(world.transformTo(&room), glm::affineInverse(expected) * glm::dmat4(world.localPose())) <= 1e-3);
+
+        // disjoint trees without origins still relate through their root frames
+        Transform other(nullptr, Pose(random.position(), random.rotation(), glm::vec3(1)));
+        Transform loose(nullptr, Pose(random.position(), random.rotation(), glm::vec3(1)));
+        glm::dmat4 looseInOther = glm::affineInverse(glm::dmat4(other.localPose())) * glm::dmat4(loose.localPose());
+        CHECK(positionError(glm::dmat4(loose.transformTo(&other)), looseInOther) <= 1e-5);
+        CHECK(positionError(loose.transformTo(&world), glm::affineInverse(glm::dmat4(world.localPose())) * glm::dmat4(loose.localPose())) <= 1e-5);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(11);
+    for (int run = 0; run < 20; ++run)
+    {
+        testScene(random);
+        testChains(random);
+    }
+    return test::result();
+}
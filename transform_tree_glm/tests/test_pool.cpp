@@ -0,0 +1,201 @@
+// TransformPool_: create, destroy, destroySubtree and clear against a list of the live nodes,
+// slot reuse, and reserveContiguous() in a steady-state loop which must not grow the pool.
+// Names are longer than the small string buffer, so nodes which are never destroyed show up
+// as leaks and nodes destroyed twice as double frees when built with -fsanitize=address.
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "transform_tree_glm/pool.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    std::string longName(size_t i)
+    {
+        return "node with a name longer than the small string buffer " + std::to_string(i);
+    }
+
+    // the parents of the live nodes are live, and their subtree sizes add up
+    bool consistent(const std::vector<Transform*>& live)
+    {
+        std::set<Transform*> nodes(live.begin(), live.end());
+        for (Transform* node : live)
+        {
+            if (node->parent() && (nodes.count(node->parent()) == 0)) return false;
+            size_t size = 1;
+            for (auto& child : node->children()) size += child.subtreeSize();
+            if (size != node->subtreeSize()) return false;
+        }
+        return true;
+    }
+
+    void removeSubtree(std::vector<Transform*>& live, Transform* node)
+    {
+        std::set<Transform*> subtree;
+        for (auto& item : node->recurse()) subtree.insert(&item);
+        live.erase(std::remove_if(live.begin(), live.end(), [&](Transform* item) { return subtree.count(item) > 0; }), live.end());
+    }
+
+    void testCases()
+    {
+        TransformPool pool(4);
+        CHECK(pool.empty() && (pool.capacity() == 0));
+        Transform* root = pool.create(longName(0));
+        Transform* a = pool.create(longName(1), root);
+        Transform* a1 = pool.create(longName(2), a);
+        Transform* a2 = pool.create(longName(3), a);
+        Transform* b = pool.create(longName(4), root);
+        CHECK((pool.size() == 5) && (pool.capacity() == 8));
+        CHECK((a1->parent() == a) && (root->subtreeSize() == 5) && (a1->name == longName(2)));
+
+        // destroy detaches the children, the slot is reused by the next create
+        pool.destroy(a);
+        CHECK(pool.size() == 4);
+        CHECK((a1->parent() == nullptr) && (a2->parent() == nullptr) && (root->subtreeSize() == 2));
+        Transform* c = pool.create(longName(5), b);
+        CHECK(c == a);
+        CHECK((b->subtreeSize() == 2) && (pool.capacity() == 8));
+
+        // destroySubtree detaches from a parent outside of the pool once
+        Transform outside;
+        root->setParent(&outside);
+        pool.destroySubtree(root);
+        CHECK((pool.size() == 2) && (outside.subtreeSize() == 1));
+        CHECK((a1->parent() == nullptr) && (a2->subtreeSize() == 1));
+
+        pool.clear();
+        CHECK(pool.empty() && (pool.capacity() == 0));
+        // usable again after clear
+        Transform* d = pool.create(longName(6));
+        CHECK((pool.size() == 1) && (d->name == longName(6)));
+    }
+
+    // random creates and destroys against the list of live nodes
+    void testRandom(test::Random& random)
+    {
+        TransformPool pool(16);
+        std::vector<Transform*> live;
+        for (int step = 0; step < 3000; ++step)
+        {
+            size_t action = random.index(10);
+            if (live.empty() || (action < 5))
+            {
+                Transform* parent = (live.empty() || (random.index(4) == 0)) ? nullptr : live[random.index(live.size())];
+                live.push_back(pool.create(longName(size_t(step)), parent));
+            }
+            else if (action < 7)
+            {
+                size_t k = random.index(live.size());
+                pool.destroy(live[k]);
+                live.erase(live.begin() + k);
+            }
+            else if (action < 8)
+            {
+                Transform* node = live[random.index(live.size())];
+                removeSubtree(live, node);
+                pool.destroySubtree(node);
+            }
+            else
+            {
+                // a reservation, used partly and replaced by the next one
+                pool.reserveContiguous(random.index(40));
+            }
+            CHECK(pool.size() == live.size());
+            CHECK(consistent(live));
+        }
+        CHECK(pool.capacity() < 3000);
+        pool.clear();
+        CHECK(pool.empty());
+    }
+
+    // addresses of count nodes created one after the other are equally spaced, in increasing order
+    bool adjacent(const std::vector<Transform*>& nodes)
+    {
+        if (nodes.size() < 2) return true;
+        const char* first = reinterpret_cast<const char*>(nodes[0]);
+        std::ptrdiff_t stride = reinterpret_cast<const char*>(nodes[1]) - first;
+        if (stride < std::ptrdiff_t(sizeof(Transform))) return false;
+        for (size_t i = 2; i < nodes.size(); ++i)
+            if (reinterpret_cast<const char*>(nodes[i]) - first != std::ptrdiff_t(i) * stride) return false;
+        return true;
+    }
+
+    void testReserveContiguous()
+    {
+        TransformPool pool(64);
+        // the reserved nodes are adjacent even while freed slots are scattered over the pool
+        std::vector<Transform*> nodes;
+        for (int i = 0; i < 100; ++i) nodes.push_back(pool.create(longName(size_t(i))));
+        for (size_t i = 0; i < nodes.size(); i += 3) pool.destroy(nodes[i]);
+        pool.reserveContiguous(10);
+        std::vector<Transform*> reserved;
+        for (int i = 0; i < 10; ++i) reserved.push_back(pool.create(longName(size_t(i)), reserved.empty() ? nullptr : reserved.back()));
+        CHECK(adjacent(reserved));
+        // afterwards the free list is used again
+        Transform* reused = pool.create();
+        CHECK(std::find(nodes.begin(), nodes.end(), reused) != nodes.end());
+        // a free run is found after the chunk filled up
+        for (size_t i = 30; i < 70; ++i) if (i % 3 != 0) pool.destroy(nodes[i]);
+        size_t capacity = pool.capacity();
+        pool.reserveContiguous(30);
+        std::vector<Transform*> run;
+        for (int i = 0; i < 30; ++i) run.push_back(pool.create());
+        CHECK(adjacent(run));
+        CHECK(pool.capacity() == capacity);
+        pool.clear();
+
+        // create a subtree, reserve room for the next one, destroy the subtree: the pool reuses its slots
+        for (int round = 0; round < 100; ++round)
+        {
+            Transform* subtree = pool.create(longName(0));
+            for (int i = 1; i < 1000; ++i) pool.create(longName(size_t(i)), subtree);
+            pool.reserveContiguous(100);
+            pool.destroySubtree(subtree);
+        }
+        CHECK(pool.empty());
+        CHECK(pool.capacity() <= 2 * 1024);
+
+        // the rest of a chunk too small for a reservation is used by later creates
+        pool.clear();
+        nodes.clear();
+        for (int i = 0; i < 60; ++i) nodes.push_back(pool.create());
+        pool.reserveContiguous(10);
+        for (int i = 0; i < 10; ++i) pool.create();
+        for (int i = 0; i < 4; ++i) nodes.push_back(pool.create());
+        CHECK(pool.capacity() == 128);
+        const char* base = reinterpret_cast<const char*>(nodes[0]);
+        std::ptrdiff_t stride = reinterpret_cast<const char*>(nodes[1]) - base;
+        bool rest = true;
+        for (size_t i = 60; i < 64; ++i)
+        {
+            std::ptrdiff_t offset = reinterpret_cast<const char*>(nodes[i]) - base;
+            rest = rest && (offset % stride == 0) && (offset / stride >= 60) && (offset / stride < 64);
+        }
+        CHECK(rest);
+
+        // more than a chunk, and slots of a reservation replaced before use are reused
+        pool.clear();
+        pool.reserveContiguous(200);
+        CHECK(pool.capacity() == 200);
+        pool.reserveContiguous(0);
+        for (int i = 0; i < 200; ++i) pool.create();
+        CHECK(pool.capacity() == 200);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(16);
+    testCases();
+    testRandom(random);
+    testReserveContiguous();
+    return test::result();
+}
@@ -0,0 +1,195 @@
+// Rigid and scaled nodes mixed in one tree, see Pose_::setRigid, and trees of RigidPose_ nodes.
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "transform_tree_glm/flat_tree.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+using test::difference;
+
+namespace {
+
+    const float tolerance = 1e-4f;
+
+    typedef FlatTree_<RigidTransform> RigidFlatTree;
+
+    glm::mat4 referenceTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        return glm::translate(glm::mat4(1), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1), scale);
+    }
+
+    void testRigidMode(test::Random& random)
+    {
+        Pose pose(random.position(), random.rotation(), glm::vec3(2, 3, 4));
+        CHECK(!pose.isRigid());
+        pose.setRigid(true);
+        CHECK(pose.isRigid());
+        CHECK(pose.localScale() == glm::vec3(1));
+        CHECK(difference(pose.localPose(), referenceTRS(pose.localPosition(), pose.localRotationQuaternion(), glm::vec3(1))) <= tolerance);
+
+        // a matrix with scale keeps the rotation and drops the scale
+        glm::vec3 position = random.position();
+        glm::quat rotation = random.rotation();
+        pose.setLocalPose(referenceTRS(position, rotation, glm::vec3(1)));
+        CHECK(difference(pose.localPosition(), position) <= tolerance);
+        CHECK(difference(pose.localPose(), referenceTRS(position, rotation, glm::vec3(1))) <= tolerance);
+        pose.setLocalPose(referenceTRS(position, rotation, glm::vec3(0.5f, 2, 3)));
+        CHECK(pose.localScale() == glm::vec3(1));
+        CHECK(std::abs(glm::length(pose.localRotationQuaternion()) - 1) <= tolerance);
+        CHECK(difference(pose.localPose(), referenceTRS(position, rotation, glm::vec3(1))) <= tolerance);
+        RigidPose rigidPose(referenceTRS(position, rotation, glm::vec3(2)));
+        CHECK(std::abs(glm::length(rigidPose.localRotationQuaternion()) - 1) <= tolerance);
+        CHECK(difference(rigidPose.localPose(), referenceTRS(position, rotation, glm::vec3(1))) <= tolerance);
+
+        Pose copy(pose);
+        CHECK(copy.isRigid());
+        DPose converted(pose);
+        CHECK(converted.isRigid());
+        Pose fromRigid = RigidPose(position, rotation);
+        CHECK(fromRigid.isRigid());
+
+        pose.setRigid(false);
+        pose.setLocalScale(glm::vec3(2));
+        CHECK(pose.localScale() == glm::vec3(2));
+    }
+
+    // rigid nodes parenting scaled ones and the other way round
+    void testMixedTree(test::Random& random)
+    {
+        for (int run = 0; run < 100; ++run)
+        {
+            std::vector<std::unique_ptr<Transform>> chain;
+            glm::mat4 expected(1);
+            for (int k = 0; k < 6; ++k)
+            {
+                bool rigid = (random.index(2) == 0);
+                glm::vec3 position = random.position();
+                glm::quat rotation = random.rotation();
+                glm::vec3 scale = rigid ? glm::vec3(1) : random.scale();
+                Transform* parent = chain.empty() ? nullptr : chain.back().get();
+                chain.emplace_back(new Transform(parent));
+                chain.back()->setRigid(rigid);
+                chain.back()->setLocalPose(position, rotation, scale);
+                CHECK(chain.back()->isRigid() == rigid);
+                expected = expected * referenceTRS(position, rotation, scale);
+            }
+            CHECK(difference(chain.back()->worldPose(), expected) <= tolerance);
+            // rigid prefixes of the chain are inverted by transposing, the rest in general
+            CHECK(difference(chain.back()->inverseWorldPose(), glm::affineInverse(expected)) <= tolerance);
+            CHECK(difference(chain.front()->inverseWorldPose(), glm::affineInverse(glm::mat4(chain.front()->localPose()))) <= tolerance);
+
+            // changing a scaled node in the middle is seen below rigid descendants
+            Transform* middle = chain[2].get();
+            middle->setRigid(false);
+            middle->setLocalScale(glm::vec3(0.5f, 2, 1));
+            glm::mat4 recomputed(1);
+            for (auto& node : chain)
+                recomputed = recomputed * referenceTRS(node->localPosition(), node->localRotationQuaternion(), node->localScale());
+            CHECK(difference(chain.back()->worldPose(), recomputed) <= tolerance);
+
+            // switching to rigid drops the scale of that node only
+            middle->setRigid(true);
+            recomputed = glm::mat4(1);
+            for (auto& node : chain)
+                recomputed = recomputed * referenceTRS(node->localPosition(), node->localRotationQuaternion(), node->localScale());
+            CHECK(middle->localScale() == glm::vec3(1));
+            CHECK(difference(chain.back()->worldPose(), recomputed) <= tolerance);
+            CHECK(difference(chain.back()->inverseWorldPose(), glm::affineInverse(recomputed)) <= tolerance);
+        }
+    }
+
+    // setWorldPose and setParentKeepWorldPose of a rigid node below a uniformly scaled parent
+    // must not take the scaled upper 3x3 as rotation
+    void testRigidBelowScaled(test::Random& random)
+    {
+        for (int run = 0; run < 50; ++run)
+        {
+            Transform root(Pose(random.position(), random.rotation(), glm::vec3(random.uniform(0.25f, 4))));
+            Transform scaled(&root, Pose(random.position(), random.rotation(), glm::vec3(random.uniform(0.25f, 4))));
+            Transform rigid(&scaled);
+            rigid.setRigid(true);
+            glm::vec3 position = random.position();
+            glm::quat rotation = random.rotation();
+            rigid.setWorldPose(position, rotation);
+            CHECK(std::abs(glm::length(rigid.localRotationQuaternion()) - 1) <= tolerance);
+            CHECK(rigid.localScale() == glm::vec3(1));
+            CHECK(difference(glm::vec3(rigid.worldPose()[3]), position) <= tolerance);
+            // the world scale is the one of the parents, the world rotation the requested one
+            glm::mat3 worldRotation = rigid.worldRotation();
+            for (int k = 0; k < 3; ++k) worldRotation[k] = glm::normalize(worldRotation[k]);
+            CHECK(difference(worldRotation, glm::mat3_cast(rotation)) <= tolerance);
+
+            Transform other(nullptr, Pose(position, rotation));
+            other.setRigid(true);
+            other.setParentKeepWorldPose(&scaled);
+            CHECK(std::abs(glm::length(other.localRotationQuaternion()) - 1) <= tolerance);
+            CHECK(difference(glm::vec3(other.worldPose()[3]), position) <= tolerance);
+        }
+    }
+
+    // a tree of RigidPose_ nodes only, rigid at compile time, world poses composed by quaternions
+    void testRigidTransform(test::Random& random)
+    {
+        for (int run = 0; run < 20; ++run)
+        {
+            RigidTransform top;
+            std::vector<std::unique_ptr<RigidTransform>> nodes;
+            std::vector<glm::mat4> expected;
+            for (int k = 0; k < 30; ++k)
+            {
+                size_t parent = random.index(nodes.size() + 1);
+                glm::vec3 position = random.position();
+                glm::quat rotation = random.rotation();
+                nodes.emplace_back(new RigidTransform(parent ? nodes[parent - 1].get() : &top, RigidPose(position, rotation)));
+                expected.push_back((parent ? expected[parent - 1] : glm::mat4(1)) * referenceTRS(position, rotation, glm::vec3(1)));
+            }
+            for (size_t k = 0; k < nodes.size(); ++k)
+            {
+                CHECK(difference(nodes[k]->worldPose(), expected[k]) <= tolerance);
+                CHECK(difference(nodes[k]->inverseWorldPose(), glm::affineInverse(expected[k])) <= tolerance);
+            }
+            // world poses computed by FlatTree_, then a lazily computed child below them
+            nodes.front()->setLocalPose(glm::vec3(1, 2, 3), random.rotation());
+            RigidFlatTree flat(&top);
+            flat.update();
+            RigidTransform child(nodes.back().get(), RigidPose(glm::vec3(0, 1, 0), random.rotation()));
+            glm::mat4 reference(1);
+            for (RigidTransform* node = &child; node != nullptr; node = node->parent())
+                reference = glm::mat4(node->localPose()) * reference;
+            CHECK(difference(child.worldPose(), reference) <= tolerance);
+            CHECK(difference(child.inverseWorldPose(), glm::affineInverse(reference)) <= tolerance);
+        }
+
+
+        RigidTransform root;
+        RigidTransform child(&root);
+        glm::vec3 position = random.position();
+        glm::quat rotation = random.rotation();
+        root.setLocalPose(position, rotation);
+        child.setLocalPose(referenceTRS(glm::vec3(1, 2, 3), rotation, glm::vec3(1)));
+        CHECK(child.isRigid());
+        glm::mat4 expected = referenceTRS(position, rotation, glm::vec3(1)) * referenceTRS(glm::vec3(1, 2, 3), rotation, glm::vec3(1));
+        CHECK(difference(child.worldPose(), expected) <= tolerance);
+        CHECK(difference(child.inverseWorldPose(), glm::affineInverse(expected)) <= tolerance);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(6);
+    testRigidMode(random);
+    testMixedTree(random);
+    testRigidBelowScaled(random);
+    testRigidTransform(random);
+    return test::result();
+}
@@ -0,0 +1,150 @@
+// SnapshotBuilder_ against a brute force copy of the tree after random modifications,
+// and the sharing of pages which did not change.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform_tree_glm/snapshot.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    typedef SnapshotBuilder_<Transform, 8> Builder;
+    typedef Builder::snapshot_type Snapshot;
+
+    // every node of the tree in the snapshot, with its current world pose, parent and name
+    bool matches(Transform& root, const Snapshot& snapshot)
+    {
+        std::vector<Transform*> nodes;
+        for (auto& node : root.recurse()) nodes.push_back(&node);
+        if (snapshot.size() != nodes.size()) return false;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (snapshot.worldPose(i) != nodes[i]->worldPose()) return false;
+            if (snapshot.name(i) != nodes[i]->name) return false;
+            int parent = snapshot.parent(i);
+            Transform* expected = (i == 0) ? nullptr : nodes[i]->parent();
+            if ((parent == Snapshot::no_parent) != (expected == nullptr)) return false;
+            if (expected && (nodes[size_t(parent)] != expected)) return false;
+        }
+        return true;
+    }
+
+    size_t sharedPages(const Snapshot& a, const Snapshot& b)
+    {
+        size_t count = 0;
+        for (size_t p = 0; (p < a.pages().size()) && (p < b.pages().size()); ++p)
+            if (a.pages()[p] == b.pages()[p]) ++count;
+        return count;
+    }
+
+    void testSharing(test::Random& random)
+    {
+        Transform root("root");
+        std::vector<std::unique_ptr<Transform>> nodes;
+        for (int i = 0; i < 64; ++i)
+            nodes.emplace_back(new Transform("leaf" + std::to_string(i), &root, Pose(random.position(), random.rotation(), random.scale())));
+
+        Builder builder(&root);
+        auto first = builder.capture();
+        CHECK(matches(root, *first));
+        CHECK(first->pages().size() == 9);
+
+        // nothing changed, everything is shared
+        auto second = builder.capture();
+        CHECK(sharedPages(*first, *second) == 9);
+        CHECK(second->sequence() == first->sequence() + 1);
+
+        // reading world poses does not count as a change
+        for (auto& node : nodes) node->worldPose();
+        CHECK(sharedPages(*second, *builder.capture()) == 9);
+
+        // one leaf, one page
+        auto before = builder.last();
+        nodes[20]->setLocalPosition(glm::vec3(1, 2, 3));
+        auto moved = builder.capture();
+        CHECK(matches(root, *moved));
+        CHECK(sharedPages(*before, *moved) == 8);
+        CHECK(moved->pages()[21 / 8] != before->pages()[21 / 8]);
+
+        // a name set with setName is noticed
+        before = builder.last();
+        nodes[40]->setName("renamed");
+        auto renamed = builder.capture();
+        CHECK(renamed->name(41) == "renamed");
+        CHECK(sharedPages(*before, *renamed) == 8);
+
+        // the root moves every node
+        before = builder.last();
+        root.setLocalPosition(glm::vec3(4, 5, 6));
+        auto all = builder.capture();
+        CHECK(matches(root, *all));
+        CHECK(sharedPages(*before, *all) == 0);
+
+        // old snapshots are not affected
+        CHECK(first->worldPose(21) != moved->worldPose(21));
+        CHECK(first->name(41) == "leaf40");
+    }
+
+    // random structure and pose changes, each capture is compared with the tree
+    void testRandomChanges(test::Random& random)
+    {
+        Transform root("root");
+        std::vector<std::unique_ptr<Transform>> nodes;
+        Builder builder(&root);
+        for (int step = 0; step < 2000; ++step)
+        {
+            size_t action = random.index(8);
+            Transform* any = nodes.empty() ? &root : nodes[random.index(nodes.size())].get();
+            if ((action < 3) || nodes.empty())
+            {
+                Transform* parent = (random.index(4) == 0) ? &root : any;
+                nodes.emplace_back(new Transform("n" + std::to_string(step), parent, Pose(random.position(), random.rotation(), random.scale())));
+            }
+            else if (action == 3)
+            {
+                any->setLocalPose(random.position(), random.rotation(), random.scale());
+            }
+            else if (action == 4)
+            {
+                any->setName("s" + std::to_string(step));
+            }
+            else if (action == 5)
+            {
+                // reparent below a node outside of the subtree
+                Transform* parent = nodes[random.index(nodes.size())].get();
+                if (any != &root && !any->isAncestorOf(parent) && (any != parent)) any->setParent(parent);
+            }
+            else if (action == 6)
+            {
+                // destroying a node detaches its children, put them back under the root
+                size_t i = random.index(nodes.size());
+                std::vector<Transform*> children;
+                for (auto& child : nodes[i]->children()) children.push_back(&child);
+                nodes.erase(nodes.begin() + i);
+                for (Transform* child : children) child->setParent(&root);
+            }
+            if ((step % 7) == 0 || action == 7)
+            {
+                auto snapshot = builder.capture();
+                CHECK(matches(root, *snapshot));
+            }
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(14);
+    testSharing(random);
+    testRandomChanges(random);
+    return test::result();
+}
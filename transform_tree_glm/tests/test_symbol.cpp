@@ -0,0 +1,143 @@
+// SymbolTable against a brute force map of strings to ids, single threaded over many chunks,
+// and with several threads interning overlapping strings while reading back the ones they got.
+// Symbol compares, hashes and converts through its id, and works as name of a Transform_.
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "transform_tree_glm/symbol.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    // short strings stay in the small string buffer, long ones and ones with '\0' inside do not
+    std::string randomString(test::Random& random)
+    {
+        static const char alphabet[] = { 'a', 'b', 'c', '/', '\0' };
+        size_t length = (random.index(8) == 0) ? 20 + random.index(60) : random.index(4);
+        std::string result;
+        for (size_t i = 0; i < length; ++i) result += alphabet[random.index(sizeof(alphabet))];
+        return result;
+    }
+
+    // ids are handed out densely in the order strings are first seen, id 0 is the empty string
+    void testSingleThread(test::Random& random)
+    {
+        SymbolTable table;
+        std::map<std::string, SymbolTable::id_type> reference = { { std::string(), 0 } };
+        std::vector<std::string> strings = { std::string() };
+        std::vector<const std::string*> addresses = { &table.str(0) };
+        CHECK(table.size() == 1);
+        for (int step = 0; step < 20000; ++step)
+        {
+            std::string str = (step < 4000) ? "s" + std::to_string(step) : randomString(random);
+            auto found = reference.find(str);
+            SymbolTable::id_type id = table.intern(str);
+            if (found != reference.end())
+            {
+                CHECK(id == found->second);
+                continue;
+            }
+            CHECK(id == strings.size());
+            reference.emplace(str, id);
+            strings.push_back(str);
+            addresses.push_back(&table.str(id));
+        }
+        CHECK(table.size() == strings.size());
+        CHECK(strings.size() > 8 * SymbolTable::chunk_size);
+        // stored strings never move while the table grows
+        for (size_t id = 0; id < strings.size(); ++id)
+        {
+            CHECK(table.str(SymbolTable::id_type(id)) == strings[id]);
+            CHECK(&table.str(SymbolTable::id_type(id)) == addresses[id]);
+        }
+    }
+
+    // threads intern overlapping strings in different orders, each reads back its ids while the table grows
+    void testConcurrent()
+    {
+        const size_t threadCount = 6;
+        const size_t distinct = 20 * SymbolTable::chunk_size;
+        SymbolTable table;
+        std::vector<std::vector<SymbolTable::id_type>> ids(threadCount, std::vector<SymbolTable::id_type>(distinct));
+        std::atomic<size_t> wrong(0);
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                test::Random random(unsigned(100 + t));
+                while (!start.load()) std::this_thread::yield();
+                // odd threads run backwards, all threads revisit random earlier strings
+                for (size_t k = 0; k < distinct; ++k)
+                {
+                    size_t i = (t % 2) ? distinct - 1 - k : k;
+                    std::string str = "symbol " + std::to_string(i);
+                    SymbolTable::id_type id = table.intern(str);
+                    ids[t][i] = id;
+                    if (table.str(id) != str) ++wrong;
+                    size_t j = (t % 2) ? distinct - 1 - random.index(k + 1) : random.index(k + 1);
+                    if (table.str(ids[t][j]) != "symbol " + std::to_string(j)) ++wrong;
+                }
+            });
+        }
+        start.store(true);
+        for (auto& thread : threads) thread.join();
+        CHECK(wrong.load() == 0);
+        CHECK(table.size() == distinct + 1);
+        std::vector<bool> used(distinct + 1, false);
+        for (size_t i = 0; i < distinct; ++i)
+        {
+            SymbolTable::id_type id = ids[0][i];
+            for (size_t t = 1; t < threadCount; ++t) CHECK(ids[t][i] == id);
+            CHECK((id > 0) && (id <= distinct) && !used[id]);
+            if (id <= distinct) used[id] = true;
+            CHECK(table.str(id) == "symbol " + std::to_string(i));
+        }
+    }
+
+    void testSymbol()
+    {
+        Symbol empty;
+        CHECK(empty.empty() && (empty.id() == 0) && (empty.str().empty()));
+        CHECK(Symbol("") == empty);
+
+        Symbol arm("arm"), arm2(std::string("arm")), wrist(std::string_view("wrist"));
+        CHECK(arm == arm2);
+        CHECK(arm != wrist);
+        CHECK((arm < wrist) != (wrist < arm));
+        CHECK(std::hash<Symbol>()(arm) == std::hash<Symbol>()(arm2));
+        CHECK(Symbol::fromId(arm.id()) == arm);
+        CHECK(std::string_view(wrist) == "wrist");
+        CHECK((wrist.size() == 5) && (std::string(wrist.c_str()) == "wrist"));
+
+        // the child name map views the interned strings
+        SymbolTransform root(Symbol("root"), nullptr);
+        SymbolTransform first(Symbol("arm"), &root);
+        SymbolTransform second(Symbol("wrist"), &first);
+        CHECK(root.findChild("arm") == &first);
+        CHECK(root.find("arm/wrist") == &second);
+        first.setName(Symbol("leg"));
+        CHECK(root.findChild("arm") == nullptr);
+        CHECK(root.find("leg/wrist") == &second);
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(25);
+    testSingleThread(random);
+    testConcurrent();
+    testSymbol();
+    return test::result();
+}
@@ -0,0 +1,158 @@
+// ThreadPool task accounting, parallelFor and Transform_::updateWorldTransforms on the pool.
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "transform_tree_glm/parallel.h"
+#include "transform_tree_glm/thread_pool.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    // many rounds of tiny tasks, so workers often run a task right after it was queued
+    void testTasks(ThreadPool& pool)
+    {
+        std::atomic<size_t> counter(0);
+        size_t expected = 0;
+        for (int round = 0; round < 2000; ++round)
+        {
+            size_t tasks = 1 + (round % 17);
+            for (size_t t = 0; t < tasks; ++t)
+                pool.submit([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            expected += tasks;
+            pool.wait();
+            CHECK(counter.load() == expected);
+        }
+        // wait without tasks returns immediately
+        pool.wait();
+    }
+
+    // idle workers sleep, they must not spin on a miscounted queue
+    void testIdle(ThreadPool& pool)
+    {
+        std::clock_t before = std::clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        double cpuSeconds = double(std::clock() - before) / CLOCKS_PER_SEC;
+        CHECK(cpuSeconds < 0.1 * double(pool.size()));
+        CHECK(cpuSeconds < 0.1);
+    }
+
+    // every index is visited exactly once, in contiguous chunks, and exceptions reach the caller
+    void testParallelFor(ThreadPool& pool)
+    {
+        for (size_t count : { size_t(0), size_t(1), size_t(100), size_t(8191), size_t(8192), size_t(100003) })
+        {
+            for (ThreadPool* p : { &pool, static_cast<ThreadPool*>(nullptr) })
+            {
+                std::vector<std::atomic<int>> visits(count);
+                std::atomic<size_t> chunks(0);
+                parallelFor(p, count, [&](size_t begin, size_t end) {
+                    ++chunks;
+                    for (size_t i = begin; i < end; ++i) ++visits[i];
+                });
+                bool once = true;
+                for (auto& v : visits) once = once && (v.load() == 1);
+                CHECK(once);
+                // one chunk per worker at most, a single one below 2 * minChunk or without pool
+                size_t expected = ((p == nullptr) || (count < 2 * 4096)) ? 1 : std::min(pool.size(), count / 4096);
+                CHECK(chunks.load() == expected);
+            }
+        }
+
+        // a throwing chunk does not stop the others, the exception is rethrown once all are done
+        for (size_t throwing : { size_t(0), size_t(7), size_t(99999) })
+        {
+            std::atomic<size_t> visited(0);
+            bool caught = false;
+            try
+            {
+                parallelFor(&pool, 100000, [&](size_t begin, size_t end) {
+                    visited += end - begin;
+                    if ((begin <= throwing) && (throwing < end)) throw std::runtime_error("chunk");
+                }, 100);
+            }
+            catch (const std::runtime_error&) { caught = true; }
+            CHECK(caught);
+            CHECK(visited.load() == 100000);
+        }
+        bool caught = false;
+        try { parallelFor(nullptr, 10, [](size_t, size_t) { throw std::runtime_error("serial"); }); }
+        catch (const std::runtime_error&) { caught = true; }
+        CHECK(caught);
+
+        // the pool is still usable afterwards
+        testTasks(pool);
+    }
+
+    // world poses computed on the pool are the ones computed serially
+    void testWorldUpdate(ThreadPool& pool, test::Random& random, bool deep)
+    {
+        Transform root;
+        std::vector<std::unique_ptr<Transform>> nodes;
+        for (int i = 0; i < 5000; ++i)
+        {
+            Transform* parent = nodes.empty() ? &root
+                : deep ? nodes[nodes.size() - 1 - random.index(std::min<size_t>(nodes.size(), 3))].get()
+                : (random.index(8) == 0) ? &root : nodes[random.index(nodes.size())].get();
+            nodes.emplace_back(new Transform(parent, Pose(random.position(1), random.rotation(), glm::vec3(1))));
+        }
+        // repeated grains reuse the cached split unless the topology changed in between
+        for (size_t grain : { size_t(1), size_t(16), size_t(16), size_t(16), size_t(1024), size_t(1024), size_t(100000) })
+        {
+            if (random.index(2) == 0)
+            {
+                // move a subtree, add a node, remove a leaf
+                nodes[random.index(nodes.size())]->setParent(&root);
+                nodes.emplace_back(new Transform(nodes[random.index(nodes.size())].get(), Pose(random.position(1), random.rotation(), glm::vec3(1))));
+                size_t k = random.index(nodes.size());
+                if (nodes[k]->subtreeSize() == 1)
+                {
+                    nodes[k] = std::move(nodes.back());
+                    nodes.pop_back();
+                }
+            }
+            root.setLocalPosition(random.position());
+            root.updateWorldTransforms(pool, grain);
+            std::vector<glm::mat4> parallel;
+            for (auto& node : nodes)
+            {
+                CHECK(!node->isWorldPoseDirty());
+                parallel.push_back(node->worldPose());
+            }
+            // recompute serially
+            root.setLocalPosition(root.localPosition());
+            for (auto& node : nodes) node->invalidateWorldPose();
+            for (size_t i = 0; i < nodes.size(); ++i)
+                CHECK(nodes[i]->worldPose() == parallel[i]);
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(15);
+    for (unsigned threads : { 1u, 2u, 4u, 8u })
+    {
+        ThreadPool pool(threads);
+        CHECK(pool.size() == threads);
+        testTasks(pool);
+        testIdle(pool);
+        testParallelFor(pool);
+        testWorldUpdate(pool, random, false);
+        testWorldUpdate(pool, random, true);
+        testIdle(pool);
+    }
+    return test::result();
+}
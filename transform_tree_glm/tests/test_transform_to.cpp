@@ -0,0 +1,212 @@
+// Transform_::commonAncestor and Transform_::transformTo against walking up the parents and
+// composing the local poses in double precision, for siblings, ancestors, the same node and
+// nodes of disjoint trees. lookupTransform and transformToFrame forward to transformTo.
+// The batch transformPointsTo, transformDirectionsTo and transformNormalsTo, serially and on a ThreadPool.
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include "transform_tree_glm/thread_pool.h"
+#include "transform_tree_glm/transform.h"
+
+#include "test.h"
+
+using namespace transform_tree_glm;
+
+namespace {
+
+    Transform* referenceCommonAncestor(Transform* a, Transform* b)
+    {
+        for (Transform* x = a; x != nullptr; x = x->parent())
+            for (Transform* y = b; y != nullptr; y = y->parent())
+                if (x == y) return x;
+        return nullptr;
+    }
+
+    // product of the local poses up to the root, in double precision
+    glm::dmat4 referenceWorldPose(Transform* node)
+    {
+        glm::dmat4 result(1);
+        for (; node != nullptr; node = node->parent())
+            result = glm::dmat4(node->localPose()) * result;
+        return result;
+    }
+
+    // pose of source in target. the roots of disjoint trees are taken as the same frame.
+    glm::dmat4 referenceTransformTo(Transform* source, Transform* target)
+    {
+        return glm::affineInverse(referenceWorldPose(target)) * referenceWorldPose(source);
+    }
+
+    bool closeTo(const glm::mat4& m, const glm::dmat4& expected, double tolerance = 1e-3)
+    {
+        return test::difference(glm::dmat4(m), expected) <= tolerance;
+    }
+
+    // a forest of random trees, all pairs
+    void testRandom(test::Random& random)
+    {
+        for (int run = 0; run < 10; ++run)
+        {
+            std::vector<std::unique_ptr<Transform>> nodes;
+            for (int i = 0; i < 60; ++i)
+            {
+                Transform* parent = ((i == 0) || (random.index(10) == 0)) ? nullptr : nodes[random.index(nodes.size())].get();
+                nodes.emplace_back(new Transform(parent, Pose(random.position(), random.rotation(), glm::vec3(1))));
+            }
+            for (auto& a : nodes)
+            {
+                for (auto& b : nodes)
+                {
+                    Transform* expected = referenceCommonAncestor(a.get(), b.get());
+                    CHECK(a->commonAncestor(b.get()) == expected);
+                    CHECK(closeTo(a->transformTo(b.get()), referenceTransformTo(a.get(), b.get())));
+                }
+            }
+        }
+    }
+
+    // root -> { a -> { a1 -> a11, a2 }, b }, and a separate tree other -> o1
+    void testCases(test::Random& random)
+    {
+        auto pose = [&random]() { return Pose(random.position(), random.rotation(), random.scale()); };
+        Transform root(nullptr, pose());
+        Transform a(&root, pose());
+        Transform a1(&a, pose());
+        Transform a11(&a1, pose());
+        Transform a2(&a, pose());
+        Transform b(&root, pose());
+        Transform other(nullptr, pose());
+        Transform o1(&other, pose());
+
+        // same node
+        CHECK(a1.commonAncestor(&a1) == &a1);
+        CHECK(test::difference(a1.transformTo(&a1), glm::mat4(1)) <= 1e-5f);
+        CHECK(root.commonAncestor(&root) == &root);
+
+        // siblings and cousins
+        CHECK(a1.commonAncestor(&a2) == &a);
+        CHECK(a2.commonAncestor(&a1) == &a);
+        CHECK(a11.commonAncestor(&b) == &root);
+        CHECK(closeTo(a1.transformTo(&a2), referenceTransformTo(&a1, &a2)));
+        CHECK(closeTo(a11.transformTo(&b), referenceTransformTo(&a11, &b)));
+
+        // ancestor and descendant, in both directions. to the parent is the local pose.
+        CHECK(a11.commonAncestor(&a) == &a);
+        CHECK(a.commonAncestor(&a11) == &a);
+        CHECK(test::difference(a11.transformTo(&a1), glm::mat4(a11.localPose())) <= 1e-5f);
+        CHECK(closeTo(a11.transformTo(&a), referenceTransformTo(&a11, &a)));
+        CHECK(closeTo(a.transformTo(&a11), referenceTransformTo(&a, &a11)));
+        CHECK(closeTo(root.transformTo(&a11), referenceTransformTo(&root, &a11)));
+        CHECK(closeTo(a1.transformTo(&a11) * a11.transformTo(&a1), glm::dmat4(1)));
+
+        // disjoint trees have no common ancestor, the transformation goes through both root frames
+        CHECK(a11.commonAncestor(&o1) == nullptr);
+        CHECK(other.commonAncestor(&root) == nullptr);
+        CHECK(closeTo(a11.transformTo(&o1), referenceTransformTo(&a11, &o1)));
+        CHECK(closeTo(root.transformTo(&other), referenceTransformTo(&root, &other)));
+
+        // lookupTransform takes the target first, a null target of transformToFrame is the root frame
+        CHECK(lookupTransform(&b, &a11) == a11.transformTo(&b));
+        CHECK(a11.transformToFrame(&b) == a11.transformTo(&b));
+        CHECK(closeTo(a11.transformToFrame(nullptr), referenceWorldPose(&a11)));
+
+        // moving a subtree changes the common ancestor
+        a1.setParent(&b);
+        CHECK(a11.commonAncestor(&a2) == &root);
+        CHECK(a11.commonAncestor(&b) == &b);
+        CHECK(closeTo(a11.transformTo(&a2), referenceTransformTo(&a11, &a2)));
+    }
+
+    // siblings far from the origin: only the short chains below their common ancestor are composed,
+    // so the result keeps the precision the world poses lose
+    void testFarFromRoot(test::Random& random)
+    {
+        Transform root(nullptr, Pose(glm::vec3(1e6f, -1e6f, 1e6f), random.rotation(), glm::vec3(1)));
+        Transform base(&root, Pose(glm::vec3(3e5f, 0, 0), random.rotation(), glm::vec3(1)));
+        Transform left(&base, Pose(glm::vec3(0.001f, 0.002f, 0), random.rotation(), glm::vec3(1)));
+        Transform right(&base, Pose(glm::vec3(-0.001f, 0.003f, 0.001f), random.rotation(), glm::vec3(1)));
+        glm::dmat4 expected = glm::affineInverse(glm::dmat4(left.localPose())) * glm::dmat4(right.localPose());
+        glm::mat4 m = right.transformTo(&left);
+        CHECK(glm::length(glm::dvec3(glm::dvec4(m[3])) - glm::dvec3(expected[3])) <= 1e-7);
+    }
+
+    enum class Kind { Point, Direction, Normal };
+
+    glm::dvec3 referenceApply(const glm::dmat4& m, const glm::vec3& v, Kind kind)
+    {
+        if (kind == Kind::Point) return glm::dvec3(m * glm::dvec4(glm::dvec3(v), 1));
+        if (kind == Kind::Direction) return glm::dvec3(m * glm::dvec4(glm::dvec3(v), 0));
+        return glm::normalize(glm::transpose(glm::inverse(glm::dmat3(m))) * glm::dvec3(v));
+    }
+
+    // array of structures and structure of arrays, in place and not, with and without pool.
+    // the counts are not multiples of the SIMD width, the larger ones are split over the workers.
+    void testBatch(test::Random& random, ThreadPool& pool)
+    {
+        Transform root(nullptr, Pose(random.position(), random.rotation(), random.scale()));
+        Transform source(&root, Pose(random.position(), random.rotation(), random.scale()));
+        Transform target(&root, Pose(random.position(), random.rotation(), random.scale()));
+        for (Transform* to : { &target, static_cast<Transform*>(nullptr) })
+        {
+            glm::dmat4 m = (to != nullptr) ? referenceTransformTo(&source, to) : referenceWorldPose(&source);
+            for (size_t count : { size_t(0), size_t(1), size_t(13), size_t(20003) })
+            {
+                std::vector<glm::vec3> in(count);
+                for (auto& v : in) v = random.position();
+                for (Kind kind : { Kind::Point, Kind::Direction, Kind::Normal })
+                {
+                    for (ThreadPool* p : { &pool, static_cast<ThreadPool*>(nullptr) })
+                    {
+                        std::vector<glm::vec3> out(count + 1, glm::vec3(7)), inPlace = in;
+                        std::vector<float> x(count), y(count), z(count), ox(count), oy(count), oz(count);
+                        for (size_t i = 0; i < count; ++i) { x[i] = in[i].x; y[i] = in[i].y; z[i] = in[i].z; }
+                        if (kind == Kind::Point)
+                        {
+                            source.transformPointsTo(to, in.data(), out.data(), count, p);
+                            source.transformPointsTo(to, inPlace.data(), inPlace.data(), count, p);
+                            source.transformPointsTo(to, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), count, p);
+                        }
+                        else if (kind == Kind::Direction)
+                        {
+                            source.transformDirectionsTo(to, in.data(), out.data(), count, p);
+                            source.transformDirectionsTo(to, inPlace.data(), inPlace.data(), count, p);
+                            source.transformDirectionsTo(to, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), count, p);
+                        }
+                        else
+                        {
+                            source.transformNormalsTo(to, in.data(), out.data(), count, p);
+                            source.transformNormalsTo(to, inPlace.data(), inPlace.data(), count, p);
+                            source.transformNormalsTo(to, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), count, p);
+                        }
+                        bool matches = (out[count] == glm::vec3(7));
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            glm::dvec3 expected = referenceApply(m, in[i], kind);
+                            matches = matches && (test::difference(glm::dvec3(out[i]), expected) <= 1e-4);
+                            matches = matches && (inPlace[i] == out[i]);
+                            // the structure-of-arrays kernels add in a different order
+                            matches = matches && (test::difference(glm::vec3(ox[i], oy[i], oz[i]), out[i]) <= 1e-5f);
+                        }
+                        CHECK(matches);
+                    }
+                }
+            }
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    test::Random random(8);
+    testRandom(random);
+    testCases(random);
+    testFarFromRoot(random);
+    ThreadPool pool(4);
+    testBatch(random, pool);
+    return test::result();
+}